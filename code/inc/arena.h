@@ -0,0 +1,134 @@
+#ifndef INC_ARENA_H
+#define INC_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+	Bump (region) allocator
+
+	When to use:
+		use when lots of small objects share one lifetime, e.g. every node
+		of a syntax tree. Allocating is a pointer bump inside a chunk, and
+		everything is released at once by FreeArena(), there is no way to
+		free a single allocation. Chunks start small and double in size,
+		so even a large region only takes a handful of malloc/free calls.
+
+		objects that own memory the arena does not (e.g. a Dba) can be
+		registered with ArenaOnRelease so they are cleaned up together
+		with the arena.
+*/
+
+struct Arena;
+
+typedef void (*ArenaReleaseFn)(void* ptr);
+
+/************************
+	InitArena() - creates an empty arena on the heap, no chunk is allocated
+		until the first ArenaAlloc
+
+	Inputs:
+		chunkSize - size of the first chunk in bytes (0 selects a default)
+
+	Outputs:
+
+	Returns:
+		pointer to the new arena or NULL if allocation failed
+
+*/
+struct Arena* InitArena(size_t chunkSize);
+
+/************************
+	FreeArena() - calls every registered release function (newest first),
+		then frees every chunk and the arena itself
+
+	Inputs:
+		arena - pointer to an arena (can be NULL!)
+
+	Outputs:
+
+	Returns:
+
+*/
+void FreeArena(struct Arena* arena);
+
+/************************
+	ArenaAlloc() - allocates zeroed memory from the arena, suitably aligned
+		for any type
+
+	Inputs:
+		arena - pointer to an arena
+		size - number of bytes needed
+
+	Outputs:
+
+	Returns:
+		pointer to the memory, valid until FreeArena
+		NULL if arena is NULL or a new chunk could not be allocated
+
+*/
+void* ArenaAlloc(struct Arena* arena, size_t size);
+
+/************************
+	ArenaCopyString() - copies length chars into the arena and NUL-terminates them
+
+	Inputs:
+		arena - pointer to an arena
+		text - chars to copy, does not need to be NUL-terminated
+		length - number of chars to copy
+
+	Outputs:
+
+	Returns:
+		pointer to the copy or NULL if allocation failed
+
+*/
+char* ArenaCopyString(struct Arena* arena, const char* text, size_t length);
+
+/************************
+	ArenaOnRelease() - registers a function to run on ptr when the arena is freed
+
+	Inputs:
+		arena - pointer to an arena
+		release - function to call
+		ptr - argument passed to release
+
+	Outputs:
+
+	Returns:
+		true if release was registered
+		false if the registration could not be allocated
+
+*/
+bool ArenaOnRelease(struct Arena* arena, ArenaReleaseFn release, void* ptr);
+
+/************************
+	ArenaBytesUsed() - total bytes handed out by the arena so far,
+		including alignment padding
+
+	Inputs:
+		arena - pointer to an arena
+
+	Outputs:
+
+	Returns:
+		bytes used
+
+*/
+size_t ArenaBytesUsed(struct Arena* arena);
+
+/************************
+	ArenaChunkCount() - number of chunks the arena has allocated
+
+	Inputs:
+		arena - pointer to an arena
+
+	Outputs:
+
+	Returns:
+		chunk count
+
+*/
+size_t ArenaChunkCount(struct Arena* arena);
+
+#endif // INC_ARENA_H
@@ -8,13 +8,20 @@
 #include "dba.h"
 
 struct Program;
+struct Arena;
+struct DynamicHashTable;
 struct AstNode;
 struct Expression;
-struct ExpressionNode;
+struct ExpressionList;
+struct IdentifierList;
+
+//the statements of a process or of a compound statement, see DBA_DEFINE
+DBA_DECLARE(StmtVec)
 
 typedef void (*astNodeOpPtr) (struct AstNode*);
 typedef void (*expOpPtr) (struct Expression*);
 typedef void (*blkOpPtr) (struct DynamicBlockArray*);
+typedef bool (*expPartOpPtr) (struct Expression*, int);
 
 struct OperationBlock {
 	astNodeOpPtr doDefaultOp;
@@ -23,10 +30,27 @@ struct OperationBlock {
 	astNodeOpPtr doSpecialOp;
 	expOpPtr doExpressionOp;
 	blkOpPtr doBlockArrayOp;
+
+	//optional filters, one AST_MASK() bit per node type, 0 means every type
+	uint64_t visitMask;		//node types the ops are called for
+	uint64_t descendMask;	//node types whose children are walked, any other
+							//node only gets its doDefaultOp
+};
+
+#define AST_MASK(type) (UINT64_C(1) << (type))
+
+//an in-order expression walk calls these as it reaches each part of a node,
+//operands are right (unary), left and right (binary), object and attribute
+//(attribute) or function then arguments (call)
+struct ExpressionOperationBlock {
+	expOpPtr doEnterOp;			//before the first operand, leaves only get this one
+	expPartOpPtr doBetweenOp;	//before operand n > 0, return false to skip the rest
+	expOpPtr doExitOp;			//after the last operand
 };
 
 void WalkTree(struct Program* prog, struct OperationBlock* op);
-uint16_t ExpressionCount(struct ExpressionNode* eNode);
+void WalkExpression(struct Expression* expr, struct ExpressionOperationBlock* op);
+uint32_t ExpressionCount(struct ExpressionList* list);
 
 enum AstNodeType {
 	AST_PROGRAM = 1,
@@ -65,6 +89,9 @@ enum AstNodeType {
 	AST_REPORT,
 };
 
+//AST_MASK() gives every node type a bit of a uint64_t, name the last type here
+_Static_assert(AST_REPORT < 64, "AST_MASK needs a wider mask");
+
 struct AstNode {
 #ifdef DEBUG
 	struct Token token;
@@ -88,6 +115,8 @@ enum ExpressionType{
 		CALL_EXPR,
 };
 
+//expressions are never changed once parsed, so a subtree can be shared by
+//more than one parent, e.g. both sides of a wildcard mapping (port => port)
 struct Expression {
 	struct AstNode root;
 	enum ExpressionType type;
@@ -96,7 +125,7 @@ struct Expression {
 struct CallExpr {
 	struct Expression self;
 	struct Expression* function;
-	struct ExpressionNode* arguments; 
+	struct ExpressionList* arguments; 
 };
 
 struct AttributeExpr {
@@ -141,8 +170,8 @@ struct NumExpr {
 
 struct Identifier {
 	struct Expression self;
-	char* value;
-	struct Identifier* next;
+	char* value;		//interned spelling, shared and never freed by the tree
+	uint32_t symbol;	//case-folded symbol ID, compare names with this
 };
 
 struct Range {
@@ -172,16 +201,23 @@ struct PortMode {
 	char* value;
 };
 
-struct ExpressionNode {
-	struct Expression* expression;
-	struct ExpressionNode* next;
+//lists are one block with the count up front, so counting and indexing
+//are O(1), NULL is an empty list
+struct ExpressionList {
+	uint32_t count;
+	struct Expression* items[];
+};
+
+struct IdentifierList {
+	uint32_t count;
+	struct Identifier* items[];
 };
 
 struct TypeDecl {
 	struct AstNode self;
 	
 	struct Identifier* typeName;
-	struct ExpressionNode *enumList;
+	struct ExpressionList* enumList;
 }; 
 
 struct VariableDecl {
@@ -202,12 +238,19 @@ struct SignalDecl {
 	struct Expression* expression;
 };
 
+//name and position lookup over the ports and generics of a component or entity
+struct InterfaceIndex {
+	struct SymbolMap* byName;					//symbol -> slot
+	struct DynamicBlockArray* byPosition;	//position - 1 -> slot (uint32_t)
+};
+
 struct ComponentDecl {
 	struct AstNode self;
 
 	struct Identifier* name;
 	struct DynamicBlockArray* ports;
 	struct DynamicBlockArray* generics;
+	struct InterfaceIndex interface;
 };
 
 struct Declaration {
@@ -249,7 +292,7 @@ struct CaseStatement {
 
 	struct Choice* choices;
 	bool defaultCase;
-	struct DynamicBlockArray* statements;
+	StmtVec* statements;
 };
 
 struct SwitchStatement {
@@ -266,7 +309,7 @@ struct ForStatement {
 	struct Label* label;
 	struct Identifier* parameter;
 	struct Range* range;
-	struct DynamicBlockArray* statements;
+	StmtVec* statements;
 };
 
 struct IfStatement {
@@ -275,8 +318,8 @@ struct IfStatement {
 	struct Label* label;
 	struct Expression* antecedent;
 	
-	struct DynamicBlockArray* consequentStatements;
-	struct DynamicBlockArray* alternativeStatements;
+	StmtVec* consequentStatements;
+	StmtVec* alternativeStatements;
 	
 	struct IfStatement* elsif;
 	bool inElsIf;
@@ -286,7 +329,7 @@ struct LoopStatement {
 	struct AstNode self;
 
 	struct Label* label;
-	struct DynamicBlockArray* statements;
+	StmtVec* statements;
 };
 
 struct NextStatement {
@@ -323,14 +366,14 @@ struct WhileStatement {
 
 	struct Label* label;
 	struct Expression* condition;
-	struct DynamicBlockArray* statements;
+	StmtVec* statements;
 };
 
 struct WaitStatement {
 	struct AstNode self;
 
 	struct Label* label;
-	struct Identifier* sensitivityList;
+	struct IdentifierList* sensitivityList;
 	struct Expression* condition;
 	struct Expression* time;
 };
@@ -412,20 +455,22 @@ struct SequentialStatement {
 	} as;
 };
 
+DBA_DEFINE(StmtVec, struct SequentialStatement)
+
 struct Instantiation {
 	struct AstNode self;
 	
 	struct Identifier* name;
-	struct ExpressionNode* portMap;
-	struct ExpressionNode* genericMap;
+	struct ExpressionList* portMap;
+	struct ExpressionList* genericMap;
 };
 
 struct Process {
 	struct AstNode self;
 
-	struct Identifier* sensitivityList;
+	struct IdentifierList* sensitivityList;
 	struct DynamicBlockArray* declarations;
-	struct DynamicBlockArray* statements;
+	StmtVec* statements;
 };
 
 struct ConcurrentStatement {
@@ -458,9 +503,8 @@ struct ArchitectureDecl {
 struct GenericDecl {
 	struct AstNode self;
 
-	//need to add support for , separated identifier list
-	uint16_t position;
-	struct Identifier* name;
+	uint32_t position;
+	struct IdentifierList* names;	//a, b int
 	struct DataType* dtype; 
 	struct Expression* defaultValue;
 };
@@ -468,9 +512,8 @@ struct GenericDecl {
 struct PortDecl {
 	struct AstNode self;
 
-	//need to add support for , separated identifier list
-	uint16_t position;
-	struct Identifier* name;
+	uint32_t position;
+	struct IdentifierList* names;	//a, b -> stl
 	struct PortMode* pmode;
 	struct DataType* dtype; 
 };
@@ -481,6 +524,7 @@ struct EntityDecl {
 	struct Identifier* name;
 	struct DynamicBlockArray* ports;
 	struct DynamicBlockArray* generics;
+	struct InterfaceIndex interface;
 };
 
 struct LibraryUnit{
@@ -522,6 +566,9 @@ struct Program {
 	struct AstNode self;
 
 	struct DynamicBlockArray* units;
+
+	//every node of the tree is allocated here
+	struct Arena* arena;
 };
 
 #endif //INC_AST_H
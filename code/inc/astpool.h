@@ -0,0 +1,213 @@
+#ifndef INC_ASTPOOL_H
+#define INC_ASTPOOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+	Compact, index based syntax tree
+
+	When to use:
+		use an AstPool to keep a parsed program around in a fraction of
+		the memory the pointer tree takes, or to hand it around as plain
+		data. PackProgram() flattens the tree into one array of 32-bit
+		words and one array of chars, there are no pointers in either.
+
+		every node is a header word (pool tag, AST node type, flags)
+		followed by a fixed number of fields for its tag. A field is a
+		node reference (the word offset of the child's header), a string
+		reference (offset into the chars) or a plain value, 0 always means
+		NULL. Child lists (statements, ports, maps) are stored out of line
+		as a count followed by references, so a node never grows with the
+		number of its children. Nodes are laid out in the order WalkTree
+		visits them, and every distinct string is stored once.
+
+		expressions shared by more than one parent (wildcard maps, shared
+		expressions) stay shared. Identifier symbols are not stored, they
+		are interned again by UnpackProgram().
+
+		WalkAstPool() visits the nodes of a pool without rebuilding the
+		tree. Since they are stored in preorder it is one pass from the
+		first word to the last, for passes that only need to see every
+		node (counting, collecting names) this reads memory in order
+		instead of chasing pointers.
+
+		UnpackProgram() rebuilds a pointer tree from a pool for anything
+		that wants one (the emitter, PrintProgram). The interface index of
+		components and entities is only needed while parsing and is left
+		empty.
+
+		since a pool holds no pointers it can be saved as is. WriteAstPool()
+		writes a small header, the words and the chars to a file and
+		LoadAstPool() maps such a file back in without copying or parsing
+		anything, so tools that only read the AST can reuse a parse done
+		once (tvt --emit-ast-bin). Files are in host byte order and are
+		rejected if they were written with a different one.
+*/
+
+struct Program;
+struct AstPool;
+
+//what WalkAstPool() tells its op about a node, only valid during the call
+struct AstPoolNode {
+	uint32_t ref;			//word offset of the node, unique in the pool
+	uint8_t type;			//enum AstNodeType, 0 for case choices
+	uint16_t flags;			//enum ExpressionType of an expression
+	const char* text;		//first name, literal or operator the node holds, NULL if none
+};
+
+typedef void (*astPoolOpPtr) (struct AstPoolNode*, void*);
+
+/************************
+	PackProgram() - flattens a program tree into a new pool
+
+	Inputs:
+		prog - pointer to a program tree, it is left untouched
+
+	Outputs:
+
+	Returns:
+		pointer to the new pool or NULL if allocation failed
+
+*/
+struct AstPool* PackProgram(struct Program* prog);
+
+/************************
+	UnpackProgram() - rebuilds a program tree from a pool
+
+	Inputs:
+		pool - pointer to a pool
+
+	Outputs:
+
+	Returns:
+		pointer to a new program tree, free it with FreeUnpackedProgram()
+
+*/
+struct Program* UnpackProgram(struct AstPool* pool);
+
+/************************
+	FreeUnpackedProgram() - frees a program returned by UnpackProgram()
+
+	Inputs:
+		prog - pointer to a program tree (can be NULL!)
+
+	Outputs:
+
+	Returns:
+
+*/
+void FreeUnpackedProgram(struct Program* prog);
+
+/************************
+	FreeAstPool() - frees the pool
+
+	Inputs:
+		pool - pointer to a pool (can be NULL!)
+
+	Outputs:
+
+	Returns:
+
+*/
+void FreeAstPool(struct AstPool* pool);
+
+/************************
+	WriteAstPool() - saves a pool to a file
+
+	Inputs:
+		pool - pointer to a pool
+		path - file to create or overwrite
+
+	Outputs:
+		the file, it is removed again if writing fails
+
+	Returns:
+		true if the whole pool was written
+
+*/
+bool WriteAstPool(struct AstPool* pool, const char* path);
+
+/************************
+	LoadAstPool() - maps a file written by WriteAstPool() as a pool
+
+	Inputs:
+		path - file to load
+
+	Outputs:
+
+	Returns:
+		pointer to a read-only pool that reads straight from the file, or
+		NULL if the file could not be mapped or is not an AST file. Every
+		reference in the file is checked first, one that points outside
+		it, at the wrong kind of node or round in a cycle rejects the
+		file. Free it with FreeAstPool(), which unmaps the file.
+		PrintAstPoolStats() has no tree costs for a loaded pool.
+
+*/
+struct AstPool* LoadAstPool(const char* path);
+
+/************************
+	WalkAstPool() - calls an op for every node in the pool, parents before
+		their children and children in source order. An expression shared
+		by several parents is visited once
+
+	Inputs:
+		pool - pointer to a pool, packed or loaded
+		visitMask - AST_MASK() bits of the node types to visit, 0 visits all
+		doOp - called with the node and data
+		data - passed through to doOp
+
+	Outputs:
+
+	Returns:
+
+*/
+void WalkAstPool(struct AstPool* pool, uint64_t visitMask, astPoolOpPtr doOp, void* data);
+
+/************************
+	AstPoolNodeCount() - returns the number of nodes in the pool
+
+	Inputs:
+		pool - pointer to a pool
+
+	Outputs:
+
+	Returns:
+		number of nodes, lists and strings are not counted
+
+*/
+uint32_t AstPoolNodeCount(struct AstPool* pool);
+
+/************************
+	AstPoolBytes() - returns the bytes the pool's words and chars take
+
+	Inputs:
+		pool - pointer to a pool
+
+	Outputs:
+
+	Returns:
+		size in bytes
+
+*/
+size_t AstPoolBytes(struct AstPool* pool);
+
+/************************
+	PrintAstPoolStats() - prints the count and the per-node cost of every
+		kind of node, in the pointer tree the pool was packed from and in
+		the pool itself
+
+	Inputs:
+		pool - pointer to a pool returned by PackProgram()
+
+	Outputs:
+		table printed to stdout
+
+	Returns:
+
+*/
+void PrintAstPoolStats(struct AstPool* pool);
+
+#endif //INC_ASTPOOL_H
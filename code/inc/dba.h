@@ -2,6 +2,8 @@
 #define INC_DBA_H
 
 #include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 /*
 	Dynamic array akin to a C++ vector
@@ -14,10 +16,40 @@
 
 		for dynamic arrays with elements of different or variable 
 		size use a list instead
+
+		the first few blocks are stored inline after the header, so a
+		small array never touches the heap for its blocks. The header
+		and its inline blocks can also live in memory the caller
+		provides (e.g. an arena), see InitBlockArrayInPlace
+
+		hot loops that already know their indices are in range can use
+		BlockAt() and FOR_EACH_BLOCK() instead of ReadBlockArray(), and
+		EmplaceBlockArray() builds a block in place instead of copying it in
+
+		a pointer into the array is only valid until the array next grows,
+		unless the array is made by InitSegmentedBlockArray, whose blocks
+		never move
 */
 
 typedef struct DynamicBlockArray Dba;
 
+//the fields are public only so the accessors below can be inlined,
+//everything else should go through the functions
+struct DynamicBlockArray {
+	int count;
+	int capacity;
+	size_t blockSize;
+	char* block;					//points at local until the array spills to the heap
+	int localCapacity;
+	char** segments;				//segmented arrays only, see InitSegmentedBlockArray
+	int segmentCount;
+	bool inPlace;					//the header belongs to the caller, see InitBlockArrayInPlace
+	max_align_t local[];
+};
+
+//segment k of a segmented array holds 1 << (DBA_SEGMENT_SHIFT + k) blocks
+#define DBA_SEGMENT_SHIFT 3
+
 /************************
 	InitBlockArray() - creates a dynamic array of elements of size bsize on the heap
 		and returns a pointer to that memory.  
@@ -33,8 +65,59 @@ typedef struct DynamicBlockArray Dba;
 */
 Dba* InitBlockArray(size_t bsize);
 
+/************************
+	BlockArraySize() - returns how many bytes an array of elements of size bsize
+		needs for its header and inline blocks
+
+	Inputs: 
+		bsize - size of elements to be stored in array
+
+	Outputs:
+
+	Returns:
+		size in bytes of the memory InitBlockArrayInPlace expects
+
+*/
+size_t BlockArraySize(size_t bsize);
+
+/************************
+	InitBlockArrayInPlace() - creates a dynamic array of elements of size bsize
+		in memory provided by the caller. Blocks beyond the inline ones
+		still spill to the heap, so FreeBlockArray must be called, but it
+		leaves mem itself alone.
+
+	Inputs: 
+		mem - at least BlockArraySize(bsize) bytes, aligned for any type (can be NULL!)
+		bsize - size of elements to be stored in array
+
+	Outputs:
+
+	Returns:
+		pointer to the array (same address as mem) or NULL if mem is NULL
+
+*/
+Dba* InitBlockArrayInPlace(void* mem, size_t bsize);
+
+/************************
+	InitSegmentedBlockArray() - creates a dynamic array of elements of size bsize
+		whose blocks never move. It grows by adding a segment twice the size
+		of the last one instead of reallocating, so a pointer to a block stays
+		valid until the array is freed and nothing is copied on growth.
+
+	Inputs: 
+		bsize - size of elements to be stored in array
+
+	Outputs:
+
+	Returns:
+		pointer to the new heap allocated array
+
+*/
+Dba* InitSegmentedBlockArray(size_t bsize);
+
 /************************
 	FreeBlockArray() - frees the dynamic array allocated earlier and sets pointer to NULL  
+		(an array made by InitBlockArrayInPlace only frees what spilled to the heap)
 
 	Inputs: 
 		arr - pointer to a dynamic block array
@@ -61,6 +144,84 @@ void FreeBlockArray(Dba* arr);
 */
 void WriteBlockArray(Dba* arr, char* block);
 
+/************************
+	EmplaceBlockArray() - adds a zeroed block to the end of the array and returns
+		it so the caller can build the element in place, will realloc if at
+		capacity
+
+	Inputs: 
+		arr - pointer to a dynamic block array 
+
+	Outputs:
+
+	Returns:
+		void* to the new block, valid until the array next grows
+		NULL when arr == NULL
+
+*/
+void* EmplaceBlockArray(Dba* arr);
+
+/************************
+	AppendBlockArray() - writes count consecutive blocks to the array with at most 
+		one realloc
+
+	Inputs: 
+		arr - pointer to a dynamic block array 
+		blocks - pointer to count blocks of size blockSize (must not point into arr!)
+		count - number of blocks to write
+
+	Outputs:
+
+	Returns:
+
+*/
+void AppendBlockArray(Dba* arr, const char* blocks, int count);
+
+/************************
+	ReserveBlockArray() - makes room for at least count blocks so the writes 
+		up to count do not realloc
+
+	Inputs: 
+		arr - pointer to a dynamic block array 
+		count - total number of blocks the array should be able to hold
+
+	Outputs:
+
+	Returns:
+
+*/
+void ReserveBlockArray(Dba* arr, int count);
+
+/************************
+	ShrinkBlockArray() - gives back the capacity beyond the current count, blocks
+		that fit inline again move back after the header
+
+	Inputs: 
+		arr - pointer to a dynamic block array 
+
+	Outputs:
+
+	Returns:
+
+*/
+void ShrinkBlockArray(Dba* arr);
+
+/************************
+	PopBlockArray() - removes the last block of the array, so the array can
+		be used as a stack
+
+	Inputs: 
+		arr - pointer to a dynamic block array 
+
+	Outputs:
+		block - the removed block is copied here (can be NULL!)
+
+	Returns:
+		true if a block was removed, false if the array was empty
+
+*/
+bool PopBlockArray(Dba* arr, char* block);
+
 /************************
 	ReadBlockArray() - returns a block from the array located
 		at index (0-based indexing)
@@ -93,5 +254,139 @@ void* ReadBlockArray(Dba* arr, int index);
 */
 int BlockCount(Dba* arr);
 
+/************************
+	WrongBlockArray() - reports an array whose blocks are not the type a
+		typed array expects, see DBA_DEFINE
+
+	Inputs: 
+		name - name of the typed array
+
+	Outputs:
+
+	Returns:
+		NULL
+
+*/
+void* WrongBlockArray(const char* name);
+
+/************************
+	BlockAt() - ReadBlockArray() without the checks, for loops that already
+		know index is in range
+
+	Inputs: 
+		arr - pointer to a dynamic block array (must not be NULL!)
+		index - block to be accessed within array, 0 <= index < count
+
+	Outputs:
+
+	Returns:
+		void* to block element (must be cast to correct object type)
+
+*/
+static inline void* BlockAt(Dba* arr, int index){
+	if(arr->segments == NULL) return arr->block + (size_t)index * arr->blockSize;
+
+	//segment k starts at block ((1 << k) - 1) << DBA_SEGMENT_SHIFT
+	uint32_t first = ((uint32_t)index >> DBA_SEGMENT_SHIFT) + 1;
+	int segment = 31 - __builtin_clz(first);
+	uint32_t offset = (uint32_t)index - ((((uint32_t)1 << segment) - 1) << DBA_SEGMENT_SHIFT);
+	return arr->segments[segment] + (size_t)offset * arr->blockSize;
+}
+
+/************************
+	BlocksBegin(), BlocksEnd() - the first block of the array and one past the last,
+		only for arrays that are not segmented
+
+	Inputs: 
+		arr - pointer to a dynamic block array (can be NULL!)
+
+	Outputs:
+
+	Returns:
+		void* to the block, both are NULL when arr == NULL
+
+*/
+static inline void* BlocksBegin(Dba* arr){
+	return arr ? arr->block : NULL;
+}
+
+static inline void* BlocksEnd(Dba* arr){
+	return arr ? arr->block + (size_t)arr->count * arr->blockSize : NULL;
+}
+
+//visits every block of arr (can be NULL, not segmented) as a type*, the array must not grow during the loop
+#define FOR_EACH_BLOCK(type, it, arr) \
+	for(type *it = (type*)BlocksBegin(arr), *it##End = (type*)BlocksEnd(arr); it < it##End; it++)
+
+/*
+	Typed block arrays
+
+	When to use:
+		use when every block of an array has one known type. DBA_DEFINE(Name, type)
+		declares Name, which is a Dba underneath, and inline calls that take and
+		return type* so the block size is a compile-time constant and passing
+		the wrong kind of array does not compile:
+
+			Name* NameOf(Dba* arr)			- arr as a Name, NULL (and an error) if its blocks are not type
+			Dba* NameArray(Name* vec)		- the untyped array, for code that works on any Dba
+			type* NamePush(Name* vec, const type* item)
+			type* NameEmplace(Name* vec)		- see EmplaceBlockArray
+			type* NameAt(Name* vec, int index)	- unchecked, see BlockAt
+			int NameCount(Name* vec)		- 0 for a NULL vec
+			type* NameBegin(Name* vec), type* NameEnd(Name* vec)	- see BlocksBegin
+
+		DBA_DECLARE(Name) alone lets a struct hold a Name* before type is complete,
+		DBA_DEFINE must follow once it is. Arrays are still made and freed with
+		the untyped calls above.
+*/
+
+#define DBA_DECLARE(Name) typedef struct Name Name;
+
+#define DBA_DEFINE(Name, type) \
+	DBA_DECLARE(Name) \
+	\
+	static inline Name* Name##Of(Dba* arr){ \
+		if(arr && arr->blockSize != sizeof(type)) return (Name*)WrongBlockArray(#Name); \
+		return (Name*)arr; \
+	} \
+	\
+	static inline Dba* Name##Array(Name* vec){ \
+		return (Dba*)vec; \
+	} \
+	\
+	static inline type* Name##Emplace(Name* vec){ \
+		return (type*)EmplaceBlockArray((Dba*)vec); \
+	} \
+	\
+	static inline type* Name##Push(Name* vec, const type* item){ \
+		Dba* arr = (Dba*)vec; \
+		if(arr->count < arr->capacity && arr->segments == NULL){ \
+			type* slot = (type*)arr->block + arr->count++; \
+			*slot = *item; \
+			return slot; \
+		} \
+		type* slot = Name##Emplace(vec); \
+		*slot = *item; \
+		return slot; \
+	} \
+	\
+	static inline type* Name##At(Name* vec, int index){ \
+		Dba* arr = (Dba*)vec; \
+		if(arr->segments) return (type*)BlockAt(arr, index); \
+		return (type*)arr->block + index; \
+	} \
+	\
+	static inline int Name##Count(Name* vec){ \
+		return vec ? ((Dba*)vec)->count : 0; \
+	} \
+	\
+	static inline type* Name##Begin(Name* vec){ \
+		return (type*)BlocksBegin((Dba*)vec); \
+	} \
+	\
+	static inline type* Name##End(Name* vec){ \
+		return (type*)BlocksEnd((Dba*)vec); \
+	}
+
 
 #endif //INC_DBA_H 
@@ -37,7 +37,7 @@ struct DynamicHashTable* InitHashTable();
    FreeHashTable() - frees the dynamic hash table allocated earlier and sets pointer to NULL  
 
    Inputs: 
-      hst - pointer to a dynamic hash table
+      hst - pointer to a dynamic hash table (can be NULL!)
 
    Outputs:
 
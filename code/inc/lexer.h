@@ -1,12 +1,245 @@
 #ifndef INC_LEXER_H
 #define INC_LEXER_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include "token.h"
 
+/*
+	VENT lexer
+
+	When to use:
+		use a VentLexer to turn a VENT source buffer into tokens. The
+		buffer is given with an explicit length and needs no terminator, so
+		read-only memory mapped files can be lexed in place. Every VentLexer keeps its own position, line count and
+		scanner, so any number of them can run at once on different
+		threads. The lexer never copies or modifies the source, token
+		literals point back into it, so the buffer has to outlive every
+		token taken from it.
+
+		use InitVentStreamLexer() for sources too big to keep in memory. It
+		reads a file descriptor a chunk at a time and only holds the current
+		chunk (or the current token, if that is longer). Streamed token
+		literals are copies owned by the lexer, each stays valid for at 
+		least the next STREAM_LOOKAHEAD - 1 tokens. Offsets are 64 bit 
+		either way.
+
+		InitLexer()/NextToken()/FreeLexer() are the original interface and
+		are kept as a thin shim over a per-thread VentLexer.
+
+		use LexTokenStream() instead when the whole file should be lexed up
+		front, e.g. for unlimited lookahead. Tokens are kept as a structure
+		of arrays (type bytes, start offsets, lengths, lines) and TokenAt()
+		rebuilds a struct Token for any index.
+*/
+
+struct RunScanner;
+
+typedef struct VentLexer VentLexer;
+
+#define STREAM_LOOKAHEAD 8
+
+/************************
+	InitVentLexer() - creates a lexer for in on the heap, using the 
+		fastest run scanner the running CPU supports
+
+	Inputs:
+		in - VENT source, must outlive the lexer and its tokens
+		length - number of chars in in, a '\0' before that also ends the program
+
+	Outputs:
+
+	Returns:
+		pointer to the new lexer or NULL if allocation failed
+
+*/
+VentLexer* InitVentLexer(const char* in, size_t length);
+
+/************************
+	InitVentLexerWithScanner() - same as InitVentLexer() but lexes with 
+		a specific run scanner, mostly useful for tests and benchmarks
+
+	Inputs:
+		in - VENT source, must outlive the lexer and its tokens
+		length - number of chars in in
+		scanner - scanner from SelectRunScanner() or GetRunScanner()
+
+	Outputs:
+
+	Returns:
+		pointer to the new lexer or NULL if allocation failed
+
+*/
+VentLexer* InitVentLexerWithScanner(const char* in, size_t length, const struct RunScanner* scanner);
+
+/************************
+	InitVentStreamLexer() - creates a lexer on the heap that pulls its 
+		source from fd as it goes
+
+	Inputs:
+		fd - open file descriptor to read from, the lexer never closes it
+		chunkSize - how much to read at a time, 0 picks a default (64 KiB)
+
+	Outputs:
+
+	Returns:
+		pointer to the new lexer or NULL if allocation failed
+
+*/
+VentLexer* InitVentStreamLexer(int fd, size_t chunkSize);
+
+/************************
+	SetVentLexerLine() - sets the line number of the first token, useful
+		when in is a slice out of the middle of a file
+
+	Inputs:
+		lex - lexer that has not handed out a token yet
+		line - line number in starts on
+
+	Outputs:
+
+	Returns:
+
+*/
+void SetVentLexerLine(VentLexer* lex, int line);
+
+/************************
+	FreeVentLexer() - frees a lexer allocated by InitVentLexer(), the
+		source buffer is left alone
+
+	Inputs:
+		lex - lexer to free, may be NULL
+
+	Outputs:
+
+	Returns:
+
+*/
+void FreeVentLexer(VentLexer* lex);
+
+/************************
+	NextVentToken() - lexes the next token from lex
+
+	Inputs:
+		lex - lexer to pull the token from
+
+	Outputs:
+		lex is moved past the token
+
+	Returns:
+		the next token, TOKEN_EOP (over and over) once the source is used up
+
+*/
+struct Token NextVentToken(VentLexer* lex);
+
+/************************
+	PeekVentToken() - looks ahead without changing what NextVentToken() 
+		returns next
+
+	Inputs:
+		lex - lexer to look ahead in
+		n - how far to look, 0 is the token NextVentToken() would return
+
+	Outputs:
+		a streaming lexer queues up the tokens it had to read to get there
+
+	Returns:
+		the token n places ahead, costs n+1 tokens of lexing
+		streaming lexers return TOKEN_ILLEGAL for n >= STREAM_LOOKAHEAD
+
+*/
+struct Token PeekVentToken(VentLexer* lex, int n);
+
+struct TokenStream {
+	const char* source;
+
+	uint8_t* types;
+	uint32_t* starts;
+	uint32_t* lengths;
+	uint32_t* lines;
+
+	uint32_t count;
+	uint32_t capacity;
+};
+
+/************************
+	LexTokenStream() - lexes all of in in one pass into a token stream
+
+	Inputs:
+		in - VENT source, must outlive the stream
+		length - number of chars in in
+
+	Outputs:
+
+	Returns:
+		pointer to the new heap allocated stream or NULL if allocation failed
+		or in is too big for 32 bit offsets, the last token in the stream 
+		is always TOKEN_EOP
+
+*/
+struct TokenStream* LexTokenStream(const char* in, size_t length);
+
+/************************
+	FreeTokenStream() - frees a stream from LexTokenStream(), the source
+		buffer is left alone
+
+	Inputs:
+		ts - stream to free, may be NULL
+
+	Outputs:
+
+	Returns:
+
+*/
+void FreeTokenStream(struct TokenStream* ts);
+
+/************************
+	TokenAt() - rebuilds the token at index i of a stream
+
+	Inputs:
+		ts - stream to read
+		i - index of the token, anything past the end gives the final TOKEN_EOP
+
+	Outputs:
+
+	Returns:
+		the token at i
+
+*/
+static inline struct Token TokenAt(const struct TokenStream* ts, uint32_t i){
+	if(i >= ts->count) i = ts->count - 1;
+
+	struct Token tok = {
+		.type = (enum TOKEN_TYPE)ts->types[i],
+		.lineNumber = (int)ts->lines[i],
+		.literal = ts->source + ts->starts[i],
+		.length = (int)ts->lengths[i],
+	};
+
+	return tok;
+}
+
+/************************
+	PrintTokenStream() - prints every token of a stream (except the final 
+		TOKEN_EOP) in the same format as PrintToken()
+
+	Inputs:
+		ts - stream to print
+
+	Outputs:
+
+	Returns:
+
+*/
+void PrintTokenStream(const struct TokenStream* ts);
+
+// original single lexer interface, in must be NUL terminated
 void InitLexer(char* in);
 void FreeLexer();
-
 struct Token NextToken();
+
+char* CopyTokenLiteral(struct Token t);
 const char* TokenToString(enum TOKEN_TYPE type);
 void PrintToken(struct Token t);
 
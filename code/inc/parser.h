@@ -2,12 +2,187 @@
 #define INC_PARSER_H
 
 #include <stdbool.h>
+#include <stddef.h>
+
+/*
+	VENT parser
+
+	When to use:
+		use a VentParser to turn VENT source into a syntax tree. A parser
+		owns its lexer, the component and type stores used while parsing
+		and its error state, so separate parsers can run at the same time
+		on different threads. A parser parses one program at a time, call
+		FreeVentProgram() before handing it the next source. Once freed it
+		can be reused for as many programs as needed.
+
+		ParseProgram()/FreeProgram()/ThereWasAnError() and the Set*Flag()
+		calls are the original interface and are kept as a thin shim over
+		a per-thread VentParser.
+*/
+
+struct Program;
+
+typedef struct VentParser VentParser;
+
+/************************
+	InitVentParser() - creates a parser on the heap with every flag off
+
+	Inputs:
+
+	Outputs:
+
+	Returns:
+		pointer to the new parser or NULL if allocation failed
+
+*/
+VentParser* InitVentParser(void);
+
+/************************
+	FreeVentParser() - frees the parser and anything left over from its
+		last parse, programs it returned must be freed first
+
+	Inputs:
+		parser - pointer to a parser (can be NULL!)
+
+	Outputs:
+
+	Returns:
+
+*/
+void FreeVentParser(VentParser* parser);
+
+/************************
+	SetVentParserPrintTokens() - print every token as it is parsed
+
+	Inputs:
+		parser - pointer to a parser
+		on - true to print tokens
+
+	Outputs:
+
+	Returns:
+
+*/
+void SetVentParserPrintTokens(VentParser* parser, bool on);
+
+/************************
+	SetVentParserPreLex() - lex the whole source up front into a token stream
+
+	Inputs:
+		parser - pointer to a parser
+		on - true to pre-lex
+
+	Outputs:
+
+	Returns:
+
+*/
+void SetVentParserPreLex(VentParser* parser, bool on);
+
+/************************
+	SetVentParserShareExpressions() - build one node for every distinct
+		expression, so repeated operands and subexpressions (clk, WIDTH-1)
+		are shared and the tree becomes a DAG. Saves memory on large
+		generated designs, but any pass that changes a node changes it
+		everywhere it is used.
+
+	Inputs:
+		parser - pointer to a parser
+		on - true to share expressions
+
+	Outputs:
+
+	Returns:
+
+*/
+void SetVentParserShareExpressions(VentParser* parser, bool on);
+
+/************************
+	SetVentParserJobs() - parse the top-level units of a source buffer on up
+		to jobs threads, the tree is the same as a single pass would build.
+		Files with errors are always parsed again in a single pass so
+		errors are reported in order. Not used with ParseVentProgramFromFd()
+		or when printing tokens.
+
+	Inputs:
+		parser - pointer to a parser
+		jobs - number of threads, 1 or less parses in a single pass
+
+	Outputs:
+
+	Returns:
+
+*/
+void SetVentParserJobs(VentParser* parser, int jobs);
+
+/************************
+	ParseVentProgram() - parses a VENT source buffer
+
+	Inputs:
+		parser - pointer to a parser
+		ventProgram - VENT source, must outlive the returned program
+		length - number of chars in ventProgram
+
+	Outputs:
+
+	Returns:
+		pointer to the program tree, free it with FreeVentProgram()
+
+*/
+struct Program* ParseVentProgram(VentParser* parser, const char* ventProgram, size_t length);
+
+/************************
+	ParseVentProgramFromFd() - parses VENT source read from fd a chunk at a time
+
+	Inputs:
+		parser - pointer to a parser
+		fd - readable file descriptor, must stay open until the program is freed
+
+	Outputs:
+
+	Returns:
+		pointer to the program tree, free it with FreeVentProgram()
+
+*/
+struct Program* ParseVentProgramFromFd(VentParser* parser, int fd);
+
+/************************
+	FreeVentProgram() - frees a program along with the lexer and stores
+		the parser kept for it
+
+	Inputs:
+		parser - the parser that returned prog
+		prog - pointer to a program tree (can be NULL!)
+
+	Outputs:
+
+	Returns:
+
+*/
+void FreeVentProgram(VentParser* parser, struct Program* prog);
+
+/************************
+	VentParserHadError() - checks whether the last parse reported any errors
+
+	Inputs:
+		parser - pointer to a parser
+
+	Outputs:
+
+	Returns:
+		true if an error was reported
+
+*/
+bool VentParserHadError(VentParser* parser);
 
 bool ThereWasAnError();
 
 void SetPrintTokenFlag();
+void SetPreLexFlag();
 
 struct Program* ParseProgram(char* ventProgram);
+struct Program* ParseProgramWithLength(const char* ventProgram, size_t length);
+struct Program* ParseProgramFromFd(int fd);
 void FreeProgram(struct Program *prog);
 
 #endif // INC_PARSER_H
@@ -0,0 +1,82 @@
+#ifndef INC_SCAN_H
+#define INC_SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+	Character classification and run scanning for the lexer
+
+	When to use:
+		use CharClassTable (via CharHasClass) to classify single chars in
+		place of chains of comparisons. Use a RunScanner to skip a whole
+		run of whitespace, identifier chars or comment text at once. Every
+		scanner returns exactly the same results, the vector versions just
+		look at 16 or 32 bytes per step and fall back to the scalar loop
+		for the tail of a buffer.
+
+		scanners never read past s[n-1], so callers should pass the number
+		of bytes actually left in their buffer
+*/
+
+enum CharClass {
+	CC_SPACE		= 1 << 0, // ' ', '\t', '\r'
+	CC_NEWLINE	= 1 << 1, // '\n'
+	CC_DELIM		= 1 << 2, // ends an identifier
+	CC_LETTER	= 1 << 3, // a-z, A-Z, _
+	CC_DIGIT		= 1 << 4, // 0-9
+};
+
+extern const uint8_t CharClassTable[256];
+
+#define CharHasClass(c, cls) ((CharClassTable[(unsigned char)(c)] & (cls)) != 0)
+
+enum ScanLevel {
+	SCAN_SCALAR = 0,
+	SCAN_SSE2,
+	SCAN_AVX2,
+};
+
+struct RunScanner {
+	const char* name;
+
+	// length of the run of CC_SPACE/CC_NEWLINE chars at s, adds any newlines seen to *newlines
+	size_t (*skipSpace)(const char* s, size_t n, int* newlines);
+
+	// length of the run of chars at s that are not CC_DELIM
+	size_t (*skipIdentifier)(const char* s, size_t n);
+
+	// length of the run at s up to (not including) stop or '\0', adds any newlines seen to *newlines
+	size_t (*skipUntil)(const char* s, size_t n, char stop, int* newlines);
+};
+
+/************************
+	SelectRunScanner() - picks the fastest scanner the running CPU supports
+
+	Inputs:
+
+	Outputs:
+
+	Returns:
+		pointer to a static, read-only scanner (never NULL)
+
+*/
+const struct RunScanner* SelectRunScanner(void);
+
+/************************
+	GetRunScanner() - looks up the scanner for a specific instruction set,
+		mostly useful for tests and benchmarks
+
+	Inputs:
+		level - which scanner implementation to return
+
+	Outputs:
+
+	Returns:
+		pointer to a static, read-only scanner
+		NULL when the CPU (or the build) does not support level
+
+*/
+const struct RunScanner* GetRunScanner(enum ScanLevel level);
+
+#endif // INC_SCAN_H
@@ -0,0 +1,237 @@
+#ifndef INC_SYMBOL_H
+#define INC_SYMBOL_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+	Interned identifier symbols
+
+	When to use:
+		use InternSymbol to turn an identifier into a 32-bit symbol ID.
+		VHDL identifiers are case-insensitive, so every spelling of a
+		name (e.g. "Clk", "CLK", "clk") maps to the same symbol and two
+		names can be compared with == instead of strcmp.
+
+		every distinct spelling is also stored exactly once, so an AST can
+		point at the interned spelling instead of holding its own copy.
+		Interned strings live until FreeSymbolTable() is called and must
+		never be freed or written to by the caller.
+
+		the table is global and safe to use from more than one thread at a
+		time. Interning a new spelling takes a mutex, SymbolName() and
+		SymbolCount() never do. A thread that interns a lot (e.g. a parser)
+		should go through its own SymbolCache, which answers every spelling
+		it has seen before without the mutex. Symbol IDs are stable for the
+		life of the table and 0 (NO_SYMBOL) is never handed out.
+
+		use a SymbolMap to look anything up by name once the name is a
+		symbol, it hashes the 32-bit ID instead of the string.
+*/
+
+struct SymbolCache;
+struct SymbolMap;
+
+#define NO_SYMBOL 0
+
+/************************
+	InternSymbol() - looks up (adding if needed) the symbol for an identifier
+
+	Inputs:
+		text - identifier text, does not need to be NUL-terminated
+		length - number of chars in text
+
+	Outputs:
+		spelling - set to the interned, NUL-terminated copy of text exactly
+			as it was spelled (can be NULL!)
+
+	Returns:
+		symbol ID shared by every case-insensitive spelling of text
+		NO_SYMBOL if length is 0 or the table could not grow
+
+*/
+uint32_t InternSymbol(const char* text, size_t length, const char** spelling);
+
+/************************
+	InitSymbolCache() - creates an empty cache for InternCachedSymbol on the heap,
+		a cache belongs to one thread and must be freed before FreeSymbolTable()
+
+	Inputs:
+
+	Outputs:
+
+	Returns:
+		pointer to the new cache or NULL if allocation failed
+
+*/
+struct SymbolCache* InitSymbolCache(void);
+
+/************************
+	FreeSymbolCache() - frees a cache, the symbols it handed out stay valid
+
+	Inputs:
+		cache - pointer to a cache (can be NULL!)
+
+	Outputs:
+
+	Returns:
+
+*/
+void FreeSymbolCache(struct SymbolCache* cache);
+
+/************************
+	InternCachedSymbol() - same as InternSymbol, but spellings already in cache
+		are answered without taking the table's mutex
+
+	Inputs:
+		cache - cache of the calling thread (NULL interns straight into the table)
+		text - identifier text, does not need to be NUL-terminated
+		length - number of chars in text
+
+	Outputs:
+		spelling - set to the interned, NUL-terminated copy of text exactly
+			as it was spelled (can be NULL!)
+
+	Returns:
+		symbol ID shared by every case-insensitive spelling of text
+		NO_SYMBOL if length is 0 or the table could not grow
+
+*/
+uint32_t InternCachedSymbol(struct SymbolCache* cache, const char* text, size_t length, const char** spelling);
+
+/************************
+	SymbolName() - gets the case-folded (lowercase) name of a symbol
+
+	Inputs:
+		symbol - ID returned by InternSymbol
+
+	Outputs:
+
+	Returns:
+		interned NUL-terminated name
+		NULL if symbol was never handed out
+
+*/
+const char* SymbolName(uint32_t symbol);
+
+/************************
+	SymbolCount() - number of distinct symbols interned so far
+
+	Inputs:
+
+	Outputs:
+
+	Returns:
+		count of symbols, the largest valid ID is equal to this count
+
+*/
+uint32_t SymbolCount(void);
+
+/************************
+	InitSymbolMap() - creates an empty map from symbols to uint64_ts on the heap
+
+	Inputs:
+
+	Outputs:
+
+	Returns:
+		pointer to the new map or NULL if allocation failed
+
+*/
+struct SymbolMap* InitSymbolMap(void);
+
+/************************
+	FreeSymbolMap() - frees a map, the symbols in it are not touched
+
+	Inputs:
+		map - pointer to a map (can be NULL!)
+
+	Outputs:
+
+	Returns:
+
+*/
+void FreeSymbolMap(struct SymbolMap* map);
+
+/************************
+	SetInSymbolMap() - maps symbol to val, replacing any earlier value
+
+	Inputs:
+		map - pointer to a map
+		symbol - key, NO_SYMBOL is never stored
+		val - value to store
+
+	Outputs:
+
+	Returns:
+		true if symbol was not in the map before
+		false if it was, or map is NULL or could not grow, or symbol is NO_SYMBOL
+
+*/
+bool SetInSymbolMap(struct SymbolMap* map, uint32_t symbol, uint64_t val);
+
+/************************
+	GetInSymbolMap() - looks up the value mapped to symbol
+
+	Inputs:
+		map - pointer to a map (can be NULL!)
+		symbol - key to look for
+
+	Outputs:
+		val - set to the value when symbol is found (can be NULL!)
+
+	Returns:
+		true if symbol is in the map
+
+*/
+bool GetInSymbolMap(struct SymbolMap* map, uint32_t symbol, uint64_t* val);
+
+/************************
+	SymbolMapCount() - number of symbols in a map
+
+	Inputs:
+		map - pointer to a map (can be NULL!)
+
+	Outputs:
+
+	Returns:
+		count of symbols, 0 when map is NULL
+
+*/
+uint32_t SymbolMapCount(struct SymbolMap* map);
+
+/************************
+	NextInSymbolMap() - steps through every entry of a map, in no particular
+		order, the map must not change in between
+
+	Inputs:
+		map - pointer to a map (can be NULL!)
+		cursor - where the last call stopped, 0 to start
+
+	Outputs:
+		cursor - moved past the entry found
+		symbol - set to the entry's symbol (can be NULL!)
+		val - set to the entry's value (can be NULL!)
+
+	Returns:
+		true if an entry was found
+		false once every entry has been visited
+
+*/
+bool NextInSymbolMap(struct SymbolMap* map, uint32_t* cursor, uint32_t* symbol, uint64_t* val);
+
+/************************
+	FreeSymbolTable() - releases every interned string and resets the table,
+		any spelling or name pointer handed out before is left dangling
+
+	Inputs:
+
+	Outputs:
+
+	Returns:
+
+*/
+void FreeSymbolTable(void);
+
+#endif // INC_SYMBOL_H
@@ -1,124 +1,179 @@
 #ifndef INC_TOKEN_H
 #define INC_TOKEN_H
 
-enum TOKEN_TYPE {
-	
-	//delmiters
-	TOKEN_LPAREN = 1,
-	TOKEN_RPAREN, 
-	TOKEN_COLON, 
-	TOKEN_SCOLON, 
-	TOKEN_LBRACE, 
-	TOKEN_RBRACE,
-	TOKEN_COMMA,
-	TOKEN_TICK,
-	TOKEN_TO,
-	TOKEN_DOWNTO,
-	TOKEN_BAR,
-
-	//attributes
-	TOKEN_UP,
-	TOKEN_DOWN,
-
-	//operators
-	TOKEN_SLASH, 
-	TOKEN_SLASH_EQUAL, 
-	TOKEN_STAR, 			 
-	TOKEN_STAR_EQUAL, 			 
-	TOKEN_MINUS,
-	TOKEN_MINUS_EQUAL,
-	TOKEN_MINUS_MINUS,
-	TOKEN_PLUS, 
-	TOKEN_PLUS_EQUAL, 
-	TOKEN_PLUS_PLUS, 
-	TOKEN_EQUAL, 
-	TOKEN_NOT_EQUAL, 
-	TOKEN_GREATER, 		 
-	TOKEN_GREATER_EQUAL,
-	TOKEN_LESS, 
-	TOKEN_LESS_EQUAL, 
-	TOKEN_AND, 
-	TOKEN_OR, 			
-	TOKEN_XOR, 
-	TOKEN_NOT,
-	TOKEN_REM,
-	TOKEN_SLL,
-	TOKEN_SRL,
-	TOKEN_SRA,
-	TOKEN_ROL,
-	TOKEN_ROR,
-
-	//port direction modes
-	TOKEN_INPUT, 
-	TOKEN_OUTPUT, 
-	TOKEN_INOUT,	 
-
-	//assignment
-	TOKEN_SASSIGN, //sig assign <=
-	TOKEN_VASSIGN, //var assign :=
-	TOKEN_MASSIGN, //map assign =>
-	
-	//declarations
-	TOKEN_SIG, 
-	TOKEN_VAR, 
-	TOKEN_FILE,
-	TOKEN_COMP, 			
+/*
+	TOKEN_LIST is the single definition of every token type. It expands
+	X(type) once per token and is used to build both enum TOKEN_TYPE and
+	TokenToString(), so the two can never drift apart. Only add new 
+	tokens here.
+*/
+#define TOKEN_LIST(X) \
+	/* delimiters */ \
+	X(TOKEN_LPAREN) \
+	X(TOKEN_RPAREN) \
+	X(TOKEN_COLON) \
+	X(TOKEN_SCOLON) \
+	X(TOKEN_LBRACE) \
+	X(TOKEN_RBRACE) \
+	X(TOKEN_COMMA) \
+	X(TOKEN_TICK) \
+	X(TOKEN_TO) \
+	X(TOKEN_DOWNTO) \
+	X(TOKEN_BAR) \
+	\
+	/* attributes */ \
+	X(TOKEN_UP) \
+	X(TOKEN_DOWN) \
+	\
+	/* operators */ \
+	X(TOKEN_SLASH) \
+	X(TOKEN_SLASH_EQUAL) \
+	X(TOKEN_STAR) \
+	X(TOKEN_STAR_EQUAL) \
+	X(TOKEN_MINUS) \
+	X(TOKEN_MINUS_EQUAL) \
+	X(TOKEN_MINUS_MINUS) \
+	X(TOKEN_PLUS) \
+	X(TOKEN_PLUS_EQUAL) \
+	X(TOKEN_PLUS_PLUS) \
+	X(TOKEN_EQUAL) \
+	X(TOKEN_NOT_EQUAL) \
+	X(TOKEN_GREATER) \
+	X(TOKEN_GREATER_EQUAL) \
+	X(TOKEN_LESS) \
+	X(TOKEN_LESS_EQUAL) \
+	X(TOKEN_AND) \
+	X(TOKEN_OR) \
+	X(TOKEN_XOR) \
+	X(TOKEN_NOT) \
+	X(TOKEN_REM) \
+	X(TOKEN_SLL) \
+	X(TOKEN_SRL) \
+	X(TOKEN_SRA) \
+	X(TOKEN_ROL) \
+	X(TOKEN_ROR) \
+	\
+	/* port direction modes */ \
+	X(TOKEN_INPUT) \
+	X(TOKEN_OUTPUT) \
+	X(TOKEN_INOUT) \
+	\
+	/* assignment */ \
+	X(TOKEN_SASSIGN) /* sig assign <= */ \
+	X(TOKEN_VASSIGN) /* var assign := */ \
+	X(TOKEN_MASSIGN) /* map assign => */ \
+	\
+	/* declarations */ \
+	X(TOKEN_SIG) \
+	X(TOKEN_VAR) \
+	X(TOKEN_FILE) \
+	X(TOKEN_COMP) \
+	\
+	/* types */ \
+	X(TOKEN_STL) \
+	X(TOKEN_STLV) \
+	X(TOKEN_INTEGER) \
+	X(TOKEN_STRING) \
+	X(TOKEN_BIT) \
+	X(TOKEN_BITV) \
+	X(TOKEN_SIGNED) \
+	X(TOKEN_UNSIGNED) \
+	X(TOKEN_TYPE) \
+	\
+	/* literals */ \
+	X(TOKEN_IDENTIFIER) \
+	X(TOKEN_CHARLIT) \
+	X(TOKEN_NUMBERLIT) \
+	X(TOKEN_STRINGLIT) \
+	X(TOKEN_BSTRINGLIT) \
+	\
+	/* keywords */ \
+	X(TOKEN_ENT) \
+	X(TOKEN_ARCH) \
+	X(TOKEN_GEN) \
+	X(TOKEN_MAP) \
+	X(TOKEN_PROC) \
+	X(TOKEN_OTHER) \
+	X(TOKEN_CASE) \
+	X(TOKEN_DEFAULT) \
+	X(TOKEN_SWITCH) \
+	X(TOKEN_IF) \
+	X(TOKEN_ELSIF) \
+	X(TOKEN_ELSE) \
+	X(TOKEN_FOR) \
+	X(TOKEN_USE) \
+	X(TOKEN_WHILE) \
+	X(TOKEN_LOOP) \
+	X(TOKEN_WAIT) \
+	\
+	/* for simulation */ \
+	X(TOKEN_ASSERT) \
+	X(TOKEN_REPORT) \
+	X(TOKEN_NOTE) \
+	X(TOKEN_WARNING) \
+	X(TOKEN_ERROR) \
+	X(TOKEN_FAILURE) \
+	X(TOKEN_SEVERITY) \
+	\
+	X(TOKEN_NULL) \
+	X(TOKEN_EOP) /* end of program */ \
+	X(TOKEN_ILLEGAL)
 
-	//types
-	TOKEN_STL, 
-	TOKEN_STLV, 			
-	TOKEN_INTEGER, 
-	TOKEN_STRING, 
-	TOKEN_BIT,				 
-	TOKEN_BITV,
-	TOKEN_SIGNED,
-	TOKEN_UNSIGNED,
-	TOKEN_TYPE,
-
-	//literals
-	TOKEN_IDENTIFIER, 
-	TOKEN_CHARLIT,
-	TOKEN_NUMBERLIT,
-	TOKEN_STRINGLIT,		
-	TOKEN_BSTRINGLIT,
-
-	//keywords
-	TOKEN_ENT, 
-	TOKEN_ARCH, 			
-	TOKEN_GEN, 
-	TOKEN_MAP, 
-	TOKEN_PROC,
-	TOKEN_OTHER,			
-	TOKEN_CASE,
-	TOKEN_DEFAULT,
-	TOKEN_SWITCH,
-	TOKEN_IF, 
-	TOKEN_ELSIF, 			
-	TOKEN_ELSE, 
-	TOKEN_FOR, 
-	TOKEN_USE,
-	TOKEN_WHILE,			 
-	TOKEN_LOOP,
-	TOKEN_WAIT,
+enum TOKEN_TYPE {
+	TOKEN_NONE = 0,
+#define X(type) type,
+	TOKEN_LIST(X)
+#undef X
+};
 
-	//for simulation
-	TOKEN_ASSERT,
-	TOKEN_REPORT,
-	TOKEN_NOTE,
-	TOKEN_WARNING,
-	TOKEN_ERROR,
-	TOKEN_FAILURE,
-	TOKEN_SEVERITY,
+/*
+	Reserved words of VENT, grouped by their first letter. The lexer
+	switches on the first char of an identifier, then compares lengths 
+	and bytes against the matching group only (see getIdentifierType()).
+	This is all resolved at compile time so there is no table to build.
+	Each group expands K(type, spelling) and KEYWORD_LIST expands
+	G(firstChar, group). A keyword placed in the wrong group will never 
+	match, which the lexer unit tests check for.
+*/
+#define KEYWORDS_A(K)	K(TOKEN_AND, "and") K(TOKEN_ARCH, "arch") K(TOKEN_ASSERT, "assert")
+#define KEYWORDS_C(K)	K(TOKEN_CASE, "case") K(TOKEN_COMP, "comp")
+#define KEYWORDS_D(K)	K(TOKEN_DEFAULT, "default") K(TOKEN_DOWN, "down") K(TOKEN_DOWNTO, "downto")
+#define KEYWORDS_E(K)	K(TOKEN_ELSE, "else") K(TOKEN_ELSIF, "elsif") K(TOKEN_ENT, "ent") K(TOKEN_ERROR, "error")
+#define KEYWORDS_F(K)	K(TOKEN_FAILURE, "failure") K(TOKEN_FOR, "for")
+#define KEYWORDS_I(K)	K(TOKEN_IF, "if") K(TOKEN_INTEGER, "int")
+#define KEYWORDS_L(K)	K(TOKEN_LOOP, "loop")
+#define KEYWORDS_M(K)	K(TOKEN_MAP, "map")
+#define KEYWORDS_N(K)	K(TOKEN_NOT, "not") K(TOKEN_NOTE, "note") K(TOKEN_NULL, "null")
+#define KEYWORDS_O(K)	K(TOKEN_OR, "or")
+#define KEYWORDS_P(K)	K(TOKEN_PROC, "proc")
+#define KEYWORDS_R(K)	K(TOKEN_REM, "rem") K(TOKEN_REPORT, "report") K(TOKEN_ROL, "rol") K(TOKEN_ROR, "ror")
+#define KEYWORDS_S(K)	K(TOKEN_SEVERITY, "severity") K(TOKEN_SIGNED, "signed") K(TOKEN_SIG, "sig") \
+								K(TOKEN_SLL, "sll") K(TOKEN_SRA, "sra") K(TOKEN_SRL, "srl") K(TOKEN_STLV, "stlv") \
+								K(TOKEN_STL, "stl") K(TOKEN_STRING, "string") K(TOKEN_SWITCH, "switch")
+#define KEYWORDS_T(K)	K(TOKEN_TO, "to") K(TOKEN_TYPE, "type")
+#define KEYWORDS_U(K)	K(TOKEN_UNSIGNED, "unsigned") K(TOKEN_UP, "up") K(TOKEN_USE, "use")
+#define KEYWORDS_V(K)	K(TOKEN_VAR, "var")
+#define KEYWORDS_W(K)	K(TOKEN_WAIT, "wait") K(TOKEN_WARNING, "warning") K(TOKEN_WHILE, "while")
+#define KEYWORDS_X(K)	K(TOKEN_XOR, "xor")
 
-	TOKEN_NULL,
-	TOKEN_EOP, // end of program			
-	TOKEN_ILLEGAL,			
-};
+#define KEYWORD_LIST(G) \
+	G('a', KEYWORDS_A) G('c', KEYWORDS_C) G('d', KEYWORDS_D) G('e', KEYWORDS_E) \
+	G('f', KEYWORDS_F) G('i', KEYWORDS_I) G('l', KEYWORDS_L) G('m', KEYWORDS_M) \
+	G('n', KEYWORDS_N) G('o', KEYWORDS_O) G('p', KEYWORDS_P) G('r', KEYWORDS_R) \
+	G('s', KEYWORDS_S) G('t', KEYWORDS_T) G('u', KEYWORDS_U) G('v', KEYWORDS_V) \
+	G('w', KEYWORDS_W) G('x', KEYWORDS_X)
 
+/*
+	A token does not own its literal. literal/length describe a span
+	into the source buffer handed to the lexer and the span is NOT null
+	terminated. TOKEN_EOP is an empty span at the end of the source.
+	Use CopyTokenLiteral() when a caller needs to keep the text around.
+*/
 struct Token {
 	enum TOKEN_TYPE type;	
 	int lineNumber;
-	char *literal;
+	const char *literal;
+	int length;
 };
 
 #endif // INC_TOKEN_H
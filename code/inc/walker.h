@@ -0,0 +1,999 @@
+/*
+	Syntax tree walker template
+
+	When to use:
+		include this in a .c file to get a walker specialized for one pass.
+		WalkTree() calls its OperationBlock through function pointers for
+		every node and each op then switches on the node type again, a pass
+		built from this template calls its ops directly with the node type
+		as a constant, so they can be inlined and their switch folded away.
+
+		define any of these before the include, the ones left out do nothing:
+
+			WALK_DEFAULT_OP(type, node)
+			WALK_OPEN_OP(type, node)
+			WALK_CLOSE_OP(type, node)
+			WALK_SPECIAL_OP(type, node)
+			WALK_EXPRESSION_OP(expr)
+			WALK_BLOCK_ARRAY_OP(arr)
+
+		the node ops are called with the same nodes and in the same order as
+		the matching OperationBlock ops. They must be expressions, type is
+		the enum AstNodeType of the node and node is a struct AstNode*.
+
+		WALK_DESCENDS(type) picks the node types whose children are walked
+		(default all), WALK_PARAMS and WALK_ARGS add a parameter to every
+		walk function for passes that need state, e.g.
+
+			#define WALK_PARAMS , struct OperationBlock* op
+			#define WALK_ARGS , op
+
+		expressions get the same treatment, WalkExpression() goes through
+		an ExpressionOperationBlock, these hooks are called directly:
+
+			WALK_ENTER_EXPRESSION_OP(type, expr)
+			WALK_BETWEEN_OPERANDS_OP(type, expr, operand)
+			WALK_EXIT_EXPRESSION_OP(type, expr)
+
+		in the same order as doEnterOp, doBetweenOp and doExitOp. type is
+		the enum ExpressionType of expr, a constant for every type the
+		parser builds, and the between hook must evaluate to false to skip
+		the rest of the operands. WALK_EXPRESSION_PARAMS and
+		WALK_EXPRESSION_ARGS work like WALK_PARAMS for the expression walk.
+
+		the include defines static void walkTree(struct Program* prog
+		WALK_PARAMS) and static void walkExpression(struct Expression* expr
+		WALK_EXPRESSION_PARAMS), and can only be used once in a file. Their
+		helpers are static too, so every pass gets its own copy.
+*/
+
+#include <ast.h>
+#include <dba.h>
+
+#ifndef WALK_DEFAULT_OP
+#define WALK_DEFAULT_OP(type, node) ((void)0)
+#endif
+#ifndef WALK_OPEN_OP
+#define WALK_OPEN_OP(type, node) ((void)0)
+#endif
+#ifndef WALK_CLOSE_OP
+#define WALK_CLOSE_OP(type, node) ((void)0)
+#endif
+#ifndef WALK_SPECIAL_OP
+#define WALK_SPECIAL_OP(type, node) ((void)0)
+#endif
+#ifndef WALK_EXPRESSION_OP
+#define WALK_EXPRESSION_OP(expr) ((void)0)
+#endif
+#ifndef WALK_BLOCK_ARRAY_OP
+#define WALK_BLOCK_ARRAY_OP(arr) ((void)0)
+#endif
+#ifndef WALK_DESCENDS
+#define WALK_DESCENDS(type) 1
+#endif
+#ifndef WALK_PARAMS
+#define WALK_PARAMS
+#define WALK_ARGS
+#endif
+#ifndef WALK_ENTER_EXPRESSION_OP
+#define WALK_ENTER_EXPRESSION_OP(type, expr) ((void)0)
+#endif
+#ifndef WALK_BETWEEN_OPERANDS_OP
+#define WALK_BETWEEN_OPERANDS_OP(type, expr, operand) 1
+#endif
+#ifndef WALK_EXIT_EXPRESSION_OP
+#define WALK_EXIT_EXPRESSION_OP(type, expr) ((void)0)
+#endif
+#ifndef WALK_EXPRESSION_PARAMS
+#define WALK_EXPRESSION_PARAMS
+#define WALK_EXPRESSION_ARGS
+#endif
+
+//a node that is not descended into is visited with its default op only
+#define WALK_SKIPS(type, node) (!(WALK_DESCENDS(type)) && (WALK_DEFAULT_OP(type, node), 1))
+
+//a statement or declaration that failed to parse is left zeroed in its list
+//and looks like the first kind (process, for, type), the walkers for those
+//kinds take the type from the node so it stays unset
+
+//forward declarations
+static void walkSequentialStatements(StmtVec* stmts WALK_PARAMS);
+static void walkPorts(Dba* ports WALK_PARAMS);
+static void walkGenerics(Dba* generics WALK_PARAMS);
+
+static void walkLabel(struct Label* label WALK_PARAMS){
+	WALK_DEFAULT_OP(AST_LABEL, &(label->self));
+}
+
+static void walkVariableDeclaration(struct VariableDecl* varDecl WALK_PARAMS){
+	if(WALK_SKIPS(AST_VDECL, &(varDecl->self))) return;
+
+	WALK_DEFAULT_OP(AST_VDECL, &(varDecl->self));
+	if(varDecl->name){
+		WALK_DEFAULT_OP(AST_IDENTIFIER, &(varDecl->name->self.root));
+	}
+	if(varDecl->dtype){
+		WALK_DEFAULT_OP(AST_DTYPE, &(varDecl->dtype->self));
+	}
+	if(varDecl->expression){
+		WALK_EXPRESSION_OP(varDecl->expression);
+	}
+	WALK_CLOSE_OP(AST_VDECL, &(varDecl->self));
+}
+
+static void walkExpressionList(struct ExpressionList* eList WALK_PARAMS){
+	for(uint32_t i = 0; i < eList->count; i++){
+		if(eList->items[i]){
+			WALK_EXPRESSION_OP(eList->items[i]);
+		}
+	}
+}
+
+static void walkIdentifierList(struct IdentifierList* iList WALK_PARAMS){
+	for(uint32_t i = 0; i < iList->count; i++){
+		WALK_DEFAULT_OP(AST_IDENTIFIER, &(iList->items[i]->self.root));
+	}
+}
+
+static void walkTypeDeclaration(struct TypeDecl* typeDecl WALK_PARAMS){
+	enum AstNodeType type = typeDecl->self.type;
+	if(WALK_SKIPS(type, &(typeDecl->self))) return;
+
+	WALK_DEFAULT_OP(type, &(typeDecl->self));
+	if(typeDecl->typeName){
+		WALK_DEFAULT_OP(AST_IDENTIFIER, &(typeDecl->typeName->self.root));
+	}
+	if(typeDecl->enumList){
+		walkExpressionList(typeDecl->enumList WALK_ARGS);
+		WALK_SPECIAL_OP(type, &(typeDecl->self));
+	}
+	WALK_CLOSE_OP(type, &(typeDecl->self));
+}
+
+static void walkSignalDeclaration(struct SignalDecl* sigDecl WALK_PARAMS){
+	if(WALK_SKIPS(AST_SDECL, &(sigDecl->self))) return;
+
+	WALK_DEFAULT_OP(AST_SDECL, &(sigDecl->self));
+	if(sigDecl->name){
+		WALK_DEFAULT_OP(AST_IDENTIFIER, &(sigDecl->name->self.root));
+	}
+	if(sigDecl->dtype){
+		WALK_DEFAULT_OP(AST_DTYPE, &(sigDecl->dtype->self));
+	}
+	if(sigDecl->expression){
+		WALK_EXPRESSION_OP(sigDecl->expression);
+	}
+	WALK_CLOSE_OP(AST_SDECL, &(sigDecl->self));
+}
+
+static void walkComponentDeclaration(struct ComponentDecl* compDecl WALK_PARAMS){
+	if(WALK_SKIPS(AST_COMPONENT, &(compDecl->self))) return;
+
+	WALK_DEFAULT_OP(AST_COMPONENT, &(compDecl->self));
+	if(compDecl->name){
+		WALK_DEFAULT_OP(AST_IDENTIFIER, &(compDecl->name->self.root));
+	}
+	WALK_OPEN_OP(AST_COMPONENT, &(compDecl->self));
+	if(compDecl->generics){
+		walkGenerics(compDecl->generics WALK_ARGS);
+	}
+	if(compDecl->ports){
+		walkPorts(compDecl->ports WALK_ARGS);
+	}
+	WALK_CLOSE_OP(AST_COMPONENT, &(compDecl->self));
+}
+
+//work still to do in a sequential statement list, nested bodies and elsif
+//branches are pushed on a heap stack instead of recursing so deeply nested
+//generated code walks in bounded stack space
+struct WalkItem {
+	enum {
+		WALK_STATEMENTS,
+		WALK_CASES,
+		WALK_IF,
+		WALK_CLOSE,
+		WALK_SPECIAL,
+	} type;
+	union {
+		struct {
+			Dba* arr;
+			int next;
+		} list;
+		struct IfStatement* ifStmt;
+		struct {
+			enum AstNodeType type;
+			struct AstNode* node;
+		} call;
+	} as;
+};
+
+static void pushList(Dba* stack, int type, Dba* arr){
+	struct WalkItem item = {.type = type, .as.list = {arr, 0}};
+	WriteBlockArray(stack, (char*)&item);
+}
+
+static void pushIf(Dba* stack, struct IfStatement* ifStmt){
+	struct WalkItem item = {.type = WALK_IF, .as.ifStmt = ifStmt};
+	WriteBlockArray(stack, (char*)&item);
+}
+
+//the close or special op runs once everything pushed after it has been walked
+static void pushOp(Dba* stack, int op, enum AstNodeType type, struct AstNode* node){
+	struct WalkItem item = {.type = op, .as.call = {type, node}};
+	WriteBlockArray(stack, (char*)&item);
+}
+
+static void walkReportStatement(struct ReportStatement* rStmt WALK_PARAMS){
+	if(WALK_SKIPS(AST_REPORT, &(rStmt->self))) return;
+
+	WALK_DEFAULT_OP(AST_REPORT, &(rStmt->self));
+	if(rStmt->stringExpr){
+		WALK_EXPRESSION_OP(rStmt->stringExpr);
+	}
+	if(rStmt->severity.level != SEVERITY_NULL){
+		WALK_SPECIAL_OP(AST_REPORT, &(rStmt->self));
+	}
+	WALK_CLOSE_OP(AST_REPORT, &(rStmt->self));
+}
+
+static void walkAssertStatement(struct AssertStatement* aStmt WALK_PARAMS){
+	if(WALK_SKIPS(AST_ASSERT, &(aStmt->self))) return;
+
+	WALK_DEFAULT_OP(AST_ASSERT, &(aStmt->self));
+	if(aStmt->condition){
+		WALK_EXPRESSION_OP(aStmt->condition);
+	}
+	walkReportStatement(&(aStmt->report) WALK_ARGS);
+	WALK_CLOSE_OP(AST_ASSERT, &(aStmt->self));
+}
+
+static void walkNullStatement(struct NullStatement* nullStmt WALK_PARAMS){
+	WALK_DEFAULT_OP(AST_NULL, &(nullStmt->self));
+}
+
+static void walkCaseStatement(struct CaseStatement* aCase, Dba* stack WALK_PARAMS){
+	if(WALK_SKIPS(AST_CASE, &(aCase->self))) return;
+
+	WALK_DEFAULT_OP(AST_CASE, &(aCase->self));
+
+	struct Choice* choice = aCase->choices;
+	while(choice != NULL){
+		switch(choice->type) {
+
+			case CHOICE_NUMEXPR: {
+				WALK_EXPRESSION_OP(choice->as.numExpr);
+				break;
+			}
+
+			case CHOICE_RANGE: {
+				WALK_DEFAULT_OP(AST_RANGE, &(choice->as.range->self));
+				break;
+			}
+
+			default:
+				break;
+		}
+		choice = choice->nextChoice;
+		if(choice) WALK_SPECIAL_OP(AST_CASE, &(aCase->self));
+	}
+	WALK_OPEN_OP(AST_CASE, &(aCase->self));
+
+	pushOp(stack, WALK_CLOSE, AST_CASE, &(aCase->self));
+	if(aCase->statements){
+		pushList(stack, WALK_STATEMENTS, StmtVecArray(aCase->statements));
+	}
+}
+
+static void walkSwitchStatement(struct SwitchStatement* switchStmt, Dba* stack WALK_PARAMS){
+	if(WALK_SKIPS(AST_SWITCH, &(switchStmt->self))) return;
+
+	WALK_DEFAULT_OP(AST_SWITCH, &(switchStmt->self));
+	if(switchStmt->expression){
+		WALK_EXPRESSION_OP(switchStmt->expression);
+	}
+	WALK_OPEN_OP(AST_SWITCH, &(switchStmt->self));
+
+	pushOp(stack, WALK_CLOSE, AST_SWITCH, &(switchStmt->self));
+	if(switchStmt->cases){
+		pushList(stack, WALK_CASES, switchStmt->cases);
+	}
+}
+
+static void walkForStatement(struct ForStatement* forStmt, Dba* stack WALK_PARAMS){
+	enum AstNodeType type = forStmt->self.type;
+	if(WALK_SKIPS(type, &(forStmt->self))) return;
+
+	WALK_DEFAULT_OP(type, &(forStmt->self));
+	if(forStmt->parameter){
+		WALK_DEFAULT_OP(AST_IDENTIFIER, &(forStmt->parameter->self.root));
+	}
+	if(forStmt->range){
+		WALK_DEFAULT_OP(AST_RANGE, &(forStmt->range->self));
+	}
+	WALK_OPEN_OP(type, &(forStmt->self));
+
+	pushOp(stack, WALK_CLOSE, type, &(forStmt->self));
+	if(forStmt->statements){
+		pushList(stack, WALK_STATEMENTS, StmtVecArray(forStmt->statements));
+	}
+}
+
+static void walkIfStatement(struct IfStatement* ifStmt, Dba* stack WALK_PARAMS){
+	//elsif branches are if statements too
+	enum AstNodeType type = ifStmt->self.type;
+	if(WALK_SKIPS(type, &(ifStmt->self))) return;
+
+	WALK_DEFAULT_OP(type, &(ifStmt->self));
+	if(ifStmt->antecedent){
+		WALK_EXPRESSION_OP(ifStmt->antecedent);
+	}
+	WALK_OPEN_OP(type, &(ifStmt->self));
+
+	//pushed last to first: consequent, elsif, else, close
+	pushOp(stack, WALK_CLOSE, type, &(ifStmt->self));
+	if(ifStmt->alternativeStatements){
+		pushList(stack, WALK_STATEMENTS, StmtVecArray(ifStmt->alternativeStatements));
+		pushOp(stack, WALK_SPECIAL, type, &(ifStmt->self));
+	}
+	if(ifStmt->elsif){
+		pushOp(stack, WALK_SPECIAL, ifStmt->elsif->self.type, &(ifStmt->elsif->self));
+		pushIf(stack, ifStmt->elsif);
+	}
+	if(ifStmt->consequentStatements){
+		pushList(stack, WALK_STATEMENTS, StmtVecArray(ifStmt->consequentStatements));
+	}
+}
+
+static void walkLoopStatement(struct LoopStatement* lStmt, Dba* stack WALK_PARAMS){
+	if(WALK_SKIPS(AST_LOOP, &(lStmt->self))) return;
+
+	WALK_DEFAULT_OP(AST_LOOP, &(lStmt->self));
+
+	pushOp(stack, WALK_CLOSE, AST_LOOP, &(lStmt->self));
+	if(lStmt->statements){
+		pushList(stack, WALK_STATEMENTS, StmtVecArray(lStmt->statements));
+	}
+}
+
+static void walkWhileStatement(struct WhileStatement* wStmt, Dba* stack WALK_PARAMS){
+	if(WALK_SKIPS(AST_WHILE, &(wStmt->self))) return;
+
+	WALK_DEFAULT_OP(AST_WHILE, &(wStmt->self));
+	if(wStmt->condition){
+		WALK_EXPRESSION_OP(wStmt->condition);
+	}
+	WALK_OPEN_OP(AST_WHILE, &(wStmt->self));
+
+	pushOp(stack, WALK_CLOSE, AST_WHILE, &(wStmt->self));
+	if(wStmt->statements){
+		pushList(stack, WALK_STATEMENTS, StmtVecArray(wStmt->statements));
+	}
+}
+
+static void walkWaitStatement(struct WaitStatement* wStmt WALK_PARAMS){
+	if(WALK_SKIPS(AST_WAIT, &(wStmt->self))) return;
+
+	WALK_DEFAULT_OP(AST_WAIT, &(wStmt->self));
+	if(wStmt->sensitivityList){
+		walkIdentifierList(wStmt->sensitivityList WALK_ARGS);
+	}
+	if(wStmt->condition){
+		WALK_EXPRESSION_OP(wStmt->condition);
+	}
+	if(wStmt->time){
+		WALK_EXPRESSION_OP(wStmt->time);
+	}
+}
+
+static void walkVariableAssignment(struct VariableAssign* varAssign WALK_PARAMS){
+	if(WALK_SKIPS(AST_VASSIGN, &(varAssign->self))) return;
+
+	WALK_DEFAULT_OP(AST_VASSIGN, &(varAssign->self));
+	if(varAssign->target){
+		WALK_DEFAULT_OP(AST_IDENTIFIER, &(varAssign->target->self.root));
+	}
+	if(varAssign->op){
+		WALK_SPECIAL_OP(AST_VASSIGN, &(varAssign->self));
+	}
+	if(varAssign->expression){
+		WALK_EXPRESSION_OP(varAssign->expression);
+	}
+	WALK_CLOSE_OP(AST_VASSIGN, &(varAssign->self));
+}
+
+static void walkSignalAssignment(struct SignalAssign* sigAssign WALK_PARAMS){
+	if(WALK_SKIPS(AST_SASSIGN, &(sigAssign->self))) return;
+
+	WALK_DEFAULT_OP(AST_SASSIGN, &(sigAssign->self));
+	if(sigAssign->target){
+		WALK_DEFAULT_OP(AST_IDENTIFIER, &(sigAssign->target->self.root));
+	}
+	if(sigAssign->expression){
+		WALK_EXPRESSION_OP(sigAssign->expression);
+	}
+	WALK_CLOSE_OP(AST_SASSIGN, &(sigAssign->self));
+}
+
+static void walkSequentialStatement(struct SequentialStatement* qstmt, Dba* stack WALK_PARAMS){
+	switch(qstmt->type) {
+		case FOR_STATEMENT: {
+			walkForStatement(&(qstmt->as.forStatement), stack WALK_ARGS);
+			break;
+		}
+
+		case IF_STATEMENT: {
+			walkIfStatement(&(qstmt->as.ifStatement), stack WALK_ARGS);
+			break;
+		}
+
+		case LOOP_STATEMENT: {
+			walkLoopStatement(&(qstmt->as.loopStatement), stack WALK_ARGS);
+			break;
+		}
+
+		case NULL_STATEMENT: {
+			walkNullStatement(&(qstmt->as.nullStatement) WALK_ARGS);
+			break;
+		}
+
+		case ASSERT_STATEMENT: {
+			walkAssertStatement(&(qstmt->as.assertStatement) WALK_ARGS);
+			break;
+		}
+
+		case REPORT_STATEMENT: {
+			walkReportStatement(&(qstmt->as.reportStatement) WALK_ARGS);
+			break;
+		}
+
+		case SWITCH_STATEMENT: {
+			walkSwitchStatement(&(qstmt->as.switchStatement), stack WALK_ARGS);
+			break;
+		}
+
+		case QSIGNAL_ASSIGNMENT: {
+			walkSignalAssignment(&(qstmt->as.signalAssignment) WALK_ARGS);
+			break;
+		}
+
+		case VARIABLE_ASSIGNMENT: {
+			walkVariableAssignment(&(qstmt->as.variableAssignment) WALK_ARGS);
+			break;
+		}
+
+		case WAIT_STATEMENT: {
+			walkWaitStatement(&(qstmt->as.waitStatement) WALK_ARGS);
+			break;
+		}
+
+		case WHILE_STATEMENT: {
+			walkWhileStatement(&(qstmt->as.whileStatement), stack WALK_ARGS);
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+static void walkSequentialStatements(StmtVec* stmts WALK_PARAMS){
+	Dba* stack = InitBlockArray(sizeof(struct WalkItem));
+	pushList(stack, WALK_STATEMENTS, StmtVecArray(stmts));
+
+	while(BlockCount(stack) > 0){
+		struct WalkItem* item = (struct WalkItem*) BlockAt(stack, BlockCount(stack) - 1);
+
+		switch(item->type){
+			case WALK_STATEMENTS:
+			case WALK_CASES: {
+				Dba* arr = item->as.list.arr;
+				if(item->as.list.next == BlockCount(arr)){
+					PopBlockArray(stack, NULL);
+					WALK_BLOCK_ARRAY_OP(arr);
+					break;
+				}
+
+				//item is stale once anything else is pushed
+				void* next = BlockAt(arr, item->as.list.next++);
+				if(item->type == WALK_STATEMENTS){
+					walkSequentialStatement((struct SequentialStatement*)next, stack WALK_ARGS);
+				} else {
+					walkCaseStatement((struct CaseStatement*)next, stack WALK_ARGS);
+				}
+				break;
+			}
+
+			case WALK_IF: {
+				struct IfStatement* ifStmt = item->as.ifStmt;
+				PopBlockArray(stack, NULL);
+				walkIfStatement(ifStmt, stack WALK_ARGS);
+				break;
+			}
+
+			case WALK_CLOSE:
+			case WALK_SPECIAL: {
+				struct WalkItem call;
+				PopBlockArray(stack, (char*)&call);
+				if(call.type == WALK_CLOSE){
+					WALK_CLOSE_OP(call.as.call.type, call.as.call.node);
+				} else {
+					WALK_SPECIAL_OP(call.as.call.type, call.as.call.node);
+				}
+				break;
+			}
+		}
+	}
+
+	FreeBlockArray(stack);
+}
+
+static void walkDeclarations(Dba* decls WALK_PARAMS){
+	FOR_EACH_BLOCK(struct Declaration, decl, decls){
+		switch (decl->type){
+
+			case TYPE_DECLARATION: {
+				walkTypeDeclaration(&(decl->as.typeDeclaration) WALK_ARGS);
+				break;
+			}
+
+			case SIGNAL_DECLARATION: {
+				walkSignalDeclaration(&(decl->as.signalDeclaration) WALK_ARGS);
+				break;
+			}
+
+			case COMPONENT_DECLARATION: {
+				walkComponentDeclaration(&(decl->as.componentDeclaration) WALK_ARGS);
+				break;
+			}
+
+			case VARIABLE_DECLARATION: {
+				walkVariableDeclaration(&(decl->as.variableDeclaration) WALK_ARGS);
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+	WALK_BLOCK_ARRAY_OP(decls);
+}
+
+static void walkInstantiation(struct Instantiation* inst WALK_PARAMS){
+	if(WALK_SKIPS(AST_INSTANCE, &(inst->self))) return;
+
+	if(inst->name){
+		WALK_OPEN_OP(AST_INSTANCE, &(inst->self));
+		WALK_DEFAULT_OP(AST_IDENTIFIER, &(inst->name->self.root));
+	}
+	if(inst->genericMap){
+		WALK_SPECIAL_OP(AST_INSTANCE, &(inst->self));
+		walkExpressionList(inst->genericMap WALK_ARGS);
+	}
+	if(inst->portMap){
+		WALK_DEFAULT_OP(AST_INSTANCE, &(inst->self));
+		walkExpressionList(inst->portMap WALK_ARGS);
+	}
+	WALK_CLOSE_OP(AST_INSTANCE, &(inst->self));
+}
+
+static void walkProcessStatement(struct Process* proc WALK_PARAMS){
+	enum AstNodeType type = proc->self.type;
+	if(WALK_SKIPS(type, &(proc->self))) return;
+
+	WALK_DEFAULT_OP(type, &(proc->self));
+	if(proc->sensitivityList){
+		walkIdentifierList(proc->sensitivityList WALK_ARGS);
+	}
+	if(proc->declarations){
+		walkDeclarations(proc->declarations WALK_ARGS);
+	}
+	WALK_OPEN_OP(type, &(proc->self));
+	if(proc->statements){
+		walkSequentialStatements(proc->statements WALK_ARGS);
+	}
+	WALK_CLOSE_OP(type, &(proc->self));
+}
+
+static void walkConcurrentStatements(Dba* stmts WALK_PARAMS){
+	FOR_EACH_BLOCK(struct ConcurrentStatement, cstmt, stmts){
+		if(cstmt->label){
+			walkLabel(cstmt->label WALK_ARGS);
+		}
+		switch(cstmt->type) {
+			case PROCESS: {
+				walkProcessStatement(&(cstmt->as.process) WALK_ARGS);
+				break;
+			}
+
+			case INSTANTIATION: {
+				walkInstantiation(&(cstmt->as.instantiation) WALK_ARGS);
+				break;
+			}
+
+			case SIGNAL_ASSIGNMENT: {
+				walkSignalAssignment(&(cstmt->as.signalAssignment) WALK_ARGS);
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+	WALK_BLOCK_ARRAY_OP(stmts);
+}
+
+static void walkArchitecture(struct ArchitectureDecl* archDecl WALK_PARAMS){
+	if(WALK_SKIPS(AST_ARCHITECTURE, &(archDecl->self))) return;
+
+	WALK_DEFAULT_OP(AST_ARCHITECTURE, &(archDecl->self));
+	if(archDecl->archName){
+		WALK_DEFAULT_OP(AST_IDENTIFIER, &(archDecl->archName->self.root));
+	}
+	if(archDecl->entName){
+		WALK_DEFAULT_OP(AST_IDENTIFIER, &(archDecl->entName->self.root));
+	}
+	if(archDecl->declarations){
+		walkDeclarations(archDecl->declarations WALK_ARGS);
+	}
+	WALK_OPEN_OP(AST_ARCHITECTURE, &(archDecl->self));
+	if(archDecl->statements){
+		walkConcurrentStatements(archDecl->statements WALK_ARGS);
+	}
+	WALK_CLOSE_OP(AST_ARCHITECTURE, &(archDecl->self));
+}
+
+static void walkGenerics(Dba* generics WALK_PARAMS){
+	int count = BlockCount(generics);
+	if(count == 0) {
+		return;
+	}
+
+	for(int i=0; i < count; i++){
+		struct GenericDecl* genericDecl = (struct GenericDecl*) BlockAt(generics, i);
+
+		//pass in the first generic to do some one time work at start of loop
+		if(i == 0) WALK_OPEN_OP(AST_GENERIC, &(genericDecl->self));
+
+		if(!WALK_SKIPS(AST_GENERIC, &(genericDecl->self))){
+			WALK_DEFAULT_OP(AST_GENERIC, &(genericDecl->self));
+			if(genericDecl->names){
+				walkIdentifierList(genericDecl->names WALK_ARGS);
+			}
+			if(genericDecl->dtype){
+				WALK_DEFAULT_OP(AST_DTYPE, &(genericDecl->dtype->self));
+			}
+			if(genericDecl->defaultValue){
+				WALK_EXPRESSION_OP(genericDecl->defaultValue);
+			}
+			WALK_CLOSE_OP(AST_GENERIC, &(genericDecl->self));
+		}
+
+		//finish up one time work
+		if(i == (count - 1)) WALK_SPECIAL_OP(AST_GENERIC, &(genericDecl->self));
+	}
+
+	WALK_BLOCK_ARRAY_OP(generics);
+}
+
+static void walkPorts(Dba* ports WALK_PARAMS){
+	int count = BlockCount(ports);
+	if(count == 0) {
+		return;
+	}
+
+	for(int i=0; i < count; i++){
+		struct PortDecl* portDecl = (struct PortDecl*) BlockAt(ports, i);
+
+		//pass in the first port to do some one time work at start of loop
+		if(i == 0) WALK_OPEN_OP(AST_PORT, &(portDecl->self));
+		if(WALK_SKIPS(AST_PORT, &(portDecl->self))) continue;
+
+		WALK_DEFAULT_OP(AST_PORT, &(portDecl->self));
+		if(portDecl->names){
+			walkIdentifierList(portDecl->names WALK_ARGS);
+		}
+		if(portDecl->pmode){
+			WALK_DEFAULT_OP(AST_PMODE, &(portDecl->pmode->self));
+		}
+		if(portDecl->dtype){
+			WALK_DEFAULT_OP(AST_DTYPE, &(portDecl->dtype->self));
+		}
+		WALK_CLOSE_OP(AST_PORT, &(portDecl->self));
+	}
+
+	WALK_BLOCK_ARRAY_OP(ports);
+}
+
+static void walkEntity(struct EntityDecl* entDecl WALK_PARAMS){
+	if(WALK_SKIPS(AST_ENTITY, &(entDecl->self))) return;
+
+	WALK_DEFAULT_OP(AST_ENTITY, &(entDecl->self));
+	if(entDecl->name){
+		WALK_DEFAULT_OP(AST_IDENTIFIER, &(entDecl->name->self.root));
+	}
+	WALK_OPEN_OP(AST_ENTITY, &(entDecl->self));
+	if(entDecl->generics){
+		walkGenerics(entDecl->generics WALK_ARGS);
+	}
+	if(entDecl->ports){
+		walkPorts(entDecl->ports WALK_ARGS);
+	}
+	WALK_CLOSE_OP(AST_ENTITY, &(entDecl->self));
+}
+
+static void walkUseStatement(struct UseStatement* stmt WALK_PARAMS){
+	if(stmt){
+		WALK_DEFAULT_OP(AST_USE, &(stmt->self));
+	}
+}
+
+static void walkLibraryUnit(struct LibraryUnit* lunit WALK_PARAMS){
+	switch(lunit->type){
+		case ENTITY: {
+			walkEntity(&(lunit->as.entity) WALK_ARGS);
+			break;
+		}
+		case ARCHITECTURE: {
+			walkArchitecture(&(lunit->as.architecture) WALK_ARGS);
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+static void walkDesignUnits(Dba* arr WALK_PARAMS){
+	FOR_EACH_BLOCK(struct DesignUnit, unit, arr){
+		switch(unit->type){
+			case USE_STATEMENT: {
+				walkUseStatement(&(unit->as.useStatement) WALK_ARGS);
+				break;
+			}
+			case LIBRARY_UNIT: {
+				walkLibraryUnit(&(unit->as.libraryUnit) WALK_ARGS);
+				break;
+			}
+			default:
+				break;
+		}
+	}
+	WALK_BLOCK_ARRAY_OP(arr);
+}
+
+static void walkTree(struct Program* prog WALK_PARAMS){
+	if(prog){
+		if(WALK_SKIPS(AST_PROGRAM, &(prog->self))) return;
+
+		WALK_DEFAULT_OP(AST_PROGRAM, &(prog->self));
+		if(prog->units){
+			walkDesignUnits(prog->units WALK_ARGS);
+		}
+		WALK_SPECIAL_OP(AST_PROGRAM, &(prog->self));
+	}
+}
+
+// expressions
+
+//the expression types the parser builds, the hooks get these as constants
+#define WALK_EXPRESSION_TYPES(X) \
+	X(BINARY_EXPR) X(UNARY_EXPR) X(ATTRIBUTE_EXPR) X(CALL_EXPR) \
+	X(NAME_EXPR) X(NUM_EXPR) X(CHAR_EXPR) X(STRING_EXPR)
+
+static inline void walkEnterExpression(struct Expression* expr WALK_EXPRESSION_PARAMS){
+	switch(expr->type){
+#define X(type) case type: WALK_ENTER_EXPRESSION_OP(type, expr); break;
+		WALK_EXPRESSION_TYPES(X)
+#undef X
+		default: WALK_ENTER_EXPRESSION_OP(expr->type, expr); break;
+	}
+}
+
+static inline bool walkBetweenOperands(struct Expression* expr, int operand WALK_EXPRESSION_PARAMS){
+	switch(expr->type){
+#define X(type) case type: return WALK_BETWEEN_OPERANDS_OP(type, expr, operand);
+		WALK_EXPRESSION_TYPES(X)
+#undef X
+		default: return WALK_BETWEEN_OPERANDS_OP(expr->type, expr, operand);
+	}
+}
+
+static inline void walkExitExpression(struct Expression* expr WALK_EXPRESSION_PARAMS){
+	switch(expr->type){
+#define X(type) case type: WALK_EXIT_EXPRESSION_OP(type, expr); break;
+		WALK_EXPRESSION_TYPES(X)
+#undef X
+		default: WALK_EXIT_EXPRESSION_OP(expr->type, expr); break;
+	}
+}
+
+//an expression node whose operands are still being walked
+struct ExpressionFrame {
+	struct Expression* expr;
+	int operand;					//next operand to walk
+	int operands;
+};
+
+static struct ExpressionFrame enterExpression(struct Expression* expr WALK_EXPRESSION_PARAMS){
+	struct ExpressionFrame frame = {expr, 0, 0};
+
+	switch(expr->type){
+		case UNARY_EXPR: frame.operands = 1; break;
+		case BINARY_EXPR: frame.operands = 2; break;
+		case ATTRIBUTE_EXPR: frame.operands = 2; break;
+		case CALL_EXPR: {
+			frame.operands = 1 + ExpressionCount(((struct CallExpr*)expr)->arguments);
+			break;
+		}
+		default: break;
+	}
+
+	walkEnterExpression(expr WALK_EXPRESSION_ARGS);
+	return frame;
+}
+
+static struct Expression* takeOperand(struct ExpressionFrame* frame){
+	int operand = frame->operand++;
+
+	switch(frame->expr->type){
+		case UNARY_EXPR: return ((struct UnaryExpr*)frame->expr)->right;
+		case BINARY_EXPR: {
+			struct BinaryExpr* bexp = (struct BinaryExpr*)frame->expr;
+			return operand == 0 ? bexp->left : bexp->right;
+		}
+		case ATTRIBUTE_EXPR: {
+			struct AttributeExpr* aexp = (struct AttributeExpr*)frame->expr;
+			return operand == 0 ? aexp->object : aexp->attribute;
+		}
+		case CALL_EXPR: {
+			struct CallExpr* cexp = (struct CallExpr*)frame->expr;
+			return operand == 0 ? cexp->function : cexp->arguments->items[operand - 1];
+		}
+		default: return NULL;
+	}
+}
+
+//most expressions are shallow, their frames stay in a local array and only a
+//deep chain spills to the heap
+#define LOCAL_FRAMES 32
+
+struct ExpressionStack {
+	struct ExpressionFrame local[LOCAL_FRAMES];
+	int count;
+	Dba* spill;
+};
+
+static void pushFrame(struct ExpressionStack* stack, struct ExpressionFrame frame){
+	if(stack->count < LOCAL_FRAMES){
+		stack->local[stack->count] = frame;
+	} else {
+		if(stack->spill == NULL) stack->spill = InitBlockArray(sizeof(struct ExpressionFrame));
+		WriteBlockArray(stack->spill, (char*)&frame);
+	}
+	stack->count++;
+}
+
+static struct ExpressionFrame* topFrame(struct ExpressionStack* stack){
+	if(stack->count <= LOCAL_FRAMES) return &(stack->local[stack->count - 1]);
+	return (struct ExpressionFrame*) ReadBlockArray(stack->spill, stack->count - LOCAL_FRAMES - 1);
+}
+
+static void popFrame(struct ExpressionStack* stack){
+	stack->count--;
+	if(stack->count >= LOCAL_FRAMES) PopBlockArray(stack->spill, NULL);
+}
+
+//subtrees below the recursion depth are walked off an explicit stack, a
+//chain of thousands of operators is as deep as the tree gets and must not
+//recurse all the way down
+static void walkDeepExpression(struct Expression* expr WALK_EXPRESSION_PARAMS){
+	struct ExpressionFrame root = enterExpression(expr WALK_EXPRESSION_ARGS);
+	if(root.operands == 0){
+		walkExitExpression(expr WALK_EXPRESSION_ARGS);
+		return;
+	}
+
+	struct ExpressionStack stack;
+	stack.count = 0;
+	stack.spill = NULL;
+	pushFrame(&stack, root);
+
+	while(stack.count > 0){
+		struct ExpressionFrame* frame = topFrame(&stack);
+
+		if(frame->operand == frame->operands){
+			struct Expression* done = frame->expr;
+			popFrame(&stack);
+			walkExitExpression(done WALK_EXPRESSION_ARGS);
+			continue;
+		}
+
+		if(frame->operand > 0 && !walkBetweenOperands(frame->expr, frame->operand WALK_EXPRESSION_ARGS)){
+			frame->operand = frame->operands;
+			continue;
+		}
+
+		struct Expression* operand = takeOperand(frame);
+		if(operand){
+			pushFrame(&stack, enterExpression(operand WALK_EXPRESSION_ARGS));
+		}
+	}
+
+	if(stack.spill) FreeBlockArray(stack.spill);
+}
+
+//the first levels of an expression recurse with one switch per node, every
+//hook gets its type as a constant and no frame is kept for them
+#define WALK_RECURSION_DEPTH 32
+
+static void walkExpressionAt(struct Expression* expr, int depth WALK_EXPRESSION_PARAMS){
+	if(depth == WALK_RECURSION_DEPTH){
+		walkDeepExpression(expr WALK_EXPRESSION_ARGS);
+		return;
+	}
+
+	switch(expr->type){
+
+		case UNARY_EXPR: {
+			struct UnaryExpr* uexp = (struct UnaryExpr*)expr;
+			WALK_ENTER_EXPRESSION_OP(UNARY_EXPR, expr);
+			if(uexp->right) walkExpressionAt(uexp->right, depth + 1 WALK_EXPRESSION_ARGS);
+			WALK_EXIT_EXPRESSION_OP(UNARY_EXPR, expr);
+			break;
+		}
+
+		case BINARY_EXPR: {
+			struct BinaryExpr* bexp = (struct BinaryExpr*)expr;
+			WALK_ENTER_EXPRESSION_OP(BINARY_EXPR, expr);
+			if(bexp->left) walkExpressionAt(bexp->left, depth + 1 WALK_EXPRESSION_ARGS);
+			if(WALK_BETWEEN_OPERANDS_OP(BINARY_EXPR, expr, 1) && bexp->right){
+				walkExpressionAt(bexp->right, depth + 1 WALK_EXPRESSION_ARGS);
+			}
+			WALK_EXIT_EXPRESSION_OP(BINARY_EXPR, expr);
+			break;
+		}
+
+		case ATTRIBUTE_EXPR: {
+			struct AttributeExpr* aexp = (struct AttributeExpr*)expr;
+			WALK_ENTER_EXPRESSION_OP(ATTRIBUTE_EXPR, expr);
+			if(aexp->object) walkExpressionAt(aexp->object, depth + 1 WALK_EXPRESSION_ARGS);
+			if(WALK_BETWEEN_OPERANDS_OP(ATTRIBUTE_EXPR, expr, 1) && aexp->attribute){
+				walkExpressionAt(aexp->attribute, depth + 1 WALK_EXPRESSION_ARGS);
+			}
+			WALK_EXIT_EXPRESSION_OP(ATTRIBUTE_EXPR, expr);
+			break;
+		}
+
+		case CALL_EXPR: {
+			struct CallExpr* cexp = (struct CallExpr*)expr;
+			WALK_ENTER_EXPRESSION_OP(CALL_EXPR, expr);
+			if(cexp->function) walkExpressionAt(cexp->function, depth + 1 WALK_EXPRESSION_ARGS);
+
+			uint32_t count = ExpressionCount(cexp->arguments);
+			for(uint32_t i = 0; i < count; i++){
+				if(!WALK_BETWEEN_OPERANDS_OP(CALL_EXPR, expr, (int)i + 1)) break;
+				struct Expression* argument = cexp->arguments->items[i];
+				if(argument) walkExpressionAt(argument, depth + 1 WALK_EXPRESSION_ARGS);
+			}
+			WALK_EXIT_EXPRESSION_OP(CALL_EXPR, expr);
+			break;
+		}
+
+#define X(type) case type: WALK_ENTER_EXPRESSION_OP(type, expr); WALK_EXIT_EXPRESSION_OP(type, expr); break;
+		X(NAME_EXPR) X(NUM_EXPR) X(CHAR_EXPR) X(STRING_EXPR)
+#undef X
+
+		default:
+			WALK_ENTER_EXPRESSION_OP(expr->type, expr);
+			WALK_EXIT_EXPRESSION_OP(expr->type, expr);
+			break;
+	}
+}
+
+static void walkExpression(struct Expression* expr WALK_EXPRESSION_PARAMS){
+	if(expr) walkExpressionAt(expr, 0 WALK_EXPRESSION_ARGS);
+}
+
+#undef WALK_EXPRESSION_TYPES
+#undef WALK_RECURSION_DEPTH
+#undef LOCAL_FRAMES
+#undef WALK_SKIPS
@@ -1,55 +1,223 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdbool.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <parser.h>
 #include <display.h>
 #include <emitter.h>
+#include <symbol.h>
+#include <astpool.h>
 
-static char* readFile(const char* path){
-	FILE* file = fopen(path, "rb");
-	if(!file) {
+//files smaller than this are cheaper to read than to map
+#define MMAP_THRESHOLD (64 * 1024)
+
+struct SourceFile {
+	const char* text;
+	size_t length;
+	bool mapped;
+};
+
+static void readAll(int fd, size_t sizeHint, const char* path, struct SourceFile* src){
+	size_t capacity = sizeHint > 0 ? sizeHint : MMAP_THRESHOLD;
+	size_t length = 0;
+
+	char* buffer = (char*)malloc(capacity);
+	if(!buffer){
+		fprintf(stderr, "Unable to allocatate memory for reading \"%s\".\n", path);
+		exit(EXIT_FAILURE);
+	}
+
+	//pipes and stdin don't know their size up front so keep going until EOF
+	for(;;){
+		if(length == capacity){
+			capacity *= 2;
+			buffer = (char*)realloc(buffer, capacity);
+			if(!buffer){
+				fprintf(stderr, "Unable to allocatate memory for reading \"%s\".\n", path);
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		ssize_t got = read(fd, buffer + length, capacity - length);
+		if(got < 0){
+			if(errno == EINTR) continue;
+			fprintf(stderr, "Unable to read file \"%s\".\n", path);
+			exit(EXIT_FAILURE);
+		}
+		if(got == 0) break;
+
+		length += got;
+	}
+
+	src->text = buffer;
+	src->length = length;
+	src->mapped = false;
+}
+
+static struct SourceFile openSource(const char* path){
+	struct SourceFile src = {0};
+
+	bool fromStdin = strcmp(path, "-") == 0;
+	int fd = fromStdin ? STDIN_FILENO : open(path, O_RDONLY);
+	if(fd < 0) {
 		fprintf(stderr, "Unable to open file \"%s\".\n", path);
 		exit(EXIT_FAILURE);
 	}
-	fseek(file, 0L, SEEK_END);
-	size_t fileSize = ftell(file);
-	rewind(file);
 
-	char* buffer = (char*)malloc(fileSize + 1);
-	if(!buffer){
-		fprintf(stderr, "Unable to allocatate memory for reading \"%s\".\n", path);
+	struct stat st;
+	bool regularFile = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+
+	if(regularFile && st.st_size >= MMAP_THRESHOLD){
+		//the lexer never writes to the source, so map it read-only and lex it in place
+		void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(map != MAP_FAILED){
+			madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+			src.text = (const char*)map;
+			src.length = st.st_size;
+			src.mapped = true;
+		}
+	}
+
+	if(src.text == NULL){
+		readAll(fd, regularFile ? (size_t)st.st_size + 1 : 0, path, &src);
+	}
+
+	if(!fromStdin) close(fd);
+	return src;
+}
+
+static void closeSource(struct SourceFile* src){
+	if(src->mapped){
+		munmap((void*)src->text, src->length);
+	} else {
+		free((void*)src->text);
+	}
+
+	src->text = NULL;
+	src->length = 0;
+}
+
+static int openStream(const char* path){
+	if(strcmp(path, "-") == 0) return STDIN_FILENO;
+
+	int fd = open(path, O_RDONLY);
+	if(fd < 0) {
+		fprintf(stderr, "Unable to open file \"%s\".\n", path);
 		exit(EXIT_FAILURE);
 	}
 
-	size_t bytesRead = fread(buffer, sizeof(char), fileSize, file); 
-	if(bytesRead < fileSize) {
-		fprintf(stderr, "Unable to read file \"%s\".\n", path);
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+	return fd;
+}
+
+static bool hasSuffix(const char* text, const char* suffix){
+	size_t length = strlen(text), suffixLength = strlen(suffix);
+	return length >= suffixLength && strcmp(text + length - suffixLength, suffix) == 0;
+}
+
+//the AST file goes next to the VHDL: design.vent -> design.vast
+static char* astFileName(const char* ventName){
+	const char* base = strrchr(ventName, '/');
+	base = base ? base + 1 : ventName;
+	if(strcmp(base, "-") == 0) base = "a";
+
+	size_t length = strlen(base);
+	if(hasSuffix(base, ".vent")) length -= strlen(".vent");
+
+	char* name = (char*)malloc(length + strlen(".vast") + 1);
+	if(!name){
+		fprintf(stderr, "Unable to allocatate memory for the AST file name.\n");
 		exit(EXIT_FAILURE);
 	}
-	buffer[bytesRead-1] = '\0';
 
-	fclose(file);
-	return buffer;
+	memcpy(name, base, length);
+	strcpy(name + length, ".vast");
+	return name;
+}
+
+static void emitAstFile(struct Program* prog, const char* fileName){
+	char* astName = astFileName(fileName);
+
+	struct AstPool* pool = PackProgram(prog);
+	if(pool && WriteAstPool(pool, astName)){
+		printf("AST written to %s\r\n", astName);
+	}
+
+	FreeAstPool(pool);
+	free(astName);
 }
 
-static void doTranspile(char* fileName, bool printProgramTree, bool printTokens){
-		char* ventSrc = readFile(fileName);
+//an AST file from --emit-ast-bin is mapped and transpiled without parsing
+static void doTranspileAst(char* fileName, bool printProgramTree, bool astStats){
+		struct AstPool* pool = LoadAstPool(fileName);
+		if(pool == NULL) exit(EXIT_FAILURE);
+
+		struct Program* prog = UnpackProgram(pool);
+		if(prog == NULL) exit(EXIT_FAILURE);
+
+		if(printProgramTree) PrintProgram(prog);
+		if(astStats) PrintAstPoolStats(pool);
+		TranspileProgram(prog, fileName);
+
+		printf("Transpilation complete!\r\n");
+
+		FreeUnpackedProgram(prog);
+		FreeAstPool(pool);
+		FreeSymbolTable();
+}
+
+static void doTranspile(char* fileName, bool printProgramTree, bool printTokens, bool preLex, bool share, bool stream, int jobs, bool astStats, bool emitAstBin){
+		struct SourceFile ventSrc = {0};
+		int ventFd = -1;
 		
-		if(printTokens) SetPrintTokenFlag();
-		struct Program* prog = ParseProgram(ventSrc);
+		VentParser* parser = InitVentParser();
+		if(parser == NULL) exit(EXIT_FAILURE);
+
+		SetVentParserPrintTokens(parser, printTokens);
+		SetVentParserPreLex(parser, preLex);
+		SetVentParserShareExpressions(parser, share);
+		SetVentParserJobs(parser, jobs);
+
+		struct Program* prog = NULL;
+		if(stream){
+			//lex straight from the file a chunk at a time, nothing is pre-lexed
+			ventFd = openStream(fileName);
+			prog = ParseVentProgramFromFd(parser, ventFd);
+		} else {
+			ventSrc = openSource(fileName);
+			prog = ParseVentProgram(parser, ventSrc.text, ventSrc.length);
+		}
 
 		if(printProgramTree) PrintProgram(prog);
+		if(astStats){
+			struct AstPool* pool = PackProgram(prog);
+			PrintAstPoolStats(pool);
+			FreeAstPool(pool);
+		}
+		if(emitAstBin) emitAstFile(prog, fileName);
 		TranspileProgram(prog, fileName);
 
 		printf("Transpilation complete");
-		if(ThereWasAnError()){
+		if(VentParserHadError(parser)){
 			printf(" with errors");
 		}
 		printf("!\r\n");		
 
-		FreeProgram(prog);
-		free(ventSrc);
+		FreeVentProgram(parser, prog);
+		FreeVentParser(parser);
+		FreeSymbolTable();
+		if(stream){
+			if(ventFd != STDIN_FILENO) close(ventFd);
+		} else {
+			closeSource(&ventSrc);
+		}
 }
 
 int main(int argc, char* argv[]) {
@@ -61,16 +229,40 @@ int main(int argc, char* argv[]) {
 
 	bool printProgramTree = false;
 	bool printTokens = false;
+	bool preLex = false;
+	bool share = false;
+	bool stream = false;
+	bool astStats = false;
+	bool emitAstBin = false;
+	int jobs = 1;
 
-	if(argc == 3){
-		if(strcmp("--print-tokens", argv[2]) == 0){
+	for(int i = 2; i < argc; i++){
+		if(strcmp("--print-tokens", argv[i]) == 0){
+			//the pre-lexed stream can be dumped in one go
 			printTokens = true;
-		} else if(strcmp("--print-ast", argv[2]) == 0){
+			preLex = true;
+		} else if(strcmp("--print-ast", argv[i]) == 0){
 			printProgramTree = true;
+		} else if(strcmp("--pre-lex", argv[i]) == 0){
+			preLex = true;
+		} else if(strcmp("--share-expressions", argv[i]) == 0){
+			share = true;
+		} else if(strcmp("--ast-stats", argv[i]) == 0){
+			astStats = true;
+		} else if(strcmp("--emit-ast-bin", argv[i]) == 0){
+			emitAstBin = true;
+		} else if(strcmp("--stream", argv[i]) == 0){
+			stream = true;
+		} else if(strcmp("--jobs", argv[i]) == 0 && i + 1 < argc){
+			jobs = atoi(argv[++i]);
 		}
 	}
 	
-	doTranspile(argv[1], printProgramTree, printTokens);
+	if(hasSuffix(argv[1], ".vast")){
+		doTranspileAst(argv[1], printProgramTree, astStats);
+	} else {
+		doTranspile(argv[1], printProgramTree, printTokens, preLex, share, stream, jobs, astStats, emitAstBin);
+	}
 
 	return 0;
 }
@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <arena.h>
+
+#define DEFAULT_CHUNK_SIZE (4 * 1024)
+#define MAX_CHUNK_SIZE (1024 * 1024)
+#define ARENA_ALIGN (_Alignof(max_align_t))
+
+struct arenaChunk {
+	struct arenaChunk* next;
+	size_t used;
+	size_t capacity;
+	_Alignas(max_align_t) char data[];
+};
+
+struct releaseHook {
+	struct releaseHook* next;
+	ArenaReleaseFn release;
+	void* ptr;
+};
+
+struct Arena {
+	struct arenaChunk* chunks;
+	struct releaseHook* hooks;
+	size_t nextChunkSize;
+	size_t bytesUsed;
+	size_t chunkCount;
+};
+
+static size_t alignUp(size_t size){
+	return (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+static struct arenaChunk* addChunk(struct Arena* arena, size_t size){
+	size_t capacity = arena->nextChunkSize;
+	if(capacity < size) capacity = alignUp(size);
+
+	struct arenaChunk* chunk = malloc(sizeof(struct arenaChunk) + capacity);
+	if(chunk == NULL){
+		printf("Error: Unable to allocate arena chunk\r\n");
+		return NULL;
+	}
+
+	chunk->used = 0;
+	chunk->capacity = capacity;
+	chunk->next = arena->chunks;
+	arena->chunks = chunk;
+	arena->chunkCount++;
+
+	//grow geometrically so big trees still only need a few chunks
+	if(arena->nextChunkSize < MAX_CHUNK_SIZE) arena->nextChunkSize *= 2;
+
+	return chunk;
+}
+
+// public interface
+
+struct Arena* InitArena(size_t chunkSize){
+	struct Arena* arena = calloc(1, sizeof(struct Arena));
+	if(arena == NULL){
+		printf("Error: Unable to allocate arena\r\n");
+		return arena;
+	}
+
+	arena->nextChunkSize = chunkSize > 0 ? alignUp(chunkSize) : DEFAULT_CHUNK_SIZE;
+
+	return arena;
+}
+
+void FreeArena(struct Arena* arena){
+	if(arena == NULL) return;
+
+	//hooks live in the chunks, so run them all before anything is freed
+	for(struct releaseHook* hook = arena->hooks; hook != NULL; hook = hook->next){
+		hook->release(hook->ptr);
+	}
+
+	struct arenaChunk* chunk = arena->chunks;
+	while(chunk != NULL){
+		struct arenaChunk* next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+
+	free(arena);
+}
+
+void* ArenaAlloc(struct Arena* arena, size_t size){
+	if(arena == NULL) return NULL;
+
+	size = alignUp(size > 0 ? size : 1);
+
+	struct arenaChunk* chunk = arena->chunks;
+	if(chunk == NULL || chunk->capacity - chunk->used < size){
+		chunk = addChunk(arena, size);
+		if(chunk == NULL) return NULL;
+	}
+
+	void* mem = chunk->data + chunk->used;
+	chunk->used += size;
+	arena->bytesUsed += size;
+
+	memset(mem, 0, size);
+	return mem;
+}
+
+char* ArenaCopyString(struct Arena* arena, const char* text, size_t length){
+	char* copy = ArenaAlloc(arena, length + 1);
+	if(copy == NULL) return NULL;
+
+	memcpy(copy, text, length);
+	copy[length] = '\0';
+
+	return copy;
+}
+
+bool ArenaOnRelease(struct Arena* arena, ArenaReleaseFn release, void* ptr){
+	struct releaseHook* hook = ArenaAlloc(arena, sizeof(struct releaseHook));
+	if(hook == NULL) return false;
+
+	hook->release = release;
+	hook->ptr = ptr;
+	hook->next = arena->hooks;
+	arena->hooks = hook;
+
+	return true;
+}
+
+size_t ArenaBytesUsed(struct Arena* arena){
+	return arena != NULL ? arena->bytesUsed : 0;
+}
+
+size_t ArenaChunkCount(struct Arena* arena){
+	return arena != NULL ? arena->chunkCount : 0;
+}
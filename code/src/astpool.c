@@ -0,0 +1,1932 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <astpool.h>
+#include <ast.h>
+#include <arena.h>
+#include <dht.h>
+#include <symbol.h>
+
+enum PoolTag {
+	POOL_LIST = 1,
+	POOL_USE,
+	POOL_ENTITY,
+	POOL_ARCHITECTURE,
+	POOL_PORT,
+	POOL_GENERIC,
+	POOL_TYPE_DECL,
+	POOL_SIGNAL_DECL,
+	POOL_VARIABLE_DECL,
+	POOL_COMPONENT_DECL,
+	POOL_PROCESS,
+	POOL_INSTANCE,
+	POOL_SIGNAL_ASSIGN,
+	POOL_FOR,
+	POOL_IF,
+	POOL_LOOP,
+	POOL_NEXT,
+	POOL_EXIT,
+	POOL_RETURN,
+	POOL_NULL,
+	POOL_QSIGNAL_ASSIGN,
+	POOL_SWITCH,
+	POOL_VARIABLE_ASSIGN,
+	POOL_WAIT,
+	POOL_WHILE,
+	POOL_ASSERT,
+	POOL_REPORT,
+	POOL_CASE,
+	POOL_CHOICE,
+	POOL_RANGE,
+	POOL_DATA_TYPE,
+	POOL_LABEL,
+	POOL_PORT_MODE,
+	POOL_IDENTIFIER,
+	POOL_BINARY,
+	POOL_UNARY,
+	POOL_ATTRIBUTE,
+	POOL_CALL,
+	POOL_LITERAL,
+	POOL_TAG_COUNT
+};
+
+//what a field holds, LoadAstPool checks every field of a file against it
+enum FieldKind {
+	FIELD_VALUE = 0,		//a plain number
+	FIELD_STRING,			//offset into the chars
+	FIELD_NODE,				//any node, used for list entries
+	FIELD_EXPRESSION,		//any expression, the only nodes that can be shared
+	FIELD_IDENTIFIER,
+	FIELD_LABEL,
+	FIELD_RANGE,
+	FIELD_DATA_TYPE,
+	FIELD_PORT_MODE,
+	FIELD_REPORT,
+	FIELD_IF,
+	FIELD_CHOICE,
+	FIELD_CHOICE_VALUE,		//a range or an expression, by the choice's flags
+	FIELD_STATEMENT,
+	FIELD_DECLARATION,
+	FIELD_CONCURRENT,
+	FIELD_PORT,
+	FIELD_GENERIC,
+	FIELD_CASE,
+	FIELD_UNIT,
+};
+
+//a list whose entries are all of one kind
+#define FIELD_LIST				0x80
+#define LIST_OF(kind)			(FIELD_LIST | (kind))
+
+#define MAX_POOL_FIELDS 5
+
+//name, number of fields after the header word and field kinds of every tag
+static const struct {
+	const char* name;
+	uint8_t fields;
+	uint8_t kinds[MAX_POOL_FIELDS];
+} tagInfo[POOL_TAG_COUNT] = {
+	[POOL_LIST]				= {"List", 0},
+	[POOL_USE]				= {"UseStatement", 2, {FIELD_STRING, FIELD_STRING}},
+	[POOL_ENTITY]			= {"EntityDecl", 3, {FIELD_IDENTIFIER, LIST_OF(FIELD_GENERIC), LIST_OF(FIELD_PORT)}},
+	[POOL_ARCHITECTURE]		= {"ArchitectureDecl", 4, {FIELD_IDENTIFIER, FIELD_IDENTIFIER, LIST_OF(FIELD_DECLARATION), LIST_OF(FIELD_CONCURRENT)}},
+	[POOL_PORT]				= {"PortDecl", 4, {FIELD_VALUE, LIST_OF(FIELD_IDENTIFIER), FIELD_PORT_MODE, FIELD_DATA_TYPE}},
+	[POOL_GENERIC]			= {"GenericDecl", 4, {FIELD_VALUE, LIST_OF(FIELD_IDENTIFIER), FIELD_DATA_TYPE, FIELD_EXPRESSION}},
+	[POOL_TYPE_DECL]		= {"TypeDecl", 2, {FIELD_IDENTIFIER, LIST_OF(FIELD_EXPRESSION)}},
+	[POOL_SIGNAL_DECL]		= {"SignalDecl", 3, {FIELD_IDENTIFIER, FIELD_DATA_TYPE, FIELD_EXPRESSION}},
+	[POOL_VARIABLE_DECL]	= {"VariableDecl", 3, {FIELD_IDENTIFIER, FIELD_DATA_TYPE, FIELD_EXPRESSION}},
+	[POOL_COMPONENT_DECL]	= {"ComponentDecl", 3, {FIELD_IDENTIFIER, LIST_OF(FIELD_GENERIC), LIST_OF(FIELD_PORT)}},
+	[POOL_PROCESS]			= {"Process", 4, {FIELD_LABEL, LIST_OF(FIELD_IDENTIFIER), LIST_OF(FIELD_DECLARATION), LIST_OF(FIELD_STATEMENT)}},
+	[POOL_INSTANCE]			= {"Instantiation", 4, {FIELD_LABEL, FIELD_IDENTIFIER, LIST_OF(FIELD_EXPRESSION), LIST_OF(FIELD_EXPRESSION)}},
+	[POOL_SIGNAL_ASSIGN]	= {"SignalAssign", 3, {FIELD_LABEL, FIELD_IDENTIFIER, FIELD_EXPRESSION}},
+	[POOL_FOR]				= {"ForStatement", 4, {FIELD_LABEL, FIELD_IDENTIFIER, FIELD_RANGE, LIST_OF(FIELD_STATEMENT)}},
+	[POOL_IF]				= {"IfStatement", 5, {FIELD_LABEL, FIELD_EXPRESSION, LIST_OF(FIELD_STATEMENT), FIELD_IF, LIST_OF(FIELD_STATEMENT)}},
+	[POOL_LOOP]				= {"LoopStatement", 2, {FIELD_LABEL, LIST_OF(FIELD_STATEMENT)}},
+	[POOL_NEXT]				= {"NextStatement", 3, {FIELD_LABEL, FIELD_LABEL, FIELD_EXPRESSION}},
+	[POOL_EXIT]				= {"ExitStatement", 3, {FIELD_LABEL, FIELD_LABEL, FIELD_EXPRESSION}},
+	[POOL_RETURN]			= {"ReturnStatement", 2, {FIELD_LABEL, FIELD_EXPRESSION}},
+	[POOL_NULL]				= {"NullStatement", 1, {FIELD_LABEL}},
+	[POOL_QSIGNAL_ASSIGN]	= {"SignalAssign (seq)", 2, {FIELD_IDENTIFIER, FIELD_EXPRESSION}},
+	[POOL_SWITCH]			= {"SwitchStatement", 3, {FIELD_LABEL, FIELD_EXPRESSION, LIST_OF(FIELD_CASE)}},
+	[POOL_VARIABLE_ASSIGN]	= {"VariableAssign", 4, {FIELD_LABEL, FIELD_IDENTIFIER, FIELD_STRING, FIELD_EXPRESSION}},
+	[POOL_WAIT]				= {"WaitStatement", 4, {FIELD_LABEL, LIST_OF(FIELD_IDENTIFIER), FIELD_EXPRESSION, FIELD_EXPRESSION}},
+	[POOL_WHILE]			= {"WhileStatement", 3, {FIELD_LABEL, FIELD_EXPRESSION, LIST_OF(FIELD_STATEMENT)}},
+	[POOL_ASSERT]			= {"AssertStatement", 3, {FIELD_LABEL, FIELD_EXPRESSION, FIELD_REPORT}},
+	[POOL_REPORT]			= {"ReportStatement", 2, {FIELD_LABEL, FIELD_EXPRESSION}},
+	[POOL_CASE]				= {"CaseStatement", 2, {FIELD_CHOICE, LIST_OF(FIELD_STATEMENT)}},
+	[POOL_CHOICE]			= {"Choice", 2, {FIELD_CHOICE_VALUE, FIELD_CHOICE}},
+	[POOL_RANGE]			= {"Range", 2, {FIELD_EXPRESSION, FIELD_EXPRESSION}},
+	[POOL_DATA_TYPE]		= {"DataType", 2, {FIELD_STRING, FIELD_RANGE}},
+	[POOL_LABEL]			= {"Label", 1, {FIELD_STRING}},
+	[POOL_PORT_MODE]		= {"PortMode", 1, {FIELD_STRING}},
+	[POOL_IDENTIFIER]		= {"Identifier", 1, {FIELD_STRING}},
+	[POOL_BINARY]			= {"BinaryExpr", 3, {FIELD_EXPRESSION, FIELD_STRING, FIELD_EXPRESSION}},
+	[POOL_UNARY]			= {"UnaryExpr", 2, {FIELD_STRING, FIELD_EXPRESSION}},
+	[POOL_ATTRIBUTE]		= {"AttributeExpr", 2, {FIELD_EXPRESSION, FIELD_EXPRESSION}},
+	[POOL_CALL]				= {"CallExpr", 2, {FIELD_EXPRESSION, LIST_OF(FIELD_EXPRESSION)}},
+	[POOL_LITERAL]			= {"Num/Char/StringExpr", 1, {FIELD_STRING}},
+};
+
+//header word: tag | AST node type | flags
+#define makeHeader(tag, type, flags)	((uint32_t)(tag) | ((uint32_t)(type) << 8) | ((uint32_t)(flags) << 16))
+#define headerTag(h)					((h) & 0xFF)
+#define headerType(h)					(((h) >> 8) & 0xFF)
+#define headerFlags(h)					((h) >> 16)
+
+//list header word: POOL_LIST | count
+#define makeListHeader(count)			((uint32_t)POOL_LIST | ((uint32_t)(count) << 8))
+#define listCount(h)					((h) >> 8)
+#define MAX_LIST_COUNT					(UINT32_MAX >> 8)
+
+//every allocation the pointer tree makes in its arena is rounded up to this
+#define TREE_ALIGN (_Alignof(max_align_t))
+
+struct AstPool {
+	uint32_t* words;
+	uint32_t wordCount;
+	uint32_t wordCapacity;
+
+	char* chars;
+	uint32_t charCount;
+	uint32_t charCapacity;
+
+	uint32_t units;
+	uint32_t nodeCount;
+	bool failed;
+
+	//only used while packing
+	struct DynamicHashTable* shared;
+	struct DynamicHashTable* strings;
+	Dba* stack;
+
+	//what the nodes cost in the tree the pool was packed from
+	uint32_t treeCount[POOL_TAG_COUNT];
+	size_t treeBytes[POOL_TAG_COUNT];
+	size_t treeStringBytes;
+
+	//the file the words and chars are mapped from, see LoadAstPool
+	void* map;
+	size_t mapLength;
+};
+
+//an AST file is this header then the words then the chars, in host byte order
+#define AST_FILE_MAGIC		"VENTAST"
+#define AST_FILE_VERSION	2
+#define AST_FILE_ORDER		0x01020304u
+
+struct AstFileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint32_t wordCount;
+	uint32_t charCount;
+	uint32_t units;
+	uint32_t nodeCount;
+};
+
+static size_t treeSize(size_t size){
+	return (size + TREE_ALIGN - 1) & ~(TREE_ALIGN - 1);
+}
+
+static bool growWords(struct AstPool* pool, uint32_t more){
+	if(pool->failed) return false;
+	if(pool->wordCount + (uint64_t)more <= pool->wordCapacity) return true;
+
+	uint64_t capacity = pool->wordCapacity ? pool->wordCapacity : 1024;
+	while(capacity < pool->wordCount + (uint64_t)more) capacity *= 2;
+
+	uint32_t* words = capacity <= UINT32_MAX ? realloc(pool->words, capacity * sizeof(uint32_t)) : NULL;
+	if(words == NULL){
+		printf("Error: Unable to allocate AST pool\r\n");
+		pool->failed = true;
+		return false;
+	}
+
+	pool->words = words;
+	pool->wordCapacity = capacity;
+	return true;
+}
+
+//reserves a node with all fields 0, fields are filled in once the children are packed
+static uint32_t newPoolNode(struct AstPool* pool, enum PoolTag tag, enum AstNodeType type, uint16_t flags, size_t treeBytes){
+	uint32_t fields = tagInfo[tag].fields;
+	if(!growWords(pool, fields + 1)) return 0;
+
+	uint32_t ref = pool->wordCount;
+	pool->words[ref] = makeHeader(tag, type, flags);
+	memset(&(pool->words[ref + 1]), 0, fields * sizeof(uint32_t));
+	pool->wordCount += fields + 1;
+
+	pool->nodeCount++;
+	pool->treeCount[tag]++;
+	pool->treeBytes[tag] += treeBytes;
+
+	return ref;
+}
+
+static void setField(struct AstPool* pool, uint32_t ref, int field, uint32_t value){
+	if(ref != 0) pool->words[ref + field] = value;
+}
+
+static uint32_t newPoolList(struct AstPool* pool, uint32_t count, size_t treeBytes){
+	if(count > MAX_LIST_COUNT || !growWords(pool, count + 1)){
+		pool->failed = true;
+		return 0;
+	}
+
+	uint32_t ref = pool->wordCount;
+	pool->words[ref] = makeListHeader(count);
+	memset(&(pool->words[ref + 1]), 0, count * sizeof(uint32_t));
+	pool->wordCount += count + 1;
+
+	pool->treeCount[POOL_LIST]++;
+	pool->treeBytes[POOL_LIST] += treeBytes;
+
+	return ref;
+}
+
+static uint32_t packString(struct AstPool* pool, const char* text, bool ownedByTree){
+	if(text == NULL || pool->failed) return 0;
+
+	size_t length = strlen(text);
+	if(ownedByTree) pool->treeStringBytes += treeSize(length + 1);
+
+	//every distinct string is stored once
+	uint64_t offset = 0;
+	if(GetInHashTable(pool->strings, (char*)text, &offset)) return (uint32_t)offset;
+
+	if(pool->charCount + (uint64_t)length + 1 > pool->charCapacity){
+		uint64_t capacity = pool->charCapacity ? pool->charCapacity : 1024;
+		while(capacity < pool->charCount + (uint64_t)length + 1) capacity *= 2;
+
+		char* chars = capacity <= UINT32_MAX ? realloc(pool->chars, capacity) : NULL;
+		if(chars == NULL){
+			printf("Error: Unable to allocate AST pool\r\n");
+			pool->failed = true;
+			return 0;
+		}
+		pool->chars = chars;
+		pool->charCapacity = capacity;
+	}
+
+	offset = pool->charCount;
+	memcpy(&(pool->chars[offset]), text, length + 1);
+	pool->charCount += length + 1;
+
+	SetInHashTable(pool->strings, (char*)text, offset);
+	return (uint32_t)offset;
+}
+
+//a Dba costs its header, the inline blocks it leaves unused and the arena hook
+//that frees it, the blocks in use are counted by the nodes stored in them
+static size_t treeBlockArraySize(Dba* arr, size_t bsize){
+	size_t localBlocks = (BlockArraySize(bsize) - BlockArraySize(0)) / bsize;
+	size_t used = (size_t)BlockCount(arr) < localBlocks ? (size_t)BlockCount(arr) : localBlocks;
+	return treeSize(BlockArraySize(bsize)) - used * bsize + treeSize(3 * sizeof(void*));
+}
+
+// packing
+
+static uint32_t packExpression(struct AstPool* pool, struct Expression* expr);
+static uint32_t packSequentialStatements(struct AstPool* pool, StmtVec* stmts);
+static uint32_t packDeclarations(struct AstPool* pool, Dba* decls);
+
+static uint32_t packIdentifier(struct AstPool* pool, struct Identifier* ident){
+	return packExpression(pool, (struct Expression*)ident);
+}
+
+//the parser doubles a list block from 4 entries, the last block is what it keeps
+static size_t treeListSize(uint32_t count){
+	uint32_t capacity = 4;
+	while(capacity < count) capacity *= 2;
+	return treeSize(offsetof(struct ExpressionList, items) + capacity * sizeof(void*));
+}
+
+static uint32_t packExpressionList(struct AstPool* pool, struct ExpressionList* eList){
+	if(eList == NULL) return 0;
+
+	uint32_t list = newPoolList(pool, eList->count, treeListSize(eList->count));
+	for(uint32_t i = 0; i < eList->count; i++){
+		setField(pool, list, i + 1, packExpression(pool, eList->items[i]));
+	}
+
+	return list;
+}
+
+static uint32_t packIdentifierList(struct AstPool* pool, struct IdentifierList* idents){
+	if(idents == NULL) return 0;
+
+	uint32_t list = newPoolList(pool, idents->count, treeListSize(idents->count));
+	for(uint32_t i = 0; i < idents->count; i++){
+		setField(pool, list, i + 1, packIdentifier(pool, idents->items[i]));
+	}
+
+	return list;
+}
+
+//an expression waiting to be packed into a field of an already packed node
+struct PackItem {
+	struct Expression* expr;
+	uint32_t parent;	//0 for the root of the walk
+	int field;
+};
+
+static void pushPackItem(Dba* stack, struct Expression* expr, uint32_t parent, int field){
+	if(expr == NULL) return;
+
+	struct PackItem item = {expr, parent, field};
+	WriteBlockArray(stack, (char*)&item);
+}
+
+//packs one node, its operands are pushed last to first so they land in preorder
+static uint32_t packExpressionNode(struct AstPool* pool, struct Expression* expr, Dba* stack){
+	//a node shared by more than one parent is packed once
+	char key[2 * sizeof(void*) + 3];
+	snprintf(key, sizeof(key), "%p", (void*)expr);
+	uint64_t seen = 0;
+	if(GetInHashTable(pool->shared, key, &seen)) return (uint32_t)seen;
+
+	uint32_t ref = 0;
+	switch(expr->type){
+		case NAME_EXPR: {
+			struct Identifier* ident = (struct Identifier*)expr;
+			ref = newPoolNode(pool, POOL_IDENTIFIER, expr->root.type, expr->type, treeSize(sizeof(struct Identifier)));
+			setField(pool, ref, 1, packString(pool, ident->value, false));
+			break;
+		}
+
+		case BINARY_EXPR: {
+			struct BinaryExpr* bexp = (struct BinaryExpr*)expr;
+			ref = newPoolNode(pool, POOL_BINARY, expr->root.type, expr->type, treeSize(sizeof(struct BinaryExpr)));
+			setField(pool, ref, 2, packString(pool, bexp->op, true));
+			pushPackItem(stack, bexp->right, ref, 3);
+			pushPackItem(stack, bexp->left, ref, 1);
+			break;
+		}
+
+		case UNARY_EXPR: {
+			struct UnaryExpr* uexp = (struct UnaryExpr*)expr;
+			ref = newPoolNode(pool, POOL_UNARY, expr->root.type, expr->type, treeSize(sizeof(struct UnaryExpr)));
+			setField(pool, ref, 1, packString(pool, uexp->op, true));
+			pushPackItem(stack, uexp->right, ref, 2);
+			break;
+		}
+
+		case ATTRIBUTE_EXPR: {
+			struct AttributeExpr* aexp = (struct AttributeExpr*)expr;
+			ref = newPoolNode(pool, POOL_ATTRIBUTE, expr->root.type, expr->type, treeSize(sizeof(struct AttributeExpr)));
+			pushPackItem(stack, aexp->attribute, ref, 2);
+			pushPackItem(stack, aexp->object, ref, 1);
+			break;
+		}
+
+		case CALL_EXPR: {
+			struct CallExpr* cexp = (struct CallExpr*)expr;
+			ref = newPoolNode(pool, POOL_CALL, expr->root.type, expr->type, treeSize(sizeof(struct CallExpr)));
+
+			if(cexp->arguments){
+				uint32_t count = cexp->arguments->count;
+				uint32_t list = newPoolList(pool, count, treeListSize(count));
+				setField(pool, ref, 2, list);
+
+				//pushed last to first, so the first argument is on top
+				for(uint32_t i = count; i > 0; i--){
+					pushPackItem(stack, cexp->arguments->items[i - 1], list, i);
+				}
+			}
+
+			pushPackItem(stack, cexp->function, ref, 1);
+			break;
+		}
+
+		case NUM_EXPR:
+		case CHAR_EXPR:
+		case STRING_EXPR: {
+			//the three literal expressions share one layout
+			struct NumExpr* lexp = (struct NumExpr*)expr;
+			ref = newPoolNode(pool, POOL_LITERAL, expr->root.type, expr->type, treeSize(sizeof(struct NumExpr)));
+			setField(pool, ref, 1, packString(pool, lexp->literal, true));
+			break;
+		}
+
+		default:
+			printf("Error: Unable to pack expression type %d\r\n", expr->type);
+			pool->failed = true;
+			return 0;
+	}
+
+	SetInHashTable(pool->shared, key, ref);
+	return ref;
+}
+
+static uint32_t packExpression(struct AstPool* pool, struct Expression* expr){
+	if(expr == NULL || pool->failed) return 0;
+
+	//expressions can be chains of thousands of operators, so no recursion
+	Dba* stack = pool->stack;
+	pushPackItem(stack, expr, 0, 0);
+
+	uint32_t root = 0;
+	struct PackItem item;
+	while(!pool->failed && PopBlockArray(stack, (char*)&item)){
+		uint32_t ref = packExpressionNode(pool, item.expr, stack);
+
+		if(item.parent) setField(pool, item.parent, item.field, ref);
+		else root = ref;
+	}
+
+	//left over only if packing failed
+	while(PopBlockArray(stack, NULL));
+	return root;
+}
+
+static uint32_t packLabel(struct AstPool* pool, struct Label* label){
+	if(label == NULL) return 0;
+
+	uint32_t ref = newPoolNode(pool, POOL_LABEL, label->self.type, 0, treeSize(sizeof(struct Label)));
+	setField(pool, ref, 1, packString(pool, label->value, true));
+	return ref;
+}
+
+static uint32_t packRange(struct AstPool* pool, struct Range* range){
+	if(range == NULL) return 0;
+
+	uint32_t ref = newPoolNode(pool, POOL_RANGE, range->self.type, range->descending, treeSize(sizeof(struct Range)));
+	setField(pool, ref, 1, packExpression(pool, range->left));
+	setField(pool, ref, 2, packExpression(pool, range->right));
+	return ref;
+}
+
+static uint32_t packDataType(struct AstPool* pool, struct DataType* dtype){
+	if(dtype == NULL) return 0;
+
+	uint32_t ref = newPoolNode(pool, POOL_DATA_TYPE, dtype->self.type, 0, treeSize(sizeof(struct DataType)));
+	setField(pool, ref, 1, packString(pool, dtype->value, true));
+	setField(pool, ref, 2, packRange(pool, dtype->range));
+	return ref;
+}
+
+static uint32_t packPortMode(struct AstPool* pool, struct PortMode* pmode){
+	if(pmode == NULL) return 0;
+
+	uint32_t ref = newPoolNode(pool, POOL_PORT_MODE, pmode->self.type, 0, treeSize(sizeof(struct PortMode)));
+	setField(pool, ref, 1, packString(pool, pmode->value, true));
+	return ref;
+}
+
+static uint32_t packPorts(struct AstPool* pool, Dba* ports){
+	if(ports == NULL) return 0;
+
+	uint32_t list = newPoolList(pool, BlockCount(ports), treeBlockArraySize(ports, sizeof(struct PortDecl)));
+	for(int i = 0; i < BlockCount(ports); i++){
+		struct PortDecl* port = (struct PortDecl*)ReadBlockArray(ports, i);
+
+		uint32_t ref = newPoolNode(pool, POOL_PORT, port->self.type, 0, sizeof(struct PortDecl));
+		setField(pool, list, i + 1, ref);
+		setField(pool, ref, 1, port->position);
+		setField(pool, ref, 2, packIdentifierList(pool, port->names));
+		setField(pool, ref, 3, packPortMode(pool, port->pmode));
+		setField(pool, ref, 4, packDataType(pool, port->dtype));
+	}
+
+	return list;
+}
+
+static uint32_t packGenerics(struct AstPool* pool, Dba* generics){
+	if(generics == NULL) return 0;
+
+	uint32_t list = newPoolList(pool, BlockCount(generics), treeBlockArraySize(generics, sizeof(struct GenericDecl)));
+	for(int i = 0; i < BlockCount(generics); i++){
+		struct GenericDecl* generic = (struct GenericDecl*)ReadBlockArray(generics, i);
+
+		uint32_t ref = newPoolNode(pool, POOL_GENERIC, generic->self.type, 0, sizeof(struct GenericDecl));
+		setField(pool, list, i + 1, ref);
+		setField(pool, ref, 1, generic->position);
+		setField(pool, ref, 2, packIdentifierList(pool, generic->names));
+		setField(pool, ref, 3, packDataType(pool, generic->dtype));
+		setField(pool, ref, 4, packExpression(pool, generic->defaultValue));
+	}
+
+	return list;
+}
+
+static uint32_t packReport(struct AstPool* pool, struct Label* label, struct ReportStatement* report, size_t treeBytes){
+	uint32_t ref = newPoolNode(pool, POOL_REPORT, report->self.type, report->severity.level, treeBytes);
+	setField(pool, ref, 1, packLabel(pool, label));
+	setField(pool, ref, 2, packExpression(pool, report->stringExpr));
+	return ref;
+}
+
+//a branch whose else block is packed once the elsif branches after it are
+struct elseItem {
+	struct IfStatement* branch;
+	uint32_t ref;
+};
+
+//elsif branches are packed in a loop, a chain can be thousands long
+static uint32_t packIf(struct AstPool* pool, struct IfStatement* ifStmt, size_t treeBytes){
+	uint32_t first = 0, prev = 0;
+	Dba* elses = NULL;
+
+	for(struct IfStatement* branch = ifStmt; branch != NULL; branch = branch->elsif){
+		uint32_t ref = newPoolNode(pool, POOL_IF, branch->self.type, branch->inElsIf, treeBytes);
+		setField(pool, ref, 1, packLabel(pool, branch->label));
+		setField(pool, ref, 2, packExpression(pool, branch->antecedent));
+		setField(pool, ref, 3, packSequentialStatements(pool, branch->consequentStatements));
+
+		if(branch->alternativeStatements){
+			if(elses == NULL) elses = InitBlockArray(sizeof(struct elseItem));
+
+			struct elseItem item = {branch, ref};
+			WriteBlockArray(elses, (char*)&item);
+		}
+
+		if(prev) setField(pool, prev, 4, ref);
+		else first = ref;
+		prev = ref;
+
+		treeBytes = treeSize(sizeof(struct IfStatement));
+	}
+
+	//an else block follows the elsif branches of its if, innermost first, so
+	//the pool stays in the order WalkTree reaches the nodes
+	struct elseItem item;
+	while(elses && PopBlockArray(elses, (char*)&item)){
+		setField(pool, item.ref, 5, packSequentialStatements(pool, item.branch->alternativeStatements));
+	}
+	if(elses) FreeBlockArray(elses);
+
+	return first;
+}
+
+static uint32_t packChoices(struct AstPool* pool, struct Choice* choice){
+	uint32_t first = 0, prev = 0;
+
+	for(; choice != NULL; choice = choice->nextChoice){
+		uint32_t ref = newPoolNode(pool, POOL_CHOICE, 0, choice->type, treeSize(sizeof(struct Choice)));
+		if(choice->type == CHOICE_RANGE){
+			setField(pool, ref, 1, packRange(pool, choice->as.range));
+		} else {
+			setField(pool, ref, 1, packExpression(pool, choice->as.numExpr));
+		}
+
+		if(prev) setField(pool, prev, 2, ref);
+		else first = ref;
+		prev = ref;
+	}
+
+	return first;
+}
+
+static uint32_t packCases(struct AstPool* pool, Dba* cases){
+	if(cases == NULL) return 0;
+
+	uint32_t list = newPoolList(pool, BlockCount(cases), treeBlockArraySize(cases, sizeof(struct CaseStatement)));
+	for(int i = 0; i < BlockCount(cases); i++){
+		struct CaseStatement* aCase = (struct CaseStatement*)ReadBlockArray(cases, i);
+
+		uint32_t ref = newPoolNode(pool, POOL_CASE, aCase->self.type, aCase->defaultCase, sizeof(struct CaseStatement));
+		setField(pool, list, i + 1, ref);
+		setField(pool, ref, 1, packChoices(pool, aCase->choices));
+		setField(pool, ref, 2, packSequentialStatements(pool, aCase->statements));
+	}
+
+	return list;
+}
+
+static uint32_t packSequentialStatement(struct AstPool* pool, struct SequentialStatement* qstmt){
+	size_t slot = sizeof(struct SequentialStatement);
+	uint32_t ref = 0;
+
+	switch(qstmt->type){
+		case FOR_STATEMENT: {
+			struct ForStatement* stmt = &(qstmt->as.forStatement);
+			ref = newPoolNode(pool, POOL_FOR, stmt->self.type, 0, slot);
+			setField(pool, ref, 1, packLabel(pool, stmt->label));
+			setField(pool, ref, 2, packIdentifier(pool, stmt->parameter));
+			setField(pool, ref, 3, packRange(pool, stmt->range));
+			setField(pool, ref, 4, packSequentialStatements(pool, stmt->statements));
+			break;
+		}
+
+		case IF_STATEMENT: {
+			ref = packIf(pool, &(qstmt->as.ifStatement), slot);
+			break;
+		}
+
+		case LOOP_STATEMENT: {
+			struct LoopStatement* stmt = &(qstmt->as.loopStatement);
+			ref = newPoolNode(pool, POOL_LOOP, stmt->self.type, 0, slot);
+			setField(pool, ref, 1, packLabel(pool, stmt->label));
+			setField(pool, ref, 2, packSequentialStatements(pool, stmt->statements));
+			break;
+		}
+
+		case NEXT_STATEMENT:
+		case EXIT_STATEMENT: {
+			//next and exit share one layout
+			struct NextStatement* stmt = &(qstmt->as.nextStatement);
+			ref = newPoolNode(pool, qstmt->type == NEXT_STATEMENT ? POOL_NEXT : POOL_EXIT, stmt->self.type, 0, slot);
+			setField(pool, ref, 1, packLabel(pool, stmt->label));
+			setField(pool, ref, 2, packLabel(pool, stmt->loopLabel));
+			setField(pool, ref, 3, packExpression(pool, stmt->condition));
+			break;
+		}
+
+		case RETURN_STATEMENT: {
+			struct ReturnStatement* stmt = &(qstmt->as.returnStatement);
+			ref = newPoolNode(pool, POOL_RETURN, stmt->self.type, 0, slot);
+			setField(pool, ref, 1, packLabel(pool, stmt->label));
+			setField(pool, ref, 2, packExpression(pool, stmt->expression));
+			break;
+		}
+
+		case NULL_STATEMENT: {
+			struct NullStatement* stmt = &(qstmt->as.nullStatement);
+			ref = newPoolNode(pool, POOL_NULL, stmt->self.type, 0, slot);
+			setField(pool, ref, 1, packLabel(pool, stmt->label));
+			break;
+		}
+
+		case QSIGNAL_ASSIGNMENT: {
+			struct SignalAssign* stmt = &(qstmt->as.signalAssignment);
+			ref = newPoolNode(pool, POOL_QSIGNAL_ASSIGN, stmt->self.type, 0, slot);
+			setField(pool, ref, 1, packIdentifier(pool, stmt->target));
+			setField(pool, ref, 2, packExpression(pool, stmt->expression));
+			break;
+		}
+
+		case SWITCH_STATEMENT: {
+			struct SwitchStatement* stmt = &(qstmt->as.switchStatement);
+			ref = newPoolNode(pool, POOL_SWITCH, stmt->self.type, 0, slot);
+			setField(pool, ref, 1, packLabel(pool, stmt->label));
+			setField(pool, ref, 2, packExpression(pool, stmt->expression));
+			setField(pool, ref, 3, packCases(pool, stmt->cases));
+			break;
+		}
+
+		case VARIABLE_ASSIGNMENT: {
+			struct VariableAssign* stmt = &(qstmt->as.variableAssignment);
+			ref = newPoolNode(pool, POOL_VARIABLE_ASSIGN, stmt->self.type, 0, slot);
+			setField(pool, ref, 1, packLabel(pool, stmt->label));
+			setField(pool, ref, 2, packIdentifier(pool, stmt->target));
+			setField(pool, ref, 3, packString(pool, stmt->op, true));
+			setField(pool, ref, 4, packExpression(pool, stmt->expression));
+			break;
+		}
+
+		case WAIT_STATEMENT: {
+			struct WaitStatement* stmt = &(qstmt->as.waitStatement);
+			ref = newPoolNode(pool, POOL_WAIT, stmt->self.type, 0, slot);
+			setField(pool, ref, 1, packLabel(pool, stmt->label));
+			setField(pool, ref, 2, packIdentifierList(pool, stmt->sensitivityList));
+			setField(pool, ref, 3, packExpression(pool, stmt->condition));
+			setField(pool, ref, 4, packExpression(pool, stmt->time));
+			break;
+		}
+
+		case WHILE_STATEMENT: {
+			struct WhileStatement* stmt = &(qstmt->as.whileStatement);
+			ref = newPoolNode(pool, POOL_WHILE, stmt->self.type, 0, slot);
+			setField(pool, ref, 1, packLabel(pool, stmt->label));
+			setField(pool, ref, 2, packExpression(pool, stmt->condition));
+			setField(pool, ref, 3, packSequentialStatements(pool, stmt->statements));
+			break;
+		}
+
+		case ASSERT_STATEMENT: {
+			struct AssertStatement* stmt = &(qstmt->as.assertStatement);
+			ref = newPoolNode(pool, POOL_ASSERT, stmt->self.type, 0, slot);
+			setField(pool, ref, 1, packLabel(pool, stmt->label));
+			setField(pool, ref, 2, packExpression(pool, stmt->condition));
+			setField(pool, ref, 3, packReport(pool, stmt->report.label, &(stmt->report), 0));
+			break;
+		}
+
+		case REPORT_STATEMENT: {
+			struct ReportStatement* stmt = &(qstmt->as.reportStatement);
+			ref = packReport(pool, stmt->label, stmt, slot);
+			break;
+		}
+
+		default:
+			printf("Error: Unable to pack statement type %d\r\n", qstmt->type);
+			pool->failed = true;
+			break;
+	}
+
+	return ref;
+}
+
+static uint32_t packSequentialStatements(struct AstPool* pool, StmtVec* stmts){
+	if(stmts == NULL) return 0;
+
+	uint32_t list = newPoolList(pool, StmtVecCount(stmts), treeBlockArraySize(StmtVecArray(stmts), sizeof(struct SequentialStatement)));
+	for(int i = 0; i < StmtVecCount(stmts); i++){
+		uint32_t ref = packSequentialStatement(pool, StmtVecAt(stmts, i));
+		setField(pool, list, i + 1, ref);
+	}
+
+	return list;
+}
+
+static uint32_t packDeclaration(struct AstPool* pool, struct Declaration* decl){
+	size_t slot = sizeof(struct Declaration);
+	uint32_t ref = 0;
+
+	switch(decl->type){
+		case TYPE_DECLARATION: {
+			struct TypeDecl* tdecl = &(decl->as.typeDeclaration);
+			ref = newPoolNode(pool, POOL_TYPE_DECL, tdecl->self.type, 0, slot);
+			setField(pool, ref, 1, packIdentifier(pool, tdecl->typeName));
+			setField(pool, ref, 2, packExpressionList(pool, tdecl->enumList));
+			break;
+		}
+
+		case SIGNAL_DECLARATION:
+		case VARIABLE_DECLARATION: {
+			//signals and variables share one layout
+			struct SignalDecl* sdecl = &(decl->as.signalDeclaration);
+			enum PoolTag tag = decl->type == SIGNAL_DECLARATION ? POOL_SIGNAL_DECL : POOL_VARIABLE_DECL;
+			ref = newPoolNode(pool, tag, sdecl->self.type, 0, slot);
+			setField(pool, ref, 1, packIdentifier(pool, sdecl->name));
+			setField(pool, ref, 2, packDataType(pool, sdecl->dtype));
+			setField(pool, ref, 3, packExpression(pool, sdecl->expression));
+			break;
+		}
+
+		case COMPONENT_DECLARATION: {
+			struct ComponentDecl* cdecl = &(decl->as.componentDeclaration);
+			ref = newPoolNode(pool, POOL_COMPONENT_DECL, cdecl->self.type, 0, slot);
+			setField(pool, ref, 1, packIdentifier(pool, cdecl->name));
+			setField(pool, ref, 2, packGenerics(pool, cdecl->generics));
+			setField(pool, ref, 3, packPorts(pool, cdecl->ports));
+			break;
+		}
+
+		default:
+			printf("Error: Unable to pack declaration type %d\r\n", decl->type);
+			pool->failed = true;
+			break;
+	}
+
+	return ref;
+}
+
+static uint32_t packDeclarations(struct AstPool* pool, Dba* decls){
+	if(decls == NULL) return 0;
+
+	uint32_t list = newPoolList(pool, BlockCount(decls), treeBlockArraySize(decls, sizeof(struct Declaration)));
+	for(int i = 0; i < BlockCount(decls); i++){
+		uint32_t ref = packDeclaration(pool, (struct Declaration*)ReadBlockArray(decls, i));
+		setField(pool, list, i + 1, ref);
+	}
+
+	return list;
+}
+
+static uint32_t packConcurrentStatement(struct AstPool* pool, struct ConcurrentStatement* cstmt){
+	size_t slot = sizeof(struct ConcurrentStatement);
+	uint32_t ref = 0;
+
+	switch(cstmt->type){
+		case PROCESS: {
+			struct Process* proc = &(cstmt->as.process);
+			ref = newPoolNode(pool, POOL_PROCESS, proc->self.type, 0, slot);
+			setField(pool, ref, 1, packLabel(pool, cstmt->label));
+			setField(pool, ref, 2, packIdentifierList(pool, proc->sensitivityList));
+			setField(pool, ref, 3, packDeclarations(pool, proc->declarations));
+			setField(pool, ref, 4, packSequentialStatements(pool, proc->statements));
+			break;
+		}
+
+		case INSTANTIATION: {
+			struct Instantiation* inst = &(cstmt->as.instantiation);
+			ref = newPoolNode(pool, POOL_INSTANCE, inst->self.type, 0, slot);
+			setField(pool, ref, 1, packLabel(pool, cstmt->label));
+			setField(pool, ref, 2, packIdentifier(pool, inst->name));
+			setField(pool, ref, 3, packExpressionList(pool, inst->genericMap));
+			setField(pool, ref, 4, packExpressionList(pool, inst->portMap));
+			break;
+		}
+
+		case SIGNAL_ASSIGNMENT: {
+			struct SignalAssign* sassign = &(cstmt->as.signalAssignment);
+			ref = newPoolNode(pool, POOL_SIGNAL_ASSIGN, sassign->self.type, 0, slot);
+			setField(pool, ref, 1, packLabel(pool, cstmt->label));
+			setField(pool, ref, 2, packIdentifier(pool, sassign->target));
+			setField(pool, ref, 3, packExpression(pool, sassign->expression));
+			break;
+		}
+
+		default:
+			printf("Error: Unable to pack statement type %d\r\n", cstmt->type);
+			pool->failed = true;
+			break;
+	}
+
+	return ref;
+}
+
+static uint32_t packConcurrentStatements(struct AstPool* pool, Dba* stmts){
+	if(stmts == NULL) return 0;
+
+	uint32_t list = newPoolList(pool, BlockCount(stmts), treeBlockArraySize(stmts, sizeof(struct ConcurrentStatement)));
+	for(int i = 0; i < BlockCount(stmts); i++){
+		uint32_t ref = packConcurrentStatement(pool, (struct ConcurrentStatement*)ReadBlockArray(stmts, i));
+		setField(pool, list, i + 1, ref);
+	}
+
+	return list;
+}
+
+static uint32_t packDesignUnit(struct AstPool* pool, struct DesignUnit* unit){
+	size_t slot = sizeof(struct DesignUnit);
+	uint32_t ref = 0;
+
+	if(unit->type == USE_STATEMENT){
+		struct UseStatement* use = &(unit->as.useStatement);
+		ref = newPoolNode(pool, POOL_USE, use->self.type, 0, slot);
+		setField(pool, ref, 1, packString(pool, use->value, true));
+		setField(pool, ref, 2, packString(pool, use->library, true));
+	} else if(unit->as.libraryUnit.type == ENTITY){
+		struct EntityDecl* ent = &(unit->as.libraryUnit.as.entity);
+		ref = newPoolNode(pool, POOL_ENTITY, ent->self.type, 0, slot);
+		setField(pool, ref, 1, packIdentifier(pool, ent->name));
+		setField(pool, ref, 2, packGenerics(pool, ent->generics));
+		setField(pool, ref, 3, packPorts(pool, ent->ports));
+	} else {
+		struct ArchitectureDecl* arch = &(unit->as.libraryUnit.as.architecture);
+		ref = newPoolNode(pool, POOL_ARCHITECTURE, arch->self.type, 0, slot);
+		setField(pool, ref, 1, packIdentifier(pool, arch->archName));
+		setField(pool, ref, 2, packIdentifier(pool, arch->entName));
+		setField(pool, ref, 3, packDeclarations(pool, arch->declarations));
+		setField(pool, ref, 4, packConcurrentStatements(pool, arch->statements));
+	}
+
+	return ref;
+}
+
+// unpacking
+
+struct unpacker {
+	struct AstPool* pool;
+	struct Arena* arena;
+
+	//expressions already rebuilt, by reference, so shared nodes stay shared
+	void** shared;
+
+	//expressions still to be rebuilt, see unpackExpression
+	Dba* stack;
+};
+
+//references are followed as they are, a pool is either packed here or has
+//had every reference checked by LoadAstPool
+static uint32_t field(struct unpacker* up, uint32_t ref, int i){
+	return up->pool->words[ref + i];
+}
+
+static uint32_t header(struct unpacker* up, uint32_t ref){
+	return up->pool->words[ref];
+}
+
+static void* newTreeNode(struct unpacker* up, size_t size){
+	return ArenaAlloc(up->arena, size);
+}
+
+static char* unpackString(struct unpacker* up, uint32_t offset){
+	if(offset == 0) return NULL;
+
+	const char* text = &(up->pool->chars[offset]);
+	return ArenaCopyString(up->arena, text, strlen(text));
+}
+
+static void releaseBlockArray(void* arr){
+	FreeBlockArray((Dba*)arr);
+}
+
+static uint32_t listLength(struct unpacker* up, uint32_t list){
+	return list ? listCount(header(up, list)) : 0;
+}
+
+//the array is sized for the pool list it is rebuilt from, so filling it never reallocs
+static Dba* newTreeArray(struct unpacker* up, size_t bsize, uint32_t list){
+	Dba* arr = InitBlockArrayInPlace(newTreeNode(up, BlockArraySize(bsize)), bsize);
+	if(arr && !ArenaOnRelease(up->arena, releaseBlockArray, arr)){
+		FreeBlockArray(arr);
+		arr = NULL;
+	}
+	if(arr) ReserveBlockArray(arr, listLength(up, list));
+	return arr;
+}
+
+static struct Expression* unpackExpression(struct unpacker* up, uint32_t ref);
+static StmtVec* unpackSequentialStatements(struct unpacker* up, uint32_t list);
+static Dba* unpackDeclarations(struct unpacker* up, uint32_t list);
+
+static struct Identifier* unpackIdentifier(struct unpacker* up, uint32_t ref){
+	return (struct Identifier*)unpackExpression(up, ref);
+}
+
+//lists come back exactly as long as they are, nothing is appended to them after parsing
+static void* newTreeList(struct unpacker* up, uint32_t count){
+	struct ExpressionList* list = newTreeNode(up, offsetof(struct ExpressionList, items) + count * sizeof(void*));
+	list->count = count;
+	return list;
+}
+
+static struct ExpressionList* unpackExpressionList(struct unpacker* up, uint32_t list){
+	if(list == 0) return NULL;
+
+	struct ExpressionList* eList = newTreeList(up, listLength(up, list));
+	for(uint32_t i = 0; i < eList->count; i++){
+		eList->items[i] = unpackExpression(up, field(up, list, i + 1));
+	}
+
+	return eList;
+}
+
+static struct IdentifierList* unpackIdentifierList(struct unpacker* up, uint32_t list){
+	if(list == 0) return NULL;
+
+	struct IdentifierList* idents = newTreeList(up, listLength(up, list));
+	for(uint32_t i = 0; i < idents->count; i++){
+		idents->items[i] = unpackIdentifier(up, field(up, list, i + 1));
+	}
+
+	return idents;
+}
+
+//a pool expression waiting to be rebuilt into a pointer of an already rebuilt node
+struct UnpackItem {
+	uint32_t ref;
+	struct Expression** slot;
+};
+
+static void pushUnpackItem(Dba* stack, uint32_t ref, struct Expression** slot){
+	if(ref == 0) return;
+
+	struct UnpackItem item = {ref, slot};
+	WriteBlockArray(stack, (char*)&item);
+}
+
+static struct Expression* unpackExpressionNode(struct unpacker* up, uint32_t ref, Dba* stack){
+	if(up->shared[ref]) return up->shared[ref];
+
+	uint32_t h = header(up, ref);
+	struct Expression* expr = NULL;
+
+	switch(headerTag(h)){
+		case POOL_IDENTIFIER: {
+			struct Identifier* ident = newTreeNode(up, sizeof(struct Identifier));
+			const char* text = &(up->pool->chars[field(up, ref, 1)]);
+			const char* spelling = NULL;
+			ident->symbol = InternSymbol(text, strlen(text), &spelling);
+			ident->value = (char*)spelling;
+			expr = &(ident->self);
+			break;
+		}
+
+		case POOL_BINARY: {
+			struct BinaryExpr* bexp = newTreeNode(up, sizeof(struct BinaryExpr));
+			bexp->op = unpackString(up, field(up, ref, 2));
+			pushUnpackItem(stack, field(up, ref, 3), &(bexp->right));
+			pushUnpackItem(stack, field(up, ref, 1), &(bexp->left));
+			expr = &(bexp->self);
+			break;
+		}
+
+		case POOL_UNARY: {
+			struct UnaryExpr* uexp = newTreeNode(up, sizeof(struct UnaryExpr));
+			uexp->op = unpackString(up, field(up, ref, 1));
+			pushUnpackItem(stack, field(up, ref, 2), &(uexp->right));
+			expr = &(uexp->self);
+			break;
+		}
+
+		case POOL_ATTRIBUTE: {
+			struct AttributeExpr* aexp = newTreeNode(up, sizeof(struct AttributeExpr));
+			aexp->tick = '\'';
+			pushUnpackItem(stack, field(up, ref, 2), &(aexp->attribute));
+			pushUnpackItem(stack, field(up, ref, 1), &(aexp->object));
+			expr = &(aexp->self);
+			break;
+		}
+
+		case POOL_CALL: {
+			struct CallExpr* cexp = newTreeNode(up, sizeof(struct CallExpr));
+
+			//the argument list is allocated now, its entries filled in later
+			uint32_t list = field(up, ref, 2);
+			if(list){
+				cexp->arguments = newTreeList(up, listLength(up, list));
+				for(uint32_t i = cexp->arguments->count; i > 0; i--){
+					pushUnpackItem(stack, field(up, list, i), &(cexp->arguments->items[i - 1]));
+				}
+			}
+
+			pushUnpackItem(stack, field(up, ref, 1), &(cexp->function));
+			expr = &(cexp->self);
+			break;
+		}
+
+		case POOL_LITERAL: {
+			struct NumExpr* lexp = newTreeNode(up, sizeof(struct NumExpr));
+			lexp->literal = unpackString(up, field(up, ref, 1));
+			expr = &(lexp->self);
+			break;
+		}
+
+		default:
+			printf("Error: Unable to unpack expression tag %d\r\n", headerTag(h));
+			return NULL;
+	}
+
+	expr->root.type = headerType(h);
+	expr->type = headerFlags(h);
+
+	up->shared[ref] = expr;
+	return expr;
+}
+
+static struct Expression* unpackExpression(struct unpacker* up, uint32_t ref){
+	struct Expression* root = NULL;
+
+	Dba* stack = up->stack;
+	pushUnpackItem(stack, ref, &root);
+
+	struct UnpackItem item;
+	while(PopBlockArray(stack, (char*)&item)){
+		struct Expression* expr = unpackExpressionNode(up, item.ref, stack);
+
+		*(item.slot) = expr;
+	}
+
+	return root;
+}
+
+static struct Label* unpackLabel(struct unpacker* up, uint32_t ref){
+	if(ref == 0) return NULL;
+
+	struct Label* label = newTreeNode(up, sizeof(struct Label));
+	label->self.type = headerType(header(up, ref));
+	label->value = unpackString(up, field(up, ref, 1));
+	return label;
+}
+
+static struct Range* unpackRange(struct unpacker* up, uint32_t ref){
+	if(ref == 0) return NULL;
+
+	struct Range* range = newTreeNode(up, sizeof(struct Range));
+	range->self.type = headerType(header(up, ref));
+	range->descending = headerFlags(header(up, ref));
+	range->left = unpackExpression(up, field(up, ref, 1));
+	range->right = unpackExpression(up, field(up, ref, 2));
+	return range;
+}
+
+static struct DataType* unpackDataType(struct unpacker* up, uint32_t ref){
+	if(ref == 0) return NULL;
+
+	struct DataType* dtype = newTreeNode(up, sizeof(struct DataType));
+	dtype->self.type = headerType(header(up, ref));
+	dtype->value = unpackString(up, field(up, ref, 1));
+	dtype->range = unpackRange(up, field(up, ref, 2));
+	return dtype;
+}
+
+static struct PortMode* unpackPortMode(struct unpacker* up, uint32_t ref){
+	if(ref == 0) return NULL;
+
+	struct PortMode* pmode = newTreeNode(up, sizeof(struct PortMode));
+	pmode->self.type = headerType(header(up, ref));
+	pmode->value = unpackString(up, field(up, ref, 1));
+	return pmode;
+}
+
+static Dba* unpackPorts(struct unpacker* up, uint32_t list){
+	if(list == 0) return NULL;
+
+	Dba* ports = newTreeArray(up, sizeof(struct PortDecl), list);
+	for(uint32_t i = 1; i <= listLength(up, list); i++){
+		uint32_t ref = field(up, list, i);
+		struct PortDecl port = {0};
+
+		port.self.type = headerType(header(up, ref));
+		port.position = field(up, ref, 1);
+		port.names = unpackIdentifierList(up, field(up, ref, 2));
+		port.pmode = unpackPortMode(up, field(up, ref, 3));
+		port.dtype = unpackDataType(up, field(up, ref, 4));
+
+		WriteBlockArray(ports, (char*)(&port));
+	}
+
+	return ports;
+}
+
+static Dba* unpackGenerics(struct unpacker* up, uint32_t list){
+	if(list == 0) return NULL;
+
+	Dba* generics = newTreeArray(up, sizeof(struct GenericDecl), list);
+	for(uint32_t i = 1; i <= listLength(up, list); i++){
+		uint32_t ref = field(up, list, i);
+		struct GenericDecl generic = {0};
+
+		generic.self.type = headerType(header(up, ref));
+		generic.position = field(up, ref, 1);
+		generic.names = unpackIdentifierList(up, field(up, ref, 2));
+		generic.dtype = unpackDataType(up, field(up, ref, 3));
+		generic.defaultValue = unpackExpression(up, field(up, ref, 4));
+
+		WriteBlockArray(generics, (char*)(&generic));
+	}
+
+	return generics;
+}
+
+static void unpackReport(struct unpacker* up, uint32_t ref, struct ReportStatement* report){
+	if(ref == 0) return;
+
+	report->self.type = headerType(header(up, ref));
+	report->severity.level = headerFlags(header(up, ref));
+	report->label = unpackLabel(up, field(up, ref, 1));
+	report->stringExpr = unpackExpression(up, field(up, ref, 2));
+}
+
+static void unpackIf(struct unpacker* up, uint32_t ref, struct IfStatement* ifStmt){
+	for(struct IfStatement* branch = ifStmt; ; ){
+		branch->self.type = headerType(header(up, ref));
+		branch->inElsIf = headerFlags(header(up, ref));
+		branch->label = unpackLabel(up, field(up, ref, 1));
+		branch->antecedent = unpackExpression(up, field(up, ref, 2));
+		branch->consequentStatements = unpackSequentialStatements(up, field(up, ref, 3));
+		branch->alternativeStatements = unpackSequentialStatements(up, field(up, ref, 5));
+
+		ref = field(up, ref, 4);
+		if(ref == 0) break;
+
+		branch->elsif = newTreeNode(up, sizeof(struct IfStatement));
+		branch = branch->elsif;
+	}
+}
+
+static struct Choice* unpackChoices(struct unpacker* up, uint32_t ref){
+	struct Choice* first = NULL;
+	struct Choice** next = &first;
+
+	for(; ref != 0; ref = field(up, ref, 2)){
+		struct Choice* choice = newTreeNode(up, sizeof(struct Choice));
+		choice->type = headerFlags(header(up, ref));
+		if(choice->type == CHOICE_RANGE){
+			choice->as.range = unpackRange(up, field(up, ref, 1));
+		} else {
+			choice->as.numExpr = unpackExpression(up, field(up, ref, 1));
+		}
+
+		*next = choice;
+		next = &(choice->nextChoice);
+	}
+
+	return first;
+}
+
+static Dba* unpackCases(struct unpacker* up, uint32_t list){
+	if(list == 0) return NULL;
+
+	Dba* cases = newTreeArray(up, sizeof(struct CaseStatement), list);
+	for(uint32_t i = 1; i <= listLength(up, list); i++){
+		uint32_t ref = field(up, list, i);
+		struct CaseStatement aCase = {0};
+
+		aCase.self.type = headerType(header(up, ref));
+		aCase.defaultCase = headerFlags(header(up, ref));
+		aCase.choices = unpackChoices(up, field(up, ref, 1));
+		aCase.statements = unpackSequentialStatements(up, field(up, ref, 2));
+
+		WriteBlockArray(cases, (char*)(&aCase));
+	}
+
+	return cases;
+}
+
+static void unpackSequentialStatement(struct unpacker* up, uint32_t ref, struct SequentialStatement* qstmt){
+	uint32_t h = header(up, ref);
+
+	switch(headerTag(h)){
+		case POOL_FOR: {
+			struct ForStatement* stmt = &(qstmt->as.forStatement);
+			qstmt->type = FOR_STATEMENT;
+			stmt->self.type = headerType(h);
+			stmt->label = unpackLabel(up, field(up, ref, 1));
+			stmt->parameter = unpackIdentifier(up, field(up, ref, 2));
+			stmt->range = unpackRange(up, field(up, ref, 3));
+			stmt->statements = unpackSequentialStatements(up, field(up, ref, 4));
+			break;
+		}
+
+		case POOL_IF: {
+			qstmt->type = IF_STATEMENT;
+			unpackIf(up, ref, &(qstmt->as.ifStatement));
+			break;
+		}
+
+		case POOL_LOOP: {
+			struct LoopStatement* stmt = &(qstmt->as.loopStatement);
+			qstmt->type = LOOP_STATEMENT;
+			stmt->self.type = headerType(h);
+			stmt->label = unpackLabel(up, field(up, ref, 1));
+			stmt->statements = unpackSequentialStatements(up, field(up, ref, 2));
+			break;
+		}
+
+		case POOL_NEXT:
+		case POOL_EXIT: {
+			struct NextStatement* stmt = &(qstmt->as.nextStatement);
+			qstmt->type = headerTag(h) == POOL_NEXT ? NEXT_STATEMENT : EXIT_STATEMENT;
+			stmt->self.type = headerType(h);
+			stmt->label = unpackLabel(up, field(up, ref, 1));
+			stmt->loopLabel = unpackLabel(up, field(up, ref, 2));
+			stmt->condition = unpackExpression(up, field(up, ref, 3));
+			break;
+		}
+
+		case POOL_RETURN: {
+			struct ReturnStatement* stmt = &(qstmt->as.returnStatement);
+			qstmt->type = RETURN_STATEMENT;
+			stmt->self.type = headerType(h);
+			stmt->label = unpackLabel(up, field(up, ref, 1));
+			stmt->expression = unpackExpression(up, field(up, ref, 2));
+			break;
+		}
+
+		case POOL_NULL: {
+			struct NullStatement* stmt = &(qstmt->as.nullStatement);
+			qstmt->type = NULL_STATEMENT;
+			stmt->self.type = headerType(h);
+			stmt->label = unpackLabel(up, field(up, ref, 1));
+			break;
+		}
+
+		case POOL_QSIGNAL_ASSIGN: {
+			struct SignalAssign* stmt = &(qstmt->as.signalAssignment);
+			qstmt->type = QSIGNAL_ASSIGNMENT;
+			stmt->self.type = headerType(h);
+			stmt->target = unpackIdentifier(up, field(up, ref, 1));
+			stmt->expression = unpackExpression(up, field(up, ref, 2));
+			break;
+		}
+
+		case POOL_SWITCH: {
+			struct SwitchStatement* stmt = &(qstmt->as.switchStatement);
+			qstmt->type = SWITCH_STATEMENT;
+			stmt->self.type = headerType(h);
+			stmt->label = unpackLabel(up, field(up, ref, 1));
+			stmt->expression = unpackExpression(up, field(up, ref, 2));
+			stmt->cases = unpackCases(up, field(up, ref, 3));
+			break;
+		}
+
+		case POOL_VARIABLE_ASSIGN: {
+			struct VariableAssign* stmt = &(qstmt->as.variableAssignment);
+			qstmt->type = VARIABLE_ASSIGNMENT;
+			stmt->self.type = headerType(h);
+			stmt->label = unpackLabel(up, field(up, ref, 1));
+			stmt->target = unpackIdentifier(up, field(up, ref, 2));
+			stmt->op = unpackString(up, field(up, ref, 3));
+			stmt->expression = unpackExpression(up, field(up, ref, 4));
+			break;
+		}
+
+		case POOL_WAIT: {
+			struct WaitStatement* stmt = &(qstmt->as.waitStatement);
+			qstmt->type = WAIT_STATEMENT;
+			stmt->self.type = headerType(h);
+			stmt->label = unpackLabel(up, field(up, ref, 1));
+			stmt->sensitivityList = unpackIdentifierList(up, field(up, ref, 2));
+			stmt->condition = unpackExpression(up, field(up, ref, 3));
+			stmt->time = unpackExpression(up, field(up, ref, 4));
+			break;
+		}
+
+		case POOL_WHILE: {
+			struct WhileStatement* stmt = &(qstmt->as.whileStatement);
+			qstmt->type = WHILE_STATEMENT;
+			stmt->self.type = headerType(h);
+			stmt->label = unpackLabel(up, field(up, ref, 1));
+			stmt->condition = unpackExpression(up, field(up, ref, 2));
+			stmt->statements = unpackSequentialStatements(up, field(up, ref, 3));
+			break;
+		}
+
+		case POOL_ASSERT: {
+			struct AssertStatement* stmt = &(qstmt->as.assertStatement);
+			qstmt->type = ASSERT_STATEMENT;
+			stmt->self.type = headerType(h);
+			stmt->label = unpackLabel(up, field(up, ref, 1));
+			stmt->condition = unpackExpression(up, field(up, ref, 2));
+			unpackReport(up, field(up, ref, 3), &(stmt->report));
+			break;
+		}
+
+		case POOL_REPORT: {
+			qstmt->type = REPORT_STATEMENT;
+			unpackReport(up, ref, &(qstmt->as.reportStatement));
+			break;
+		}
+
+		default:
+			printf("Error: Unable to unpack statement tag %d\r\n", headerTag(h));
+			break;
+	}
+}
+
+static StmtVec* unpackSequentialStatements(struct unpacker* up, uint32_t list){
+	if(list == 0) return NULL;
+
+	StmtVec* stmts = StmtVecOf(newTreeArray(up, sizeof(struct SequentialStatement), list));
+	for(uint32_t i = 1; i <= listLength(up, list); i++){
+		unpackSequentialStatement(up, field(up, list, i), StmtVecEmplace(stmts));
+	}
+
+	return stmts;
+}
+
+static Dba* unpackDeclarations(struct unpacker* up, uint32_t list){
+	if(list == 0) return NULL;
+
+	Dba* decls = newTreeArray(up, sizeof(struct Declaration), list);
+	for(uint32_t i = 1; i <= listLength(up, list); i++){
+		uint32_t ref = field(up, list, i);
+		uint32_t h = header(up, ref);
+		struct Declaration decl = {0};
+
+		switch(headerTag(h)){
+			case POOL_TYPE_DECL: {
+				struct TypeDecl* tdecl = &(decl.as.typeDeclaration);
+				decl.type = TYPE_DECLARATION;
+				tdecl->self.type = headerType(h);
+				tdecl->typeName = unpackIdentifier(up, field(up, ref, 1));
+				tdecl->enumList = unpackExpressionList(up, field(up, ref, 2));
+				break;
+			}
+
+			case POOL_SIGNAL_DECL:
+			case POOL_VARIABLE_DECL: {
+				struct SignalDecl* sdecl = &(decl.as.signalDeclaration);
+				decl.type = headerTag(h) == POOL_SIGNAL_DECL ? SIGNAL_DECLARATION : VARIABLE_DECLARATION;
+				sdecl->self.type = headerType(h);
+				sdecl->name = unpackIdentifier(up, field(up, ref, 1));
+				sdecl->dtype = unpackDataType(up, field(up, ref, 2));
+				sdecl->expression = unpackExpression(up, field(up, ref, 3));
+				break;
+			}
+
+			case POOL_COMPONENT_DECL: {
+				struct ComponentDecl* cdecl = &(decl.as.componentDeclaration);
+				decl.type = COMPONENT_DECLARATION;
+				cdecl->self.type = headerType(h);
+				cdecl->name = unpackIdentifier(up, field(up, ref, 1));
+				cdecl->generics = unpackGenerics(up, field(up, ref, 2));
+				cdecl->ports = unpackPorts(up, field(up, ref, 3));
+				break;
+			}
+
+			default:
+				printf("Error: Unable to unpack declaration tag %d\r\n", headerTag(h));
+				break;
+		}
+
+		WriteBlockArray(decls, (char*)(&decl));
+	}
+
+	return decls;
+}
+
+static Dba* unpackConcurrentStatements(struct unpacker* up, uint32_t list){
+	if(list == 0) return NULL;
+
+	Dba* stmts = newTreeArray(up, sizeof(struct ConcurrentStatement), list);
+	for(uint32_t i = 1; i <= listLength(up, list); i++){
+		uint32_t ref = field(up, list, i);
+		uint32_t h = header(up, ref);
+		struct ConcurrentStatement cstmt = {0};
+
+		cstmt.label = unpackLabel(up, field(up, ref, 1));
+
+		switch(headerTag(h)){
+			case POOL_PROCESS: {
+				struct Process* proc = &(cstmt.as.process);
+				cstmt.type = PROCESS;
+				proc->self.type = headerType(h);
+				proc->sensitivityList = unpackIdentifierList(up, field(up, ref, 2));
+				proc->declarations = unpackDeclarations(up, field(up, ref, 3));
+				proc->statements = unpackSequentialStatements(up, field(up, ref, 4));
+				break;
+			}
+
+			case POOL_INSTANCE: {
+				struct Instantiation* inst = &(cstmt.as.instantiation);
+				cstmt.type = INSTANTIATION;
+				inst->self.type = headerType(h);
+				inst->name = unpackIdentifier(up, field(up, ref, 2));
+				inst->genericMap = unpackExpressionList(up, field(up, ref, 3));
+				inst->portMap = unpackExpressionList(up, field(up, ref, 4));
+				break;
+			}
+
+			case POOL_SIGNAL_ASSIGN: {
+				struct SignalAssign* sassign = &(cstmt.as.signalAssignment);
+				cstmt.type = SIGNAL_ASSIGNMENT;
+				sassign->self.type = headerType(h);
+				sassign->target = unpackIdentifier(up, field(up, ref, 2));
+				sassign->expression = unpackExpression(up, field(up, ref, 3));
+				break;
+			}
+
+			default:
+				printf("Error: Unable to unpack statement tag %d\r\n", headerTag(h));
+				break;
+		}
+
+		WriteBlockArray(stmts, (char*)(&cstmt));
+	}
+
+	return stmts;
+}
+
+static void unpackDesignUnit(struct unpacker* up, uint32_t ref, struct DesignUnit* unit){
+	uint32_t h = header(up, ref);
+
+	switch(headerTag(h)){
+		case POOL_USE: {
+			struct UseStatement* use = &(unit->as.useStatement);
+			unit->type = USE_STATEMENT;
+			use->self.type = headerType(h);
+			use->value = unpackString(up, field(up, ref, 1));
+			use->library = unpackString(up, field(up, ref, 2));
+			break;
+		}
+
+		case POOL_ENTITY: {
+			struct EntityDecl* ent = &(unit->as.libraryUnit.as.entity);
+			unit->type = LIBRARY_UNIT;
+			unit->as.libraryUnit.type = ENTITY;
+			ent->self.type = headerType(h);
+			ent->name = unpackIdentifier(up, field(up, ref, 1));
+			ent->generics = unpackGenerics(up, field(up, ref, 2));
+			ent->ports = unpackPorts(up, field(up, ref, 3));
+			break;
+		}
+
+		case POOL_ARCHITECTURE: {
+			struct ArchitectureDecl* arch = &(unit->as.libraryUnit.as.architecture);
+			unit->type = LIBRARY_UNIT;
+			unit->as.libraryUnit.type = ARCHITECTURE;
+			arch->self.type = headerType(h);
+			arch->archName = unpackIdentifier(up, field(up, ref, 1));
+			arch->entName = unpackIdentifier(up, field(up, ref, 2));
+			arch->declarations = unpackDeclarations(up, field(up, ref, 3));
+			arch->statements = unpackConcurrentStatements(up, field(up, ref, 4));
+			break;
+		}
+
+		default:
+			printf("Error: Unable to unpack design unit tag %d\r\n", headerTag(h));
+			break;
+	}
+}
+
+// public interface
+
+struct AstPool* PackProgram(struct Program* prog){
+	if(prog == NULL) return NULL;
+
+	struct AstPool* pool = calloc(1, sizeof(struct AstPool));
+	if(pool == NULL){
+		printf("Error: Unable to allocate AST pool\r\n");
+		return NULL;
+	}
+
+	pool->shared = InitHashTable();
+	pool->strings = InitHashTable();
+	pool->stack = InitBlockArray(sizeof(struct PackItem));
+
+	//offset 0 of both arrays is reserved so 0 can mean NULL
+	if(growWords(pool, 1)) pool->words[pool->wordCount++] = 0;
+	packString(pool, "", false);
+
+	if(prog->units){
+		pool->units = newPoolList(pool, BlockCount(prog->units), treeBlockArraySize(prog->units, sizeof(struct DesignUnit)));
+		for(int i = 0; i < BlockCount(prog->units); i++){
+			uint32_t ref = packDesignUnit(pool, (struct DesignUnit*)ReadBlockArray(prog->units, i));
+			setField(pool, pool->units, i + 1, ref);
+		}
+	}
+
+	FreeHashTable(pool->shared);
+	FreeHashTable(pool->strings);
+	FreeBlockArray(pool->stack);
+	pool->shared = NULL;
+	pool->strings = NULL;
+	pool->stack = NULL;
+
+	if(pool->failed){
+		FreeAstPool(pool);
+		return NULL;
+	}
+
+	return pool;
+}
+
+struct Program* UnpackProgram(struct AstPool* pool){
+	if(pool == NULL) return NULL;
+
+	struct unpacker up = {pool, InitArena(0), calloc(pool->wordCount, sizeof(void*)), InitBlockArray(sizeof(struct UnpackItem))};
+	if(up.arena == NULL || up.shared == NULL){
+		printf("Error: Unable to allocate program\r\n");
+		FreeArena(up.arena);
+		free(up.shared);
+		FreeBlockArray(up.stack);
+		return NULL;
+	}
+
+	struct Program* prog = newTreeNode(&up, sizeof(struct Program));
+	prog->self.type = AST_PROGRAM;
+	prog->arena = up.arena;
+
+	if(pool->units){
+		prog->units = newTreeArray(&up, sizeof(struct DesignUnit), pool->units);
+		for(uint32_t i = 1; i <= listLength(&up, pool->units); i++){
+			struct DesignUnit unit = {0};
+			unpackDesignUnit(&up, field(&up, pool->units, i), &unit);
+			WriteBlockArray(prog->units, (char*)(&unit));
+		}
+	}
+
+	free(up.shared);
+	FreeBlockArray(up.stack);
+	return prog;
+}
+
+void FreeUnpackedProgram(struct Program* prog){
+	if(prog) FreeArena(prog->arena);
+}
+
+void FreeAstPool(struct AstPool* pool){
+	if(pool == NULL) return;
+
+	if(pool->shared) FreeHashTable(pool->shared);
+	if(pool->strings) FreeHashTable(pool->strings);
+	if(pool->stack) FreeBlockArray(pool->stack);
+	if(pool->map){
+		munmap(pool->map, pool->mapLength);
+	} else {
+		free(pool->words);
+		free(pool->chars);
+	}
+	free(pool);
+}
+
+bool WriteAstPool(struct AstPool* pool, const char* path){
+	if(pool == NULL || path == NULL) return false;
+
+	FILE* file = fopen(path, "wb");
+	if(file == NULL){
+		printf("Error: Unable to open AST file %s\r\n", path);
+		return false;
+	}
+
+	struct AstFileHeader head = {
+		.magic = AST_FILE_MAGIC,
+		.version = AST_FILE_VERSION,
+		.byteOrder = AST_FILE_ORDER,
+		.wordCount = pool->wordCount,
+		.charCount = pool->charCount,
+		.units = pool->units,
+		.nodeCount = pool->nodeCount,
+	};
+
+	bool written = fwrite(&head, sizeof(head), 1, file) == 1
+		&& fwrite(pool->words, sizeof(uint32_t), pool->wordCount, file) == pool->wordCount
+		&& fwrite(pool->chars, 1, pool->charCount, file) == pool->charCount;
+
+	if(fclose(file) != 0) written = false;
+	if(!written){
+		printf("Error: Unable to write AST file %s\r\n", path);
+		remove(path);
+	}
+
+	return written;
+}
+
+// checking a loaded file
+
+//the unpacker follows references without checking them, so a file is only
+//loaded once every reference in it has been checked against the layout
+
+static bool isExpressionTag(uint32_t tag){
+	return tag >= POOL_IDENTIFIER && tag <= POOL_LITERAL;
+}
+
+//the consumers of an expression switch on its type, so it has to match the tag's layout
+static bool validExpressionType(uint32_t h){
+	switch(headerTag(h)){
+		case POOL_IDENTIFIER:	return headerFlags(h) == NAME_EXPR;
+		case POOL_BINARY:		return headerFlags(h) == BINARY_EXPR;
+		case POOL_UNARY:		return headerFlags(h) == UNARY_EXPR;
+		case POOL_ATTRIBUTE:	return headerFlags(h) == ATTRIBUTE_EXPR;
+		case POOL_CALL:			return headerFlags(h) == CALL_EXPR;
+		case POOL_LITERAL:
+			return headerFlags(h) == NUM_EXPR || headerFlags(h) == CHAR_EXPR || headerFlags(h) == STRING_EXPR;
+		default:				return true;
+	}
+}
+
+static uint32_t nodeFields(uint32_t h){
+	return headerTag(h) == POOL_LIST ? listCount(h) : tagInfo[headerTag(h)].fields;
+}
+
+//list entries can be any node, the list's parent checks what they are
+static uint32_t fieldKind(uint32_t h, uint32_t i){
+	if(headerTag(h) == POOL_LIST) return FIELD_NODE;
+
+	uint32_t kind = tagInfo[headerTag(h)].kinds[i - 1];
+	if(kind == FIELD_CHOICE_VALUE) kind = headerFlags(h) == CHOICE_RANGE ? FIELD_RANGE : FIELD_EXPRESSION;
+	return kind;
+}
+
+static bool isRefKind(uint32_t kind){
+	return kind != FIELD_VALUE && kind != FIELD_STRING;
+}
+
+static bool kindHasTag(uint32_t kind, uint32_t tag){
+	switch(kind){
+		case FIELD_NODE:			return true;
+		case FIELD_EXPRESSION:		return isExpressionTag(tag);
+		case FIELD_IDENTIFIER:		return tag == POOL_IDENTIFIER;
+		case FIELD_LABEL:			return tag == POOL_LABEL;
+		case FIELD_RANGE:			return tag == POOL_RANGE;
+		case FIELD_DATA_TYPE:		return tag == POOL_DATA_TYPE;
+		case FIELD_PORT_MODE:		return tag == POOL_PORT_MODE;
+		case FIELD_REPORT:			return tag == POOL_REPORT;
+		case FIELD_IF:				return tag == POOL_IF;
+		case FIELD_CHOICE:			return tag == POOL_CHOICE;
+		case FIELD_STATEMENT:		return tag >= POOL_FOR && tag <= POOL_REPORT;
+		case FIELD_DECLARATION:		return tag >= POOL_TYPE_DECL && tag <= POOL_COMPONENT_DECL;
+		case FIELD_CONCURRENT:		return tag >= POOL_PROCESS && tag <= POOL_SIGNAL_ASSIGN;
+		case FIELD_PORT:			return tag == POOL_PORT;
+		case FIELD_GENERIC:			return tag == POOL_GENERIC;
+		case FIELD_CASE:			return tag == POOL_CASE;
+		case FIELD_UNIT:			return tag >= POOL_USE && tag <= POOL_ARCHITECTURE;
+		default:					return false;
+	}
+}
+
+struct poolCheck {
+	struct AstPool* pool;
+
+	//by word, 0 if no node starts there, else one past the last word the node
+	//reaches through references that point forward
+	uint32_t* ends;
+
+	//by word, set once a node that isn't an expression has its one parent
+	uint8_t* owned;
+};
+
+//checks the reference in field kind of the node at ref, nodes after ref have
+//already been checked so a list's entries are known to be nodes
+static bool checkRef(struct poolCheck* pc, uint32_t ref, uint32_t kind, uint32_t target){
+	struct AstPool* pool = pc->pool;
+
+	if(kind == FIELD_VALUE) return true;
+	if(kind == FIELD_STRING) return target < pool->charCount;
+	if(target == 0) return true;
+	if(target >= pool->wordCount || pc->ends[target] == 0) return false;
+
+	uint32_t tag = headerTag(pool->words[target]);
+
+	//everything is packed in preorder, only an expression packed once for
+	//several parents can be referred to from after it, see checkSharedRefs
+	if(!isExpressionTag(tag)){
+		if(target <= ref || pc->owned[target]) return false;
+		pc->owned[target] = 1;
+	}
+
+	if(kind & FIELD_LIST){
+		uint32_t entry = kind & ~FIELD_LIST;
+		if(tag != POOL_LIST) return false;
+
+		for(uint32_t i = 1; i <= listCount(pool->words[target]); i++){
+			uint32_t item = pool->words[target + i];
+
+			//only expressions can be left out of a list
+			if(item == 0 && entry != FIELD_EXPRESSION && entry != FIELD_IDENTIFIER) return false;
+			if(item != 0 && !kindHasTag(entry, headerTag(pool->words[item]))) return false;
+		}
+	} else if(!kindHasTag(kind, tag)){
+		return false;
+	}
+
+	if(target > ref && pc->ends[target] > pc->ends[ref]) pc->ends[ref] = pc->ends[target];
+	return true;
+}
+
+//a shared expression is referred to from after it, that can only be a cycle
+//if the expression reaches forward to the node referring to it
+static bool checkSharedRefs(struct poolCheck* pc, uint32_t ref){
+	uint32_t h = pc->pool->words[ref];
+
+	for(uint32_t i = 1; i <= nodeFields(h); i++){
+		uint32_t target = pc->pool->words[ref + i];
+		if(!isRefKind(fieldKind(h, i)) || target == 0 || target > ref) continue;
+
+		if(pc->ends[target] > ref) return false;
+	}
+
+	return true;
+}
+
+static bool checkPool(struct poolCheck* pc){
+	struct AstPool* pool = pc->pool;
+
+	//every node fits in the words
+	for(uint32_t ref = 1; ref < pool->wordCount;){
+		uint32_t h = pool->words[ref];
+		uint32_t tag = headerTag(h);
+		if(tag == 0 || tag >= POOL_TAG_COUNT || !validExpressionType(h)) return false;
+
+		uint64_t size = 1 + (uint64_t)nodeFields(h);
+		if(ref + size > pool->wordCount) return false;
+
+		pc->ends[ref] = ref + size;
+		ref += size;
+	}
+
+	//back to front, so the nodes a reference points forward to are checked first
+	for(uint32_t ref = pool->wordCount - 1; ref > 0; ref--){
+		if(pc->ends[ref] == 0) continue;
+
+		uint32_t h = pool->words[ref];
+		for(uint32_t i = 1; i <= nodeFields(h); i++){
+			if(!checkRef(pc, ref, fieldKind(h, i), pool->words[ref + i])) return false;
+		}
+	}
+
+	for(uint32_t ref = 1; ref < pool->wordCount; ref += 1 + nodeFields(pool->words[ref])){
+		if(!checkSharedRefs(pc, ref)) return false;
+	}
+
+	//the units list hangs off the file header
+	return checkRef(pc, 0, LIST_OF(FIELD_UNIT), pool->units);
+}
+
+static bool validPoolLayout(struct AstPool* pool){
+	if(pool->wordCount == 0 || pool->charCount == 0) return false;
+	if(pool->chars[pool->charCount - 1] != '\0') return false;
+
+	struct poolCheck pc = {pool, calloc(pool->wordCount, sizeof(uint32_t)), calloc(pool->wordCount, sizeof(uint8_t))};
+	bool valid = false;
+	if(pc.ends && pc.owned){
+		valid = checkPool(&pc);
+	} else {
+		printf("Error: Unable to allocate AST pool check\r\n");
+	}
+
+	free(pc.ends);
+	free(pc.owned);
+	return valid;
+}
+
+struct AstPool* LoadAstPool(const char* path){
+	if(path == NULL) return NULL;
+
+	int fd = open(path, O_RDONLY);
+	if(fd < 0){
+		printf("Error: Unable to open AST file %s\r\n", path);
+		return NULL;
+	}
+
+	struct stat st;
+	void* map = MAP_FAILED;
+	if(fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(struct AstFileHeader)){
+		map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd);
+
+	if(map == MAP_FAILED){
+		printf("Error: Unable to map AST file %s\r\n", path);
+		return NULL;
+	}
+
+	struct AstFileHeader* head = (struct AstFileHeader*)map;
+	size_t length = (size_t)st.st_size;
+	size_t expected = sizeof(*head) + (size_t)head->wordCount * sizeof(uint32_t) + head->charCount;
+
+	struct AstPool* pool = NULL;
+	if(memcmp(head->magic, AST_FILE_MAGIC, sizeof(head->magic)) == 0
+		&& head->version == AST_FILE_VERSION
+		&& head->byteOrder == AST_FILE_ORDER
+		&& expected == length){
+		pool = calloc(1, sizeof(struct AstPool));
+	}
+
+	if(pool){
+		//no copy, the pool reads straight from the page cache
+		pool->map = map;
+		pool->mapLength = length;
+		pool->words = (uint32_t*)(head + 1);
+		pool->wordCount = pool->wordCapacity = head->wordCount;
+		pool->chars = (char*)(pool->words + head->wordCount);
+		pool->charCount = pool->charCapacity = head->charCount;
+		pool->units = head->units;
+		pool->nodeCount = head->nodeCount;
+
+		if(validPoolLayout(pool)) return pool;
+
+		free(pool);
+	}
+
+	printf("Error: %s is not a valid AST file\r\n", path);
+	munmap(map, length);
+	return NULL;
+}
+
+uint32_t AstPoolNodeCount(struct AstPool* pool){
+	return pool ? pool->nodeCount : 0;
+}
+
+size_t AstPoolBytes(struct AstPool* pool){
+	return pool ? pool->wordCount * sizeof(uint32_t) + pool->charCount : 0;
+}
+
+//the field of the first string a node of tag holds, 0 if it holds none
+static uint32_t textField(uint32_t tag){
+	for(uint32_t i = 0; i < tagInfo[tag].fields; i++){
+		if(tagInfo[tag].kinds[i] == FIELD_STRING) return i + 1;
+	}
+
+	return 0;
+}
+
+void WalkAstPool(struct AstPool* pool, uint64_t visitMask, astPoolOpPtr doOp, void* data){
+	if(pool == NULL || doOp == NULL) return;
+	if(visitMask == 0) visitMask = ~UINT64_C(0);
+
+	uint8_t text[POOL_TAG_COUNT];
+	for(uint32_t tag = 0; tag < POOL_TAG_COUNT; tag++) text[tag] = textField(tag);
+
+	//nodes are stored in preorder, so walking them is reading the words in order
+	for(uint32_t ref = 1; ref < pool->wordCount;){
+		uint32_t h = pool->words[ref];
+		uint32_t tag = headerTag(h);
+
+		if(tag != POOL_LIST && (visitMask & AST_MASK(headerType(h)))){
+			uint32_t offset = text[tag] ? pool->words[ref + text[tag]] : 0;
+			struct AstPoolNode node = {ref, headerType(h), headerFlags(h), offset ? &(pool->chars[offset]) : NULL};
+			doOp(&node, data);
+		}
+
+		ref += 1 + nodeFields(h);
+	}
+}
+
+void PrintAstPoolStats(struct AstPool* pool){
+	if(pool == NULL) return;
+
+	uint32_t poolCount[POOL_TAG_COUNT] = {0};
+	size_t poolBytes[POOL_TAG_COUNT] = {0};
+
+	//the words are nothing but headers and their fields, so one pass over them finds every node
+	for(uint32_t ref = 1; ref < pool->wordCount;){
+		uint32_t h = pool->words[ref];
+		uint32_t tag = headerTag(h);
+		uint32_t size = 1 + (tag == POOL_LIST ? listCount(h) : tagInfo[tag].fields);
+
+		poolCount[tag]++;
+		poolBytes[tag] += size * sizeof(uint32_t);
+		ref += size;
+	}
+
+	size_t treeTotal = pool->treeStringBytes, poolTotal = pool->charCount;
+
+	printf("%-20s %10s %12s %12s\r\n", "node", "count", "tree B/node", "pool B/node");
+	for(int tag = 1; tag < POOL_TAG_COUNT; tag++){
+		if(poolCount[tag] == 0) continue;
+
+		printf("%-20s %10u %12.1f %12.1f\r\n", tagInfo[tag].name, poolCount[tag],
+			(double)pool->treeBytes[tag] / poolCount[tag], (double)poolBytes[tag] / poolCount[tag]);
+
+		treeTotal += pool->treeBytes[tag];
+		poolTotal += poolBytes[tag];
+	}
+
+	printf("%-20s %10s %12zu %12u\r\n", "strings (bytes)", "", pool->treeStringBytes, pool->charCount);
+	printf("%-20s %10u %12zu %12zu\r\n", "total (bytes)", pool->nodeCount, treeTotal, poolTotal);
+}
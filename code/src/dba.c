@@ -4,37 +4,138 @@
 
 #include <dba.h>
 
-struct DynamicBlockArray {
-	int count;
-   int capacity;
-   size_t blockSize;
-   char* block;
-};
+//the first blocks are stored right after the header, as many as fit in
+//DBA_INLINE_BYTES but never more than DBA_INLINE_MAX
+#define DBA_INLINE_BYTES 256
+#define DBA_INLINE_MAX 8
+
+//the capacity of that many segments still fits in an int
+#define DBA_MAX_SEGMENTS (31 - DBA_SEGMENT_SHIFT)
+
+static int localBlocks(size_t bsize){
+	if(bsize == 0) return 0;
+
+	size_t blocks = DBA_INLINE_BYTES / bsize;
+	return blocks > DBA_INLINE_MAX ? DBA_INLINE_MAX : (int)blocks;
+}
+
+size_t BlockArraySize(size_t bsize){
+	return sizeof(struct DynamicBlockArray) + localBlocks(bsize) * bsize;
+}
+
+struct DynamicBlockArray* InitBlockArrayInPlace(void* mem, size_t bsize){
+	if(mem == NULL) return NULL;
+
+	struct DynamicBlockArray* arr = mem;
+	arr->count = 0;
+	arr->localCapacity = localBlocks(bsize);
+	arr->capacity = arr->localCapacity;
+	arr->blockSize = bsize;
+	arr->block = (char*)arr->local;
+	arr->segments = NULL;
+	arr->segmentCount = 0;
+	arr->inPlace = true;
+
+	return arr;
+}
 
 struct DynamicBlockArray* InitBlockArray(size_t bsize){	
-	struct DynamicBlockArray* arr = calloc(1, sizeof(struct DynamicBlockArray));	
+	struct DynamicBlockArray* arr = calloc(1, BlockArraySize(bsize));	
 	if(arr == NULL){
 		printf("Error: Unable to allocate Block Array\r\n");
 		exit(-1);
 	}
 
-	arr->count = 0;
-	arr->capacity = 0;
+	InitBlockArrayInPlace(arr, bsize);
+	arr->inPlace = false;
+	
+	return arr;
+} 
+
+struct DynamicBlockArray* InitSegmentedBlockArray(size_t bsize){	
+	struct DynamicBlockArray* arr = calloc(1, sizeof(struct DynamicBlockArray));	
+	char** segments = calloc(DBA_MAX_SEGMENTS, sizeof(char*));
+	if(arr == NULL || segments == NULL){
+		printf("Error: Unable to allocate Block Array\r\n");
+		exit(-1);
+	}
+
+	//no local blocks, they would move when the array is copied
+	InitBlockArrayInPlace(arr, 0);
 	arr->blockSize = bsize;
-	arr->block = NULL;
+	arr->segments = segments;
+	arr->inPlace = false;
 	
 	return arr;
 } 
 
 void FreeBlockArray(struct DynamicBlockArray* arr){
+	if(arr->segments){
+		for(int i = 0; i < arr->segmentCount; i++) free(arr->segments[i]);
+		free(arr->segments);
+		arr->segments = NULL;
+		arr->segmentCount = 0;
+	}
+
+	if(arr->block != (char*)arr->local) free(arr->block);
+	arr->block = (char*)arr->local;
+
 	arr->count = 0;
-	arr->capacity = 0;
-	arr->blockSize = 0;
+	arr->capacity = arr->localCapacity;
 
-	free(arr->block);
-	arr->block = NULL;
-	
-	free(arr);
+	if(!arr->inPlace){
+		arr->blockSize = 0;
+		free(arr);
+	}
+}
+
+//moves the blocks to a heap buffer of the given capacity, the first spill
+//copies them out of the local blocks, after that realloc moves them
+static void resizeBlocks(struct DynamicBlockArray* arr, int capacity){
+	char* spilled = arr->block == (char*)arr->local ? NULL : arr->block;
+	char* resized = realloc(spilled, (arr->blockSize * capacity));
+	if(resized == NULL){
+		printf("Error: Unable to grow Block Array\r\n");
+		exit(-1);
+	}
+	if(spilled == NULL) memcpy(resized, arr->local, arr->count * arr->blockSize);
+
+	arr->block = resized;
+	arr->capacity = capacity;
+}
+
+//a segmented array grows by adding a segment twice the size of the last,
+//the blocks already stored never move
+static void addSegments(struct DynamicBlockArray* arr, int count){
+	while(arr->capacity < count){
+		if(arr->segmentCount == DBA_MAX_SEGMENTS){
+			printf("Error: Block Array is full\r\n");
+			exit(-1);
+		}
+
+		size_t blocks = (size_t)1 << (DBA_SEGMENT_SHIFT + arr->segmentCount);
+		char* segment = malloc(blocks * arr->blockSize);
+		if(segment == NULL){
+			printf("Error: Unable to grow Block Array\r\n");
+			exit(-1);
+		}
+
+		arr->segments[arr->segmentCount++] = segment;
+		arr->capacity += (int)blocks;
+	}
+}
+
+static void growBlocks(struct DynamicBlockArray* arr, int count){
+	if(arr->capacity >= count) return;
+
+	if(arr->segments){
+		addSegments(arr, count);
+		return;
+	}
+
+	int capacity = arr->capacity < 2 ? 2 : (arr->capacity * 2);
+	while(capacity < count) capacity *= 2;
+	resizeBlocks(arr, capacity);
 }
 
 void WriteBlockArray(struct DynamicBlockArray* arr, char* block){
@@ -43,15 +144,101 @@ void WriteBlockArray(struct DynamicBlockArray* arr, char* block){
 		return;
 	} 
 
-	if(arr->capacity < arr->count + 1){
-		int oldCapacity = arr->capacity;
-		arr->capacity = oldCapacity < 2 ? 2 : (oldCapacity * 2);
-		arr->block = realloc(arr->block, (arr->blockSize * arr->capacity)); 
-	}
+	growBlocks(arr, arr->count + 1);
+
+	memcpy(BlockAt(arr, arr->count), block, arr->blockSize);
+	arr->count++;
+}
+
+void* EmplaceBlockArray(struct DynamicBlockArray* arr){
+	if(arr == NULL) {
+		printf("Error: Block Array Ptr NULL\r\n");
+		return NULL;
+	} 
 
-	char* blockPtr = &arr->block[arr->count * arr->blockSize];
-	memcpy(blockPtr, block, arr->blockSize);
+	growBlocks(arr, arr->count + 1);
+
+	char* blockPtr = BlockAt(arr, arr->count);
+	memset(blockPtr, 0, arr->blockSize);
 	arr->count++;
+
+	return blockPtr;
+}
+
+void AppendBlockArray(struct DynamicBlockArray* arr, const char* blocks, int count){
+	if(arr == NULL) {
+		printf("Error: Block Array Ptr NULL\r\n");
+		return;
+	} 
+
+	if(count <= 0) return;
+	growBlocks(arr, arr->count + count);
+
+	if(arr->segments){
+		for(int i = 0; i < count; i++){
+			memcpy(BlockAt(arr, arr->count + i), &blocks[i * arr->blockSize], arr->blockSize);
+		}
+	} else {
+		memcpy(BlockAt(arr, arr->count), blocks, count * arr->blockSize);
+	}
+	arr->count += count;
+}
+
+void ReserveBlockArray(struct DynamicBlockArray* arr, int count){
+	if(arr == NULL) {
+		printf("Error: Block Array Ptr NULL\r\n");
+		return;
+	} 
+
+	if(arr->capacity >= count) return;
+
+	if(arr->segments) addSegments(arr, count);
+	else resizeBlocks(arr, count);
+}
+
+void ShrinkBlockArray(struct DynamicBlockArray* arr){
+	if(arr == NULL) {
+		printf("Error: Block Array Ptr NULL\r\n");
+		return;
+	} 
+
+	//only whole segments past the last block can go, the others must not move
+	if(arr->segments){
+		while(arr->segmentCount > 0){
+			int blocks = 1 << (DBA_SEGMENT_SHIFT + arr->segmentCount - 1);
+			if(arr->capacity - blocks < arr->count) break;
+
+			free(arr->segments[--arr->segmentCount]);
+			arr->capacity -= blocks;
+		}
+		return;
+	}
+
+	if(arr->block == (char*)arr->local || arr->count == arr->capacity) return;
+
+	if(arr->count <= arr->localCapacity){
+		memcpy(arr->local, arr->block, arr->count * arr->blockSize);
+		free(arr->block);
+		arr->block = (char*)arr->local;
+		arr->capacity = arr->localCapacity;
+	} else {
+		resizeBlocks(arr, arr->count);
+	}
+}
+
+bool PopBlockArray(struct DynamicBlockArray* arr, char* block){
+	if(arr == NULL) {
+		printf("Error: Block Array Ptr NULL\r\n");
+		return false;
+	} 
+
+	if(arr->count == 0) return false;
+
+	arr->count--;
+	if(block){
+		memcpy(block, BlockAt(arr, arr->count), arr->blockSize);
+	}
+	return true;
 }
 
 void* ReadBlockArray(struct DynamicBlockArray* arr, int index){
@@ -65,7 +252,7 @@ void* ReadBlockArray(struct DynamicBlockArray* arr, int index){
 		return NULL;
 	}
 	
-	return (void*)(arr->block + (index * arr->blockSize)); 
+	return BlockAt(arr, index); 
 }
 
 int BlockCount(struct DynamicBlockArray* arr){
@@ -76,3 +263,8 @@ int BlockCount(struct DynamicBlockArray* arr){
 
 	return arr->count;
 }
+
+void* WrongBlockArray(const char* name){
+	printf("Error: Block Array is not a %s\r\n", name);
+	return NULL;
+}
@@ -88,9 +88,13 @@ struct DynamicHashTable* InitHashTable(){
 	hst->count = 0;
 	hst->capacity = 0;
 	hst->entries = NULL;
+
+	return hst;
 }
 
 void FreeHashTable(struct DynamicHashTable* hst){
+	if(hst == NULL) return;
+
 	for(int i=0; i<hst->capacity; i++){
 		if(hst->entries[i].key != NULL) free(hst->entries[i].key);		
 	}
@@ -11,8 +11,16 @@ static void printSubExpression(struct Expression* expr);
 void PrintUsage(void){
 	printf("Usage:\n"
 			" tvt adder.vent (perform transpilation)\n"
+			" tvt - (transpile from stdin, output goes to a.vhdl)\n"
 			" tvt adder.vent --print-tokens\n"
 			" tvt adder.vent --print-ast\n"
+			" tvt adder.vent --pre-lex (lex the whole file before parsing)\n"
+			" tvt adder.vent --stream (read the file in chunks while parsing)\n"
+			" tvt adder.vent --jobs 4 (parse the design units on 4 threads)\n"
+			" tvt adder.vent --share-expressions (one node per distinct expression)\n"
+			" tvt adder.vent --ast-stats (compare the AST's memory with a packed pool)\n"
+			" tvt adder.vent --emit-ast-bin (also save the parsed AST to adder.vast)\n"
+			" tvt adder.vast (transpile a saved AST without parsing)\n"
 		);
 }
 
@@ -207,17 +215,7 @@ static void printAssignmentOp(struct AstNode* vAssign){
 	printf("\e[0;35m""%cOperator:   \'%s\'\r\n", shift(), (char*)op);
 }
 
-static void printExpressionList(struct ExpressionNode* expr){
-    while(expr){
-		printSubExpression(expr->expression);
-        expr = expr->next;
-        if(expr != NULL) printf(", ");
-    }   
-}
-
-static void printSubExpression(struct Expression* expr){
-	enum ExpressionType type = expr->type;
-
+static inline void printEnterExpression(enum ExpressionType type, struct Expression* expr){
 	switch(type) {
 	
 		case CHAR_EXPR: {
@@ -241,46 +239,57 @@ static void printSubExpression(struct Expression* expr){
 		case UNARY_EXPR:{
 			struct UnaryExpr* uexp = (struct UnaryExpr*) expr;
 			printf("%s ", uexp->op);
-			printSubExpression(uexp->right);
 			break;
 		}
 
-		case BINARY_EXPR:{
-			struct BinaryExpr* bexp = (struct BinaryExpr*) expr;
-			printSubExpression(bexp->left);
-			printf(" %s ", bexp->op);
-			printSubExpression(bexp->right);
+		case NAME_EXPR: {
+			struct Identifier* ident = (struct Identifier*)expr;
+			printf("%s", ident->value);
 			break;
 		}
 
-		case ATTRIBUTE_EXPR:{
-			struct AttributeExpr* aexp = (struct AttributeExpr*) expr;
-			printSubExpression(aexp->object);
-			printf("%c", aexp->tick);
-			printSubExpression(aexp->attribute);
+		default:
+			break;
+	}
+}
+
+static inline bool printBetweenOperands(enum ExpressionType type, struct Expression* expr, int operand){
+	switch(type) {
+
+		case BINARY_EXPR:{
+			printf(" %s ", ((struct BinaryExpr*) expr)->op);
 			break;
 		}
 
-		case CALL_EXPR:{
-			struct CallExpr* cexp = (struct CallExpr*) expr;
-			printSubExpression(cexp->function);
-			printf("(");
-			printExpressionList(cexp->arguments);
-			printf(")");
+		case ATTRIBUTE_EXPR:{
+			printf("%c", ((struct AttributeExpr*) expr)->tick);
 			break;
 		}
 
-		case NAME_EXPR: {
-			//NameExpr* nexp = (NameExpr*) expr;
-			//printf("\e[0;35m""\'%s\'\r\n", nexp->name->value);
-			struct Identifier* ident = (struct Identifier*)expr;
-			printf("%s", ident->value);
+		case CALL_EXPR:{
+			printf(operand == 1 ? "(" : ", ");
 			break;
 		}
 
 		default:
 			break;
 	}
+
+	return true;
+}
+
+static inline void printExitExpression(enum ExpressionType type, struct Expression* expr){
+	if(type == CALL_EXPR){
+		if(((struct CallExpr*)expr)->arguments == NULL) printf("(");
+		printf(")");
+	}
+}
+
+//defined by walker.h below, with the hooks above inlined
+static void walkExpression(struct Expression* expr);
+
+static void printSubExpression(struct Expression* expr){
+	walkExpression(expr);
 }
 
 static void printRange(struct AstNode* rng){
@@ -327,9 +336,9 @@ static void printExpression(struct Expression* expr){
 	printf("\'\r\n");
 }
 
-static void printSpecial(struct AstNode* node){
+static inline void printSpecial(enum AstNodeType type, struct AstNode* node){
 
-	switch(node->type){
+	switch(type){
 
 		case AST_VASSIGN:
 			printAssignmentOp(node);
@@ -352,9 +361,9 @@ static void printSpecial(struct AstNode* node){
 	}
 }
 
-static void printOpen(struct AstNode* node){
+static inline void printOpen(enum AstNodeType type, struct AstNode* node){
 
-	switch(node->type){
+	switch(type){
 
 		case AST_INSTANCE:
 			printInstantiation(node);
@@ -365,13 +374,13 @@ static void printOpen(struct AstNode* node){
 	}
 }
 
-static void printClose(struct AstNode* none){
+static inline void printClose(enum AstNodeType type, struct AstNode* none){
 	indent--;
 }
 
-static void printDefault(struct AstNode* node){
+static inline void printDefault(enum AstNodeType type, struct AstNode* node){
 
-	switch(node->type){
+	switch(type){
 		
 		case AST_PROGRAM:
 			printProgram(node);
@@ -495,18 +504,19 @@ static void printDefault(struct AstNode* node){
 	}
 }
 
+#define WALK_DEFAULT_OP(type, node) printDefault((type), (node))
+#define WALK_OPEN_OP(type, node) printOpen((type), (node))
+#define WALK_CLOSE_OP(type, node) printClose((type), (node))
+#define WALK_SPECIAL_OP(type, node) printSpecial((type), (node))
+#define WALK_EXPRESSION_OP(expr) printExpression(expr)
+#define WALK_ENTER_EXPRESSION_OP(type, expr) printEnterExpression((type), (expr))
+#define WALK_BETWEEN_OPERANDS_OP(type, expr, operand) printBetweenOperands((type), (expr), (operand))
+#define WALK_EXIT_EXPRESSION_OP(type, expr) printExitExpression((type), (expr))
+#include <walker.h>
+
 void PrintProgram(struct Program* prog){
 	
-	// setup block
-	struct OperationBlock opBlk = {
-		.doDefaultOp 		= printDefault,
-		.doOpenOp 			= printOpen,
-		.doCloseOp 			= printClose,
-		.doSpecialOp 		= printSpecial,
-		.doExpressionOp 	= printExpression,
-	};
-	
-	WalkTree(prog, &opBlk);
+	walkTree(prog);
 
 	// clean up
 	printf("\e[0m");
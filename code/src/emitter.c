@@ -115,17 +115,16 @@ static void emitGenericDeclarationSpecial(struct AstNode* gDecl){
 	indent--;
 }
 
+static void emitNameList(struct IdentifierList* names){
+	for(uint32_t i = 0; names && i < names->count; i++){
+		fprintf(vhdlFile, i == 0 ? "%s" : ", %s", names->items[i]->value);
+	}
+}
+
 static void emitGenericDeclaration(struct AstNode* gdecl){
 	struct GenericDecl* genericDecl = (struct GenericDecl*) gdecl;
-	fprintf(vhdlFile, "%c%s", emitIndent(), genericDecl->name->value);
-	
-	struct Identifier *curr, *prev;
-    curr = genericDecl->name->next;
-    while(curr){
-        prev = curr;
-        curr = curr->next;
-		fprintf(vhdlFile, ", %s", prev->value);
-    }   
+	fprintf(vhdlFile, "%c", emitIndent());
+	emitNameList(genericDecl->names);
 	fprintf(vhdlFile, ": ");
 
 	if(genericDecl->defaultValue){
@@ -142,17 +141,8 @@ static void emitPortDeclarationOpen(struct AstNode* pDecl){
 
 static void emitPortDeclaration(struct AstNode* pdecl){
 	struct PortDecl* portDecl = (struct PortDecl*) pdecl;
-	fprintf(vhdlFile, "%c%s", emitIndent(), portDecl->name->value);
-
-	struct Identifier *curr, *prev;
-    curr = portDecl->name->next;
-
-    while(curr){
-        prev = curr;
-        curr = curr->next;
-		fprintf(vhdlFile, ", %s", prev->value);
-    }   
-
+	fprintf(vhdlFile, "%c", emitIndent());
+	emitNameList(portDecl->names);
 	fprintf(vhdlFile, ": ");
 }
 
@@ -266,18 +256,9 @@ static void emitProcess(struct AstNode* process){
 	
 	fprintf(vhdlFile, "\n\tprocess"); 
 
-	struct Identifier *curr, *prev;
-	curr = proc->sensitivityList;
-
-	if(curr) {
-		fprintf(vhdlFile, " (%s", curr->value); 
-		curr = curr->next;
-	
-		while(curr){
-			prev = curr;
-			curr = curr->next;
-			fprintf(vhdlFile, ", %s", prev->value); 
-		} 
+	if(proc->sensitivityList) {
+		fprintf(vhdlFile, " ("); 
+		emitNameList(proc->sensitivityList);
 		fprintf(vhdlFile, ")"); 
 	}
 	fprintf(vhdlFile, " is \n"); 
@@ -573,33 +554,19 @@ static void emitBinaryOp(char* bop){
 	}
 }
 
-static void emitAttribute(struct AttributeExpr* aexp){
-	char* attributeLiteral = ((struct Identifier*)aexp->attribute)->value;
-
-	bool risingEdge = strncmp(attributeLiteral, "UP", 2) == 0; 
-	if(risingEdge){
-		fprintf(vhdlFile, "rising_edge("); 
-		emitSubExpression(aexp->object);
-		fprintf(vhdlFile, ")"); 
-		return;
-	}
+//'UP and 'DOWN become rising_edge() and falling_edge() around the object
+static const char* edgeFunction(struct AttributeExpr* aexp){
+	//a parse with errors can leave the attribute out
+	if(aexp->attribute == NULL || aexp->attribute->type != NAME_EXPR) return NULL;
 
-	bool fallingEdge = strncmp(attributeLiteral, "DOWN", 4) == 0; 
-	if(fallingEdge){
-		fprintf(vhdlFile, "falling_edge("); 
-		emitSubExpression(aexp->object);
-		fprintf(vhdlFile, ")"); 
-		return;
-	}
+	char* attributeLiteral = ((struct Identifier*)aexp->attribute)->value;
 
-	emitSubExpression(aexp->object);
-	fprintf(vhdlFile, "%c", aexp->tick);
-   emitSubExpression(aexp->attribute);
+	if(strncmp(attributeLiteral, "UP", 2) == 0) return "rising_edge";
+	if(strncmp(attributeLiteral, "DOWN", 4) == 0) return "falling_edge";
+	return NULL;
 }
 
-static void emitSubExpression(struct Expression* expr){
-	enum ExpressionType type = expr->type;
-
+static inline void emitEnterExpression(enum ExpressionType type, struct Expression* expr){
 	switch(type){
 		
 		case CHAR_EXPR: {
@@ -620,54 +587,74 @@ static void emitSubExpression(struct Expression* expr){
 			break;
 		}
 
-		case UNARY_EXPR:{
-          struct UnaryExpr* uexp = (struct UnaryExpr*) expr;
-			 fprintf(vhdlFile, "%s ", uexp->op);
-          emitSubExpression(uexp->right);
-          break;
-      }
-
-		case BINARY_EXPR:{
-          struct BinaryExpr* bexp = (struct BinaryExpr*) expr;
-          emitSubExpression(bexp->left);
-			 emitBinaryOp(bexp->op);
-          emitSubExpression(bexp->right);
-          break;
-      }
-
-		case ATTRIBUTE_EXPR:{
-         struct AttributeExpr* aexp = (struct AttributeExpr*) expr;
-			emitAttribute(aexp);
-         break;
-      }   
-
-		case CALL_EXPR:{
-         struct CallExpr* cexp = (struct CallExpr*) expr;
-         emitSubExpression(cexp->function);
-		 fprintf(vhdlFile, "(");
-         struct ExpressionNode* e = cexp->arguments;
-         while(e) {
-            emitSubExpression(e->expression);
-		    if (e->next != NULL) fprintf(vhdlFile, ", ");
-            e = e->next;
-         }
-		 fprintf(vhdlFile, ")");
-         break;
-      }   
-
-      case NAME_EXPR: {
-          //NameExpr* nexp = (NameExpr*) expr;
-          //printf("\e[0;35m""\'%s\'\r\n", nexp->name->value);
-          struct Identifier* ident = (struct Identifier*)expr;
-          fprintf(vhdlFile, "%s", ident->value);
-          break;
-       }
+		case UNARY_EXPR: {
+			struct UnaryExpr* uexp = (struct UnaryExpr*) expr;
+			fprintf(vhdlFile, "%s ", uexp->op);
+			break;
+		}
+
+		case ATTRIBUTE_EXPR: {
+			const char* edge = edgeFunction((struct AttributeExpr*)expr);
+			if(edge) fprintf(vhdlFile, "%s(", edge);
+			break;
+		}
+
+		case NAME_EXPR: {
+			struct Identifier* ident = (struct Identifier*)expr;
+			fprintf(vhdlFile, "%s", ident->value);
+			break;
+		}
  
-       default:
-          break;
+		default:
+			break;
 	}	
 }
 
+static inline bool emitBetweenOperands(enum ExpressionType type, struct Expression* expr, int operand){
+	switch(type){
+
+		case BINARY_EXPR: {
+			emitBinaryOp(((struct BinaryExpr*)expr)->op);
+			break;
+		}
+
+		case ATTRIBUTE_EXPR: {
+			struct AttributeExpr* aexp = (struct AttributeExpr*) expr;
+			if(edgeFunction(aexp)){
+				//the attribute itself is not emitted
+				fprintf(vhdlFile, ")"); 
+				return false;
+			}
+			fprintf(vhdlFile, "%c", aexp->tick);
+			break;
+		}
+
+		case CALL_EXPR: {
+			fprintf(vhdlFile, operand == 1 ? "(" : ", ");
+			break;
+		}
+
+		default:
+			break;
+	}
+
+	return true;
+}
+
+static inline void emitExitExpression(enum ExpressionType type, struct Expression* expr){
+	if(type == CALL_EXPR){
+		if(((struct CallExpr*)expr)->arguments == NULL) fprintf(vhdlFile, "(");
+		fprintf(vhdlFile, ")");
+	}
+}
+
+//defined by walker.h below, with the hooks above inlined
+static void walkExpression(struct Expression* expr);
+
+static void emitSubExpression(struct Expression* expr){
+	walkExpression(expr);
+}
+
 static void emitRange(struct AstNode* rstmt){
 	struct Range* range = (struct Range*)rstmt;
 
@@ -706,9 +693,9 @@ static void emitExpression(struct Expression* expr){
 	eStat.assignmentOp[0] = 0;
 }
 
-static void emitSpecial(struct AstNode* node){
+static inline void emitSpecial(enum AstNodeType type, struct AstNode* node){
 	
-	switch(node->type){
+	switch(type){
 	
 		case AST_GENERIC:
 			emitGenericDeclarationSpecial(node);
@@ -731,9 +718,9 @@ static void emitSpecial(struct AstNode* node){
 	}
 }
 
-static void emitClose(struct AstNode* node){
+static inline void emitClose(enum AstNodeType type, struct AstNode* node){
 
-	switch(node->type){
+	switch(type){
 
 		case AST_ENTITY:
 			emitEntityDeclarationClose(node);
@@ -781,9 +768,9 @@ static void emitClose(struct AstNode* node){
 	}
 }
 
-static void emitOpen(struct AstNode* node){
+static inline void emitOpen(enum AstNodeType type, struct AstNode* node){
 
-	switch(node->type){
+	switch(type){
 		
 		case AST_GENERIC:
 			emitGenericDeclarationOpen(node);
@@ -828,9 +815,9 @@ static void emitOpen(struct AstNode* node){
 	}
 }
 
-static void emitDefault(struct AstNode* node){
+static inline void emitDefault(enum AstNodeType type, struct AstNode* node){
 
-	switch(node->type){
+	switch(type){
 		
       case AST_PROGRAM:
          break;
@@ -952,22 +939,25 @@ static void emitDefault(struct AstNode* node){
          break;
 
       default:
-			printf("Emitter: Unhandled AST node: %d\r\n", node->type); 
+			printf("Emitter: Unhandled AST node: %d\r\n", type); 
          break;
 	}
 }
 
+//the ops get the node type as a constant, so each switch above folds to
+//the one case the walker is at
+#define WALK_DEFAULT_OP(type, node) emitDefault((type), (node))
+#define WALK_OPEN_OP(type, node) emitOpen((type), (node))
+#define WALK_CLOSE_OP(type, node) emitClose((type), (node))
+#define WALK_SPECIAL_OP(type, node) emitSpecial((type), (node))
+#define WALK_EXPRESSION_OP(expr) emitExpression(expr)
+#define WALK_ENTER_EXPRESSION_OP(type, expr) emitEnterExpression((type), (expr))
+#define WALK_BETWEEN_OPERANDS_OP(type, expr, operand) emitBetweenOperands((type), (expr), (operand))
+#define WALK_EXIT_EXPRESSION_OP(type, expr) emitExitExpression((type), (expr))
+#include <walker.h>
+
 void TranspileProgram(struct Program* prog, char* fileName){
 
-	//setup block
-	struct OperationBlock opBlk = {
-		.doDefaultOp		= emitDefault,
-		.doOpenOp			= emitOpen,
-		.doCloseOp			= emitClose,
-		.doSpecialOp		= emitSpecial,
-		.doExpressionOp	= emitExpression,
-	};
-	
 	//setup filename
 	if(fileName != NULL){
 		char* prevTok = NULL;
@@ -981,7 +971,7 @@ void TranspileProgram(struct Program* prog, char* fileName){
 			nextTok = strtok(NULL, "./");
 		}
 
-		if(prevTok != NULL && strcmp(currTok, "vent") == 0){
+		if(prevTok != NULL && (strcmp(currTok, "vent") == 0 || strcmp(currTok, "vast") == 0)){
 			strcat(prevTok, ".vhdl");
 			vhdlFile = fopen(prevTok, "w");
 		} else {
@@ -996,7 +986,7 @@ void TranspileProgram(struct Program* prog, char* fileName){
 
 		fprintf(vhdlFile,"--\n-- This file was produced using TVT (The VENT Transpiler)\n--\n\n");
 
-		WalkTree(prog, &opBlk);
+		walkTree(prog);
 
 		fclose(vhdlFile);
 	}
@@ -11,165 +11,310 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
+#include <errno.h>
+#include <unistd.h>
 
 #include <token.h>
-#include <dht.h>
+#include <lexer.h>
+#include <scan.h>
 
-static char readChar();
-static void initializeKeywordMap();
+static char readChar(struct VentLexer* l);
 
-struct lexer {
-	char *input;
+//default size of the reads a streaming lexer makes
+#define STREAM_CHUNK (64 * 1024)
+
+//streaming lexers keep copies of this many token literals, enough for a 
+//full lookahead queue plus STREAM_LOOKAHEAD tokens already handed out
+#define LITERAL_SLOTS (2 * STREAM_LOOKAHEAD)
+
+struct literalSlot {
+	char* text;
+	size_t capacity;
+};
+
+//input pulled from a file descriptor a chunk at a time
+struct lexStream {
+	int fd;
+	bool eof;
+
+	char* window;
+	size_t capacity;
+	size_t chunk;
+
+	struct literalSlot literals[LITERAL_SLOTS];
+	int nextLiteral;
+
+	struct Token ahead[STREAM_LOOKAHEAD];
+	int aheadStart;
+	int aheadCount;
+};
+
+struct VentLexer {
+	const char *input;
 	char ch;
 
-	int currPos;
-	int readPos;
-	
+	//absolute offsets into the source, input[0] sits at base
+	int64_t currPos;
+	int64_t readPos;
+	int64_t base;
+	int64_t end;
+
+	//where the token being lexed starts, a refill keeps everything from here on
+	int64_t tokenStart;
+
 	int line;
-	int length;
-} static lexer;
 
-static struct lexer *l = &lexer;
+	const struct RunScanner* scan;
+	struct lexStream* stream;
+};
 
-void InitLexer(char* in){
+static void resetLexer(struct VentLexer* l, const char* in, size_t length, const struct RunScanner* scanner){
 
-	memset(l, 0, sizeof(struct lexer));
+	memset(l, 0, sizeof(struct VentLexer));
 
 	l->input = in;
 	l->currPos = -1;
 	l->readPos = 0;
+	l->base = 0;
+	l->end = (int64_t)length;
 	l->line = 1;
-	l->length = strlen(in) + 1;
+	l->scan = scanner;
 	
-	initializeKeywordMap();
-
 	//init our lexer with a char
-	readChar();
+	readChar(l);
 }
 
-static struct DynamicHashTable* keywordMap = NULL;
+VentLexer* InitVentLexer(const char* in, size_t length){
+	return InitVentLexerWithScanner(in, length, SelectRunScanner());
+}
 
-void FreeLexer(){
-	FreeHashTable(keywordMap);
+VentLexer* InitVentLexerWithScanner(const char* in, size_t length, const struct RunScanner* scanner){
+	VentLexer* l = malloc(sizeof(struct VentLexer));
+	if(l == NULL) return NULL;
+
+	resetLexer(l, in, length, scanner);
+
+	return l;
 }
 
-static void initializeKeywordMap(){
-	keywordMap = InitHashTable();
+VentLexer* InitVentStreamLexer(int fd, size_t chunkSize){
+	VentLexer* l = malloc(sizeof(struct VentLexer));
+	struct lexStream* stream = calloc(1, sizeof(struct lexStream));
 	
-	//add all VENT keywords to map
-	SetInHashTable(keywordMap, "and", TOKEN_AND);
-	SetInHashTable(keywordMap, "arch", TOKEN_ARCH);
-	SetInHashTable(keywordMap, "assert", TOKEN_ASSERT);
-	SetInHashTable(keywordMap, "case", TOKEN_CASE);
-	SetInHashTable(keywordMap, "comp", TOKEN_COMP);
-	SetInHashTable(keywordMap, "default", TOKEN_DEFAULT);
-	SetInHashTable(keywordMap, "down", TOKEN_DOWN);
-	SetInHashTable(keywordMap, "downto", TOKEN_DOWNTO);
-	SetInHashTable(keywordMap, "else", TOKEN_ELSE);
-	SetInHashTable(keywordMap, "elsif", TOKEN_ELSIF);
-	SetInHashTable(keywordMap, "ent", TOKEN_ENT);
-	SetInHashTable(keywordMap, "error", TOKEN_ERROR);
-	SetInHashTable(keywordMap, "failure", TOKEN_FAILURE);
-	SetInHashTable(keywordMap, "for", TOKEN_FOR);
-	SetInHashTable(keywordMap, "if", TOKEN_IF);
-	SetInHashTable(keywordMap, "int", TOKEN_INTEGER);
-	SetInHashTable(keywordMap, "loop", TOKEN_LOOP);
-	SetInHashTable(keywordMap, "map", TOKEN_MAP);
-	SetInHashTable(keywordMap, "not", TOKEN_NOT);
-	SetInHashTable(keywordMap, "note", TOKEN_NOTE);
-	SetInHashTable(keywordMap, "null", TOKEN_NULL);
-	SetInHashTable(keywordMap, "or", TOKEN_OR);
-	SetInHashTable(keywordMap, "proc", TOKEN_PROC);
-	SetInHashTable(keywordMap, "rem", TOKEN_REM);
-	SetInHashTable(keywordMap, "report", TOKEN_REPORT);
-	SetInHashTable(keywordMap, "rol", TOKEN_ROL);
-	SetInHashTable(keywordMap, "ror", TOKEN_ROR);
-	SetInHashTable(keywordMap, "severity", TOKEN_SEVERITY);
-	SetInHashTable(keywordMap, "signed", TOKEN_SIGNED);
-	SetInHashTable(keywordMap, "sig", TOKEN_SIG);
-	SetInHashTable(keywordMap, "sll", TOKEN_SLL);
-	SetInHashTable(keywordMap, "sra", TOKEN_SRA);
-	SetInHashTable(keywordMap, "srl", TOKEN_SRL);
-	SetInHashTable(keywordMap, "stlv", TOKEN_STLV);
-	SetInHashTable(keywordMap, "stl", TOKEN_STL);
-	SetInHashTable(keywordMap, "string", TOKEN_STRING);
-	SetInHashTable(keywordMap, "switch", TOKEN_SWITCH);
-	SetInHashTable(keywordMap, "to", TOKEN_TO);
-	SetInHashTable(keywordMap, "type", TOKEN_TYPE);
-	SetInHashTable(keywordMap, "unsigned", TOKEN_UNSIGNED);
-	SetInHashTable(keywordMap, "up", TOKEN_UP);
-	SetInHashTable(keywordMap, "use", TOKEN_USE);
-	SetInHashTable(keywordMap, "var", TOKEN_VAR);
-	SetInHashTable(keywordMap, "wait", TOKEN_WAIT);
-	SetInHashTable(keywordMap, "warning", TOKEN_WARNING);
-	SetInHashTable(keywordMap, "while", TOKEN_WHILE);
-	SetInHashTable(keywordMap, "xor", TOKEN_XOR);
-}
-
-static enum TOKEN_TYPE getIdentifierType(char* lit){
-	uint64_t largeType = 0;
-	enum TOKEN_TYPE type = TOKEN_IDENTIFIER;
-
-	if(GetInHashTable(keywordMap, lit, &largeType)){
-		type = (enum TOKEN_TYPE)largeType;
+	if(chunkSize == 0) chunkSize = STREAM_CHUNK;
+	char* window = malloc(chunkSize);
+
+	if(l == NULL || stream == NULL || window == NULL){
+		free(l);
+		free(stream);
+		free(window);
+		return NULL;
+	}
+
+	stream->fd = fd;
+	stream->window = window;
+	stream->capacity = chunkSize;
+	stream->chunk = chunkSize;
+
+	//start with an empty window, the first readChar() pulls in a chunk
+	memset(l, 0, sizeof(struct VentLexer));
+	l->input = window;
+	l->stream = stream;
+	l->currPos = -1;
+	l->line = 1;
+	l->scan = SelectRunScanner();
+
+	readChar(l);
+
+	return l;
+}
+
+void SetVentLexerLine(VentLexer* lex, int line){
+	lex->line = line;
+}
+
+void FreeVentLexer(VentLexer* lex){
+	if(lex == NULL) return;
+
+	if(lex->stream != NULL){
+		for(int i = 0; i < LITERAL_SLOTS; i++){
+			free(lex->stream->literals[i].text);
+		}
+		free(lex->stream->window);
+		free(lex->stream);
 	}
 
-	return type;
+	free(lex);
+}
+
+//state behind the InitLexer()/NextToken() shim, one per thread so even
+//old style callers never share a lexer
+static _Thread_local struct VentLexer shimLexer;
+
+void InitLexer(char* in){
+	resetLexer(&shimLexer, in, strlen(in), SelectRunScanner());
 }
 
-static struct Token newToken(enum TOKEN_TYPE type, char literal){
+void FreeLexer(){
+	memset(&shimLexer, 0, sizeof(struct VentLexer));
+}
+
+struct Token NextToken(){
+	return NextVentToken(&shimLexer);
+}
+
+// streaming utilities
+
+/*
+	Pulls more of the stream into the window until pos is inside it or the
+	stream runs dry. Everything before tokenStart is dropped first, so the
+	window only grows past the chunk size for a single token that is 
+	longer than that.
+*/
+static bool refill(struct VentLexer* l, int64_t pos){
+	struct lexStream* s = l->stream;
+	if(s == NULL || s->eof) return false;
+
+	int64_t keep = l->tokenStart < l->currPos ? l->tokenStart : l->currPos;
+	if(keep < l->base) keep = l->base;
+	if(keep > l->end) keep = l->end;
+
+	size_t kept = (size_t)(l->end - keep);
+	memmove(s->window, s->window + (keep - l->base), kept);
+	l->base = keep;
+	l->end = keep + kept;
+
+	while(pos >= l->end && !s->eof){
+		if((size_t)(l->end - l->base) == s->capacity){
+			char* window = realloc(s->window, s->capacity * 2);
+			if(window == NULL){
+				printf("Error: Unable to grow lexer window\r\n");
+				exit(-1);
+			}
+			s->window = window;
+			s->capacity *= 2;
+		}
+
+		size_t space = s->capacity - (size_t)(l->end - l->base);
+		if(space > s->chunk) space = s->chunk;
+
+		ssize_t got = read(s->fd, s->window + (l->end - l->base), space);
+		if(got < 0 && errno == EINTR) continue;
+		if(got <= 0){
+			s->eof = true;
+			break;
+		}
+
+		l->end += got;
+	}
+
+	l->input = s->window;
+	return pos < l->end;
+}
+
+//streamed tokens get their own copy of the text, the window moves under them
+static const char* keepLiteral(struct VentLexer* l, const char* text, int length){
+	struct lexStream* s = l->stream;
+	struct literalSlot* slot = &s->literals[s->nextLiteral];
+	s->nextLiteral = (s->nextLiteral + 1) % LITERAL_SLOTS;
+
+	if(slot->capacity < (size_t)length + 1){
+		size_t capacity = (size_t)length + 1 > 64 ? (size_t)length + 1 : 64;
+		char* text = realloc(slot->text, capacity);
+		if(text == NULL){
+			printf("Error: Unable to allocate token literal\r\n");
+			exit(-1);
+		}
+		slot->text = text;
+		slot->capacity = capacity;
+	}
+
+	memcpy(slot->text, text, length);
+	slot->text[length] = '\0';
+
+	return slot->text;
+}
+
+static char charAt(struct VentLexer* l, int64_t pos){
+	if(pos >= l->end && !refill(l, pos)) return '\0';
+	return l->input[pos - l->base];
+}
+
+static const char* sourceAt(struct VentLexer* l, int64_t pos){
+	return &(l->input[pos - l->base]);
+}
+
+static struct Token finishToken(struct VentLexer* l, enum TOKEN_TYPE type, int64_t start, int64_t length){
 	struct Token tok;
 
 	tok.type = type;
 	tok.lineNumber = l->line;
+	tok.literal = sourceAt(l, start);
+	tok.length = (int)length;
 
-	tok.literal = (char*)malloc(sizeof(char) * 2);
-	tok.literal[0] = literal;
-	tok.literal[1] = '\0';
+	if(l->stream != NULL) tok.literal = keepLiteral(l, tok.literal, tok.length);
 
 	return tok;
 }
 
-static struct Token newMultiCharToken(enum TOKEN_TYPE type, int len){
-	struct Token tok = {TOKEN_ILLEGAL, 0};
+// each keyword is compared with a constant length, so memcmp gets inlined
+#define MATCH_KEYWORD(type, spelling) \
+	if(len == sizeof(spelling) - 1 && memcmp(lit, spelling, sizeof(spelling) - 1) == 0) return type;
+
+#define KEYWORD_GROUP(firstChar, group) \
+	case firstChar: group(MATCH_KEYWORD) break;
 
+static enum TOKEN_TYPE getIdentifierType(const char* lit, int len){
+	switch(lit[0]){
+		KEYWORD_LIST(KEYWORD_GROUP)
+
+		default:
+			break;
+	}
+
+	return TOKEN_IDENTIFIER;
+}
+#undef KEYWORD_GROUP
+#undef MATCH_KEYWORD
+
+static struct Token newToken(struct VentLexer* l, enum TOKEN_TYPE type){
+	//we've already passed the char so it sits at currPos-1
+	return finishToken(l, type, l->currPos-1, 1);
+}
+
+static struct Token newEndToken(struct VentLexer* l){
+	//an empty span sitting just past the last char
+	return finishToken(l, TOKEN_EOP, l->end, 0);
+}
+
+static struct Token newMultiCharToken(struct VentLexer* l, enum TOKEN_TYPE type, int len){
 	//we've already passed the first char of token  so start at currPos-1
-	char *start = &(l->input[l->currPos-1]);
-	char *end = start+1;
+	int64_t start = l->currPos-1;
 
 	for(int i = 1; i < len-1; i++){
-		readChar();
-		end++;
+		readChar(l);
 	}	
 
 	//move the lexer past the token
-	readChar();
-
-	int lSize = sizeof(char) * (int)(end-start) + 2;
-	tok.literal = (char*)malloc(lSize);
-	strncpy(tok.literal, start, lSize);
-	tok.literal[lSize-1] = '\0';
-
-	tok.type = type;
-	tok.lineNumber = l->line;
+	readChar(l);
 
-	return tok;
+	return finishToken(l, type, start, len);
 }
 
-static char peek(){
-	return l->input[l->currPos];
+//the source has no terminator of its own, anything past the end reads as '\0'
+static char peek(struct VentLexer* l){
+	return charAt(l, l->currPos);
 }
 
-static char peekNext(){
-	return l->input[l->readPos];
+static char peekNext(struct VentLexer* l){
+	return charAt(l, l->readPos);
 }
 
 // 'read' utilities
-static char readChar(){
+static char readChar(struct VentLexer* l){
 	
 	//grab next char in buffer
-	if(l->readPos < l->length)	
-		l->ch = l->input[l->readPos];
+	l->ch = charAt(l, l->readPos);
 	
 	//bump positions	
 	l->currPos = l->readPos;
@@ -178,210 +323,161 @@ static char readChar(){
 	return l->ch;
 }
 
-#define INVALID_CHAR_NUM 25
-char invalidCharacters[INVALID_CHAR_NUM] = { 
-   ' ', ';', '=', '{', '}',
-   '(', ')', '<', '>', '+',
-   '-', '*', '/', ',', '`',
-   '~', '!', '&', '?', '"',
-	':', '\'', '\n', '\0', '@',
-};
-
-static bool charIsValidInIdentifier(char character){
-   for(int i=0; i < INVALID_CHAR_NUM; i++){
-      if( invalidCharacters[i]  == character) return false;
-   }   
-   return true;
+// jump the lexer n chars forward from the current char
+static void advance(struct VentLexer* l, int64_t n){
+	l->readPos = l->currPos + n;
+	readChar(l);
 }
-#undef INVALID_CHAR_NUM
 
+// number of chars left in the window for the scanners to look at
+static size_t remaining(struct VentLexer* l){
+	return l->currPos < l->end ? (size_t)(l->end - l->currPos) : 0;
+}
 
-static struct Token readIdentifier(){
-	struct Token tok = {TOKEN_ILLEGAL, 0};
+static struct Token readIdentifier(struct VentLexer* l){
 
 	//we've already passed the first char of
 	//identifier  so start at currPos-1
-	char *start = &(l->input[l->currPos-1]);
-	char *end = start+1;
+	int64_t start = l->currPos-1;
 
-	if(charIsValidInIdentifier(peek())){
-		while(charIsValidInIdentifier(peekNext())){
-			readChar();
-			end++;
-		}
-	} else {
-		//got a single letter identifier
-		end--;
-	}
+	//the rest of the identifier is one run of non-delimiter chars, it 
+	//only goes on past the window if the run reached its end
+	for(;;){
+		size_t avail = remaining(l);
+		size_t rest = l->scan->skipIdentifier(sourceAt(l, l->currPos), avail);
 
-	//step the lexer past the identifier
-	if(start != end) readChar();	
+		//step the lexer past the identifier
+		advance(l, rest);
+		if(rest < avail || avail == 0) break;
+	}
 
-	int lSize = sizeof(char) * (int)(end-start) + 2;
-	tok.literal = (char*)malloc(lSize);
-	strncpy(tok.literal, start, lSize);
-	tok.literal[lSize-1] = '\0';
+	struct Token tok = finishToken(l, TOKEN_IDENTIFIER, start, l->currPos - start);
 
 #ifdef DEBUG 
-	printf("DEBUG: identifer == %s\r\n", tok.literal); 
+	printf("DEBUG: identifer == %.*s\r\n", tok.length, tok.literal); 
 #endif
-	tok.type = getIdentifierType(tok.literal);
-	tok.lineNumber = l->line;
+	tok.type = getIdentifierType(tok.literal, tok.length);
 
 	return tok;
 }
 
-static struct Token readStringLiteral(){
-	struct Token tok = {TOKEN_ILLEGAL, 0};
+static struct Token readStringLiteral(struct VentLexer* l){
 
 	//we've already passed the first " of the string
 	// so start at currPos-1
-	char *start = &(l->input[l->currPos-1]);
-	char *end = start+1;
+	int64_t start = l->currPos-1;
 
-	while(peek() != '"' && peek() != '\0'){
-		readChar();
-		end++;
+	while(peek(l) != '"' && peek(l) != '\0'){
+		readChar(l);
 	}	
 
 	//add the end quote too
-	if(peek() != '\0'){
-		readChar();
-		end++;
+	if(peek(l) != '\0'){
+		readChar(l);
 	}
 
-	tok.type = TOKEN_STRINGLIT;
-	tok.lineNumber = l->line;
-	
-	int lSize = sizeof(char) * (int)(end-start) + 1;
-	tok.literal = (char*)malloc(lSize);
-	strncpy(tok.literal, start, lSize);
-	tok.literal[lSize-1] = '\0';
-
-	return tok;
+	return finishToken(l, TOKEN_STRINGLIT, start, l->currPos - start);
 }
 
-static struct Token readBitStringLiteral(){
-	struct Token tok = {TOKEN_ILLEGAL, 0};
+static struct Token readBitStringLiteral(struct VentLexer* l){
 
 	//we've already passed the first base char of 
 	//the bitstring so start at currPos-1
-	char *start = &(l->input[l->currPos-1]);
-	char *end = start+1;
+	int64_t start = l->currPos-1;
 
 	//add the start quote
-	if(peek() != '\0'){
-		readChar();
-		end++;
+	if(peek(l) != '\0'){
+		readChar(l);
 	}
 
-	while(peek() != '"' && peek() != '\0'){
-		readChar();
-		end++;
+	while(peek(l) != '"' && peek(l) != '\0'){
+		readChar(l);
 	}	
 
 	//add the end quote too
-	if(peek() != '\0'){
-		readChar();
-		end++;
+	if(peek(l) != '\0'){
+		readChar(l);
 	}
 
-	tok.type = TOKEN_BSTRINGLIT;
-	tok.lineNumber = l->line;
-	
-	int lSize = sizeof(char) * (int)(end-start) + 2;
-	tok.literal = (char*)malloc(lSize);
-	strncpy(tok.literal, start, lSize);
-	tok.literal[lSize-1] = '\0';
-
-	return tok;
+	return finishToken(l, TOKEN_BSTRINGLIT, start, l->currPos - start);
 }
 
-static struct Token readNumericLiteral(){
-	struct Token tok = {TOKEN_ILLEGAL, 0};
+static struct Token readNumericLiteral(struct VentLexer* l){
 
 	//we've already passed the first char of number so start at currPos-1
-	char *start = &(l->input[l->currPos-1]);
-	char *end = start+1;
+	int64_t start = l->currPos-1;
 
 	//TODO: This is probably still wrong. We may at least need to check ordering.
-	while((peek() >= '0' && peek() <= '9') ||  peek() == '.' || peek() == 'E' || peek() == '-'){
-		readChar();
-		end++;
+	while((peek(l) >= '0' && peek(l) <= '9') ||  peek(l) == '.' || peek(l) == 'E' || peek(l) == '-'){
+		readChar(l);
 	}	
 
-	tok.type = TOKEN_NUMBERLIT;
-	tok.lineNumber = l->line;
-	
-	int lSize = sizeof(char) * (int)(end-start) + 1; //add 1 for NULL termination
-	tok.literal = (char*)malloc(lSize);
-	strncpy(tok.literal, start, lSize);
-	tok.literal[lSize-1] = '\0';
-
-	return tok;
+	return finishToken(l, TOKEN_NUMBERLIT, start, l->currPos - start);
 }
 
-static struct Token readCharLiteral(){
-	
-	char literal = peek();
-	struct Token tok = newToken(TOKEN_CHARLIT, literal);		
+static struct Token readCharLiteral(struct VentLexer* l){
 	
-	//move lexer past literal and '
-	readChar();
-	readChar();
+	//step onto the closing ' so the literal is the char just passed, then move past it
+	readChar(l);
+	struct Token tok = newToken(l, TOKEN_CHARLIT);		
+	readChar(l);
 
 	return tok;
 }
 
 // 'is' utilities
-static bool isCharLiteral() {
-   return peekNext() == '\'';
+static bool isCharLiteral(struct VentLexer* l) {
+   return peekNext(l) == '\'';
 }
 
-static bool isBitStringLiteral() {
-   return peek() == '"';
+static bool isBitStringLiteral(struct VentLexer* l) {
+   return peek(l) == '"';
 }
 
 static bool isLetter(char c) {
-    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+	return CharHasClass(c, CC_LETTER);
 }
 
 static bool isNumber(char c) {
-    return c >= '0' && c <= '9';
+	return CharHasClass(c, CC_DIGIT);
+}
+
+// skip up to (not past) stop or the end of the source, refilling as needed
+static void skipUntil(struct VentLexer* l, char stop){
+	while(l->ch != stop && l->ch != '\0'){
+		//nothing skipped needs to survive a refill
+		l->tokenStart = l->currPos;
+		advance(l, l->scan->skipUntil(sourceAt(l, l->currPos), remaining(l), stop, &l->line));
+	}
 }
 
-static void skipWhiteSpace(){
+static void skipWhiteSpace(struct VentLexer* l){
 	for(;;){
+		l->tokenStart = l->currPos;
+
 		switch(l->ch){
 			case ' ':
 			case '\t':
 			case '\r':
-				readChar();
-				break;
-
 			case '\n':
-				l->line++;
-				readChar();
+				advance(l, l->scan->skipSpace(sourceAt(l, l->currPos), remaining(l), &l->line));
 				break;	
 
 			case '/':
-				if(peekNext() == '/') {
-					// handle single-line comment
-					while(peek() != '\n' && peek() != '\0'){
-						l->line++;
-						readChar();
-					}
-					if(peek() == '\n') l->line++;
-				} else if (peekNext() == '*'){
+				if(peekNext(l) == '/') {
+					// handle single-line comment, the '\n' gets counted as whitespace
+					skipUntil(l, '\n');
+				} else if (peekNext(l) == '*'){
 					//handle multi-line comment
-					readChar();
-					readChar();
-					while((peek() != '*' || peekNext() != '/') && peek() != '\0'){
-						if(peek() == '\n') l->line++;
-						readChar();
+					advance(l, 2);
+					for(;;){
+						l->tokenStart = l->currPos;
+						skipUntil(l, '*');
+						if(peek(l) == '\0' || peekNext(l) == '/') break;
+						advance(l, 1);
 					}
-					readChar();
-					readChar();
+					readChar(l);
+					readChar(l);
 				} else {
 					return;
 				}
@@ -393,155 +489,219 @@ static void skipWhiteSpace(){
 	}
 }
 
-struct Token NextToken() {
+static struct Token lexToken(struct VentLexer* l) {
 	
-	skipWhiteSpace();
+	skipWhiteSpace(l);
 
-	
+	l->tokenStart = l->currPos;
 	char ch = l->ch;
-	if(ch == '\0') return newToken(TOKEN_EOP, ch);
+	if(ch == '\0') return newEndToken(l);
 
-	readChar();
+	readChar(l);
 
 	switch(ch){
-		case '(' : return newToken(TOKEN_LPAREN, ch);
-		case ')' : return newToken(TOKEN_RPAREN, ch);
+		case '(' : return newToken(l, TOKEN_LPAREN);
+		case ')' : return newToken(l, TOKEN_RPAREN);
 		case ':' : 
-			if(peek() == '=') return newMultiCharToken(TOKEN_VASSIGN, 2);
-			return newToken(TOKEN_COLON, ch);
-		case ';' : return newToken(TOKEN_SCOLON, ch);
-		case '{' : return newToken(TOKEN_LBRACE, ch);
-		case '}' : return newToken(TOKEN_RBRACE, ch);
-		case ',' : return newToken(TOKEN_COMMA, ch);
-		case '|' : return newToken(TOKEN_BAR, ch);
+			if(peek(l) == '=') return newMultiCharToken(l, TOKEN_VASSIGN, 2);
+			return newToken(l, TOKEN_COLON);
+		case ';' : return newToken(l, TOKEN_SCOLON);
+		case '{' : return newToken(l, TOKEN_LBRACE);
+		case '}' : return newToken(l, TOKEN_RBRACE);
+		case ',' : return newToken(l, TOKEN_COMMA);
+		case '|' : return newToken(l, TOKEN_BAR);
 		case '!' : 
-			if(peek() == '=') return newMultiCharToken(TOKEN_NOT_EQUAL, 2); 			
+			if(peek(l) == '=') return newMultiCharToken(l, TOKEN_NOT_EQUAL, 2); 			
 		case '/' : 
-			if(peek() == '=') return newMultiCharToken(TOKEN_SLASH_EQUAL, 2); 			
-			return newToken(TOKEN_SLASH, ch);
+			if(peek(l) == '=') return newMultiCharToken(l, TOKEN_SLASH_EQUAL, 2); 			
+			return newToken(l, TOKEN_SLASH);
 		case '*' : 
-			if(peek() == '=') return newMultiCharToken(TOKEN_STAR_EQUAL, 2); 			
-			return newToken(TOKEN_STAR, ch);
+			if(peek(l) == '=') return newMultiCharToken(l, TOKEN_STAR_EQUAL, 2); 			
+			return newToken(l, TOKEN_STAR);
 		case '+' : 
-			if(peek() == '=') return newMultiCharToken(TOKEN_PLUS_EQUAL, 2); 			
-			if(peek() == '+') return newMultiCharToken(TOKEN_PLUS_PLUS, 2); 			
-			return newToken(TOKEN_PLUS, ch);
+			if(peek(l) == '=') return newMultiCharToken(l, TOKEN_PLUS_EQUAL, 2); 			
+			if(peek(l) == '+') return newMultiCharToken(l, TOKEN_PLUS_PLUS, 2); 			
+			return newToken(l, TOKEN_PLUS);
 		case '-' :
-			if(peek() == '>') return newMultiCharToken(TOKEN_INPUT, 2); 			
-			if(peek() == '=') return newMultiCharToken(TOKEN_MINUS_EQUAL, 2); 			
-			if(peek() == '-') return newMultiCharToken(TOKEN_MINUS_MINUS, 2); 			
-			return newToken(TOKEN_MINUS, ch);
+			if(peek(l) == '>') return newMultiCharToken(l, TOKEN_INPUT, 2); 			
+			if(peek(l) == '=') return newMultiCharToken(l, TOKEN_MINUS_EQUAL, 2); 			
+			if(peek(l) == '-') return newMultiCharToken(l, TOKEN_MINUS_MINUS, 2); 			
+			return newToken(l, TOKEN_MINUS);
 		case '<' :
-			if(peek() == '-') {
-				if(peekNext() == '>') return newMultiCharToken(TOKEN_INOUT, 3);
-				return newMultiCharToken(TOKEN_OUTPUT, 2);
-			} else if(peek() == '='){
-				return newMultiCharToken(TOKEN_LESS_EQUAL, 2);
+			if(peek(l) == '-') {
+				if(peekNext(l) == '>') return newMultiCharToken(l, TOKEN_INOUT, 3);
+				return newMultiCharToken(l, TOKEN_OUTPUT, 2);
+			} else if(peek(l) == '='){
+				return newMultiCharToken(l, TOKEN_LESS_EQUAL, 2);
 			} 
-			return newToken(TOKEN_LESS, ch);
+			return newToken(l, TOKEN_LESS);
 		case '>':
-			if(peek() == '=') return newMultiCharToken(TOKEN_GREATER_EQUAL, 2);
-			return newToken(TOKEN_GREATER, ch);
+			if(peek(l) == '=') return newMultiCharToken(l, TOKEN_GREATER_EQUAL, 2);
+			return newToken(l, TOKEN_GREATER);
 		case '=' : 
-			if(peek() == '>') return newMultiCharToken(TOKEN_MASSIGN, 2); 			
-			if(peek() == '=') return newMultiCharToken(TOKEN_EQUAL, 2); 			
-			return newToken(TOKEN_EQUAL, ch); 			
+			if(peek(l) == '>') return newMultiCharToken(l, TOKEN_MASSIGN, 2); 			
+			if(peek(l) == '=') return newMultiCharToken(l, TOKEN_EQUAL, 2); 			
+			return newToken(l, TOKEN_EQUAL); 			
 		case '\'':
-			if(isCharLiteral()) return readCharLiteral();
-			return newToken(TOKEN_TICK, ch);
-		case '"': return readStringLiteral();
+			if(isCharLiteral(l)) return readCharLiteral(l);
+			return newToken(l, TOKEN_TICK);
+		case '"': return readStringLiteral(l);
 		case 'B':
 		case 'O':
 		case 'X':
-			if(isBitStringLiteral()){
-				return readBitStringLiteral();
+			if(isBitStringLiteral(l)){
+				return readBitStringLiteral(l);
 			} // else must be identifier. Falling through to default!!! 
 		default:
 			if(isLetter(ch)){
-				return readIdentifier(); 
+				return readIdentifier(l); 
 			} else if (isNumber(ch)){
-				return readNumericLiteral();
+				return readNumericLiteral(l);
 			} else {
-				return newToken(TOKEN_ILLEGAL, ch);
+				return newToken(l, TOKEN_ILLEGAL);
 			}
 	}
 }
 
+struct Token NextVentToken(VentLexer* l){
+	struct lexStream* s = l->stream;
+
+	//hand out anything PeekVentToken() already lexed first
+	if(s != NULL && s->aheadCount > 0){
+		struct Token tok = s->ahead[s->aheadStart];
+		s->aheadStart = (s->aheadStart + 1) % STREAM_LOOKAHEAD;
+		s->aheadCount--;
+		return tok;
+	}
+
+	return lexToken(l);
+}
+
+struct Token PeekVentToken(VentLexer* l, int n){
+	struct lexStream* s = l->stream;
+
+	if(s == NULL){
+		//lex ahead on a copy so the lexer itself never moves
+		struct VentLexer ahead = *l;
+
+		struct Token tok = lexToken(&ahead);
+		for(int i = 0; i < n; i++){
+			tok = lexToken(&ahead);
+		}
+
+		return tok;
+	}
+
+	//a stream can't be rewound, so queue up the tokens in between instead
+	if(n >= STREAM_LOOKAHEAD){
+		struct Token tooFar = {TOKEN_ILLEGAL, l->line, "", 0};
+		return tooFar;
+	}
+
+	while(s->aheadCount <= n){
+		s->ahead[(s->aheadStart + s->aheadCount) % STREAM_LOOKAHEAD] = lexToken(l);
+		s->aheadCount++;
+	}
+
+	return s->ahead[(s->aheadStart + n) % STREAM_LOOKAHEAD];
+}
+
+_Static_assert(TOKEN_ILLEGAL <= UINT8_MAX, "token types must fit in the stream's type bytes");
+
+//a column is only replaced once its realloc succeeds, so a failed grow
+//still leaves buffers FreeTokenStream() can release
+static bool growColumn(void** column, uint32_t capacity, size_t width){
+	void* grown = realloc(*column, capacity * width);
+	if(grown == NULL) return false;
+
+	*column = grown;
+	return true;
+}
+
+static bool growTokenStream(struct TokenStream* ts, uint32_t capacity){
+	//capacity only moves once every column holds it
+	if(!growColumn((void**)&ts->types, capacity, sizeof(uint8_t))) return false;
+	if(!growColumn((void**)&ts->starts, capacity, sizeof(uint32_t))) return false;
+	if(!growColumn((void**)&ts->lengths, capacity, sizeof(uint32_t))) return false;
+	if(!growColumn((void**)&ts->lines, capacity, sizeof(uint32_t))) return false;
+	
+	ts->capacity = capacity;
+	return true;
+}
+
+struct TokenStream* LexTokenStream(const char* in, size_t length){
+	//offsets in the stream are 32 bits
+	if(length > UINT32_MAX) return NULL;
+
+	struct TokenStream* ts = calloc(1, sizeof(struct TokenStream));
+	if(ts == NULL) return NULL;
+
+	struct VentLexer lex;
+	resetLexer(&lex, in, length, SelectRunScanner());
+	ts->source = in;
+
+	//VENT averages a token every few chars, start there and double as needed
+	if(!growTokenStream(ts, (uint32_t)(length / 4) + 16)){
+		FreeTokenStream(ts);
+		return NULL;
+	}
+
+	for(;;){
+		struct Token tok = lexToken(&lex);
+
+		if(ts->count == ts->capacity && !growTokenStream(ts, ts->capacity * 2)){
+			FreeTokenStream(ts);
+			return NULL;
+		}
+
+		ts->types[ts->count] = (uint8_t)tok.type;
+		ts->starts[ts->count] = (uint32_t)(tok.literal - in);
+		ts->lengths[ts->count] = (uint32_t)tok.length;
+		ts->lines[ts->count] = (uint32_t)tok.lineNumber;
+		ts->count++;
+
+		if(tok.type == TOKEN_EOP) break;
+	}
+
+	return ts;
+}
+
+void FreeTokenStream(struct TokenStream* ts){
+	if(ts == NULL) return;
+
+	free(ts->types);
+	free(ts->starts);
+	free(ts->lengths);
+	free(ts->lines);
+	free(ts);
+}
+
+void PrintTokenStream(const struct TokenStream* ts){
+	//everything but the trailing TOKEN_EOP, same as printing tokens one at a time
+	for(uint32_t i = 0; i + 1 < ts->count; i++){
+		printf("\e[0;35mtype:\e[0m %-20s \e[0;33mliteral:\e[0m %.*s\n", 
+			TokenToString(ts->types[i]), (int)ts->lengths[i], ts->source + ts->starts[i]);
+	}
+}
+
 const char* TokenToString(enum TOKEN_TYPE type){
 	switch(type){
-		case TOKEN_LPAREN: 		return "TOKEN_LPAREN";
-		case TOKEN_RPAREN:		return "TOKEN_RPAREN";
-		case TOKEN_COLON:			return "TOKEN_COLON";
-		case TOKEN_SCOLON: 		return "TOKEN_SCOLON";
-		case TOKEN_LBRACE:		return "TOKEN_LBRACE";
-		case TOKEN_RBRACE:		return "TOKEN_RBRACE";
-		case TOKEN_COMMA:			return "TOKEN_COMMA";
-		case TOKEN_TICK:			return "TOKEN_TICK";
-		case TOKEN_BAR:			return "TOKEN_BAR";
-		case TOKEN_UP:				return "TOKEN_UP";
-		case TOKEN_DOWN:			return "TOKEN_DOWN";
-		case TOKEN_SLASH:			return "TOKEN_SLASH";
-		case TOKEN_TO:				return "TOKEN_TO";
-		case TOKEN_DOWNTO:		return "TOKEN_DOWNTO";
-		case TOKEN_STAR:			return "TOKEN_STAR";
-		case TOKEN_MINUS: 		return "TOKEN_MINUS";
-		case TOKEN_PLUS:	 		return "TOKEN_PLUS";
-		case TOKEN_EQUAL: 		return "TOKEN_EQUAL";
-		case TOKEN_NOT_EQUAL:	return "TOKEN_NOT_EQUAL"; 
-		case TOKEN_GREATER: 		return "TOKEN_GREATER";
-		case TOKEN_LESS:	 		return "TOKEN_LESS";
-		case TOKEN_AND: 			return "TOKEN_AND";
-		case TOKEN_OR: 			return "TOKEN_OR";
-		case TOKEN_XOR: 			return "TOKEN_XOR";
-		case TOKEN_NOT: 			return "TOKEN_NOT";
-		case TOKEN_INPUT: 		return "TOKEN_INPUT";
-		case TOKEN_OUTPUT: 		return "TOKEN_OUTPUT";
-		case TOKEN_INOUT: 		return "TOKEN_INOUT";
-		case TOKEN_SASSIGN: 		
-		case TOKEN_LESS_EQUAL:	return "TOKEN_LESS_EQUAL";
-		case TOKEN_VASSIGN: 		return "TOKEN_VASSIGN";
-		case TOKEN_MASSIGN: 		return "TOKEN_MASSIGN";
-		case TOKEN_STL:	 		return "TOKEN_STL";
-		case TOKEN_STLV:	 		return "TOKEN_STLV";
-		case TOKEN_SIG:	 		return "TOKEN_SIG";
-		case TOKEN_VAR:	 		return "TOKEN_VAR";
-		case TOKEN_INTEGER: 		return "TOKEN_INTEGER";
-		case TOKEN_STRING: 		return "TOKEN_STRING";
-		case TOKEN_BIT:	 		return "TOKEN_BIT";
-		case TOKEN_BITV: 			return "TOKEN_BITV";
-		case TOKEN_SIGNED: 		return "TOKEN_SIGNED";
-		case TOKEN_UNSIGNED: 	return "TOKEN_UNSIGNED";
-		case TOKEN_TYPE: 			return "TOKEN_TYPE";
-		case TOKEN_IDENTIFIER:	return "TOKEN_IDENTIFIER";
-		case TOKEN_CHARLIT: 		return "TOKEN_CHARLIT";
-		case TOKEN_NUMBERLIT:	return "TOKEN_NUMBERLIT";
-		case TOKEN_STRINGLIT:	return "TOKEN_STRINGLIT";
-		case TOKEN_BSTRINGLIT:	return "TOKEN_BSTRINGLIT";
-		case TOKEN_ENT:	 		return "TOKEN_ENT";
-		case TOKEN_ARCH:	 		return "TOKEN_ARCH";
-		case TOKEN_GEN:	 		return "TOKEN_GEN";
-		case TOKEN_COMP:	 		return "TOKEN_COMP";
-		case TOKEN_MAP:	 		return "TOKEN_MAP";
-		case TOKEN_PROC: 			return "TOKEN_PROC";
-		case TOKEN_OTHER: 		return "TOKEN_OTHER";
-		case TOKEN_IF: 			return "TOKEN_IF";
-		case TOKEN_ELSIF: 		return "TOKEN_ELSIF";
-		case TOKEN_FOR:	 		return "TOKEN_FOR";
-		case TOKEN_USE:	 		return "TOKEN_USE";
-		case TOKEN_WHILE: 		return "TOKEN_WHILE";
-		case TOKEN_LOOP: 			return "TOKEN_LOOP";
-		case TOKEN_WAIT:	 		return "TOKEN_WAIT";
-		case TOKEN_EOP:	 		return "TOKEN_EOP";
-		case TOKEN_ASSERT:	 	return "TOKEN_ASSERT";
-		case TOKEN_REPORT:	 	return "TOKEN_REPORT";
-		case TOKEN_SEVERITY:	 	return "TOKEN_SEVERITY";
-		case TOKEN_SWITCH:	 	return "TOKEN_SWITCH";
-		case TOKEN_CASE:	 		return "TOKEN_CASE";
-		case TOKEN_ILLEGAL: 		return "TOKEN_ILLEGAL";
+#define X(type) case type: return #type;
+		TOKEN_LIST(X)
+#undef X
 		default: 			return "";
 	}
 }
 
+char* CopyTokenLiteral(struct Token t){
+	char* lit = (char*)malloc(t.length + 1);
+
+	memcpy(lit, t.literal, t.length);
+	lit[t.length] = '\0';
+
+	return lit;
+}
+
 void PrintToken(struct Token t){
-	printf("\e[0;35mtype:\e[0m %-20s \e[0;33mliteral:\e[0m %s\n", TokenToString(t.type), t.literal);
+	printf("\e[0;35mtype:\e[0m %-20s \e[0;33mliteral:\e[0m %.*s\n", TokenToString(t.type), t.length, t.literal);
 }
@@ -1,21 +1,35 @@
 #include <stdio.h>
 
 #include "error.h"
+#include "internal_parser.h"
 
-static bool hadError;
+void error(struct Token where, const char* message){
+	//a parse that was given up leaves an error in every open construct on its way out
+	if(p->gaveUp) return;
 
-void error(int line, char* where, const char* message){
-	if(!hadError){
-		hadError = true;
+	//a slice parsed on a worker is parsed again in order if it has errors, that pass reports them
+	if(p->quietErrors){
+		p->hadError = true;
+		return;
+	}
+
+	if(!p->hadError){
+		p->hadError = true;
 		printf("\e[0;31m*** Got Errors ***\r\n");
 	}
-	fprintf(stderr, "\e[0;31m[line %d] Error at \'%s\': %s\n\e[0m", line, where, message);
+	fprintf(stderr, "\e[0;31m[line %d] Error at \'%.*s\': %s\n\e[0m", where.lineNumber, where.length, where.literal, message);
 }
 
-bool ThereWasAnError(void){
-	return hadError;
+void mappingError(int mapType){
+	//not an error that stops the parse, but the worker's slice is still parsed again in order
+	if(p->quietErrors){
+		p->hadError = true;
+		return;
+	}
+
+	printf("Error determining mapping! Map type == %d\r\n", mapType);
 }
 
 void resetErrors(void){
-	hadError = 0;
+	p->hadError = false;
 }
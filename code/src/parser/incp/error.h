@@ -3,7 +3,11 @@
 
 #include <stdbool.h>
 
-void error(int line, char* where, const char* message);
+#include <token.h>
+
+void error(struct Token where, const char* message);
+
+void mappingError(int mapType);
 
 void resetErrors(void);
 
@@ -1,7 +1,27 @@
 #ifndef INC_EXPRESSION_H
 #define INC_EXPRESSION_H
 
-void freeExpression(struct Expression* expr);
+#include <stdbool.h>
+
+#include <ast.h>
+#include <token.h>
+
+//l, op and r are shared, not copied, so the same node can sit on both sides (port => port)
 struct Expression* createBinaryExpression(struct Expression* l, char* op, struct Expression* r);
 
+/*
+	hash-consing, only when the parser shares expressions
+
+	findLeaf()/findNode() fill key and return the canonical node for it,
+	or NULL if there is none yet. The caller then builds the node and hands
+	it to keepExpression() with the same key. The key is left empty when
+	the parser isn't sharing or the expression is too long to share, in
+	which case keepExpression() just returns the node.
+*/
+#define EXPR_KEY_SIZE 96
+
+struct Expression* findLeaf(char* key, enum ExpressionType type, struct Token t);
+struct Expression* findNode(char* key, enum ExpressionType type, struct Token op, struct Expression* left, struct Expression* right);
+struct Expression* keepExpression(const char* key, struct Expression* expr);
+
 #endif //INC_EXPRESSION_H
@@ -2,21 +2,77 @@
 #define INC_INTERNAL_PARSER_H
 
 #include <ast.h>
+#include <parser.h>
 #include <lexer.h>
 #include <token.h>
 #include <dht.h>
+#include <arena.h>
 
-struct parser {
+struct VentParser {
    bool printTokenFlag;
+   bool preLexFlag;
+   bool shareExpressionsFlag;
+   int jobs;
+   VentLexer* lexer;
+
+   //only used when pre-lexing, the whole file is lexed up front
+   struct TokenStream* tokens;
+   uint32_t tokenIndex;
+
    struct Token currToken;
    struct Token peekToken;
+
+   //owns every node of the program being parsed
+   struct Arena* arena;
+
+   //spellings this parse has interned, so repeats skip the symbol table's lock
+   struct SymbolCache* symbols;
+
+   //symbol stores, only needed while parsing
+   struct DynamicBlockArray* componentStore;
+   struct SymbolMap* componentIndex;
+   struct SymbolMap* enumTypeTable;
+
+   //operators waiting for their right operand, shared by nested parseExpression calls
+   struct DynamicBlockArray* pendingOperators;
+
+   //call arguments and statement blocks still open, see enterNesting
+   int nesting;
+   bool gaveUp;
+
+   //canonical expression nodes by structure, only when sharing expressions
+   struct DynamicHashTable* sharedExpressions;
+
+   bool hadError;
+
+   //only set while parsing one slice of a file on a worker thread
+   bool quietErrors;
+   struct DynamicBlockArray* pendingInstances;
+   struct SymbolMap* missedTypes;
+};
+
+//an instance whose component a worker could not find, mapped again once the slices are merged
+struct PendingInstance {
+   struct DynamicBlockArray* statements;
+   uint32_t index;
+   struct ExpressionList* mappings;
 };
 
-extern struct parser* p;
-extern struct DynamicBlockArray* componentStore;
-extern struct DynamicHashTable* enumTypeTable;
+//the parser running on this thread, set for the length of each parse
+extern _Thread_local struct VentParser* p;
+
+//backs the original single-parser interface, one per thread
+extern _Thread_local struct VentParser defaultParser;
+
+void releaseParserState(struct VentParser* parser);
+
+void initParser();
+struct Program* parseProgram();
+void mapInstance(struct Instantiation* instance, struct ComponentDecl* comp, struct ExpressionList* mappings);
+struct Program* parseUnitsInParallel(struct VentParser* parser, const char* ventProgram, size_t length);
 
 void nextToken();
+struct Token lookAhead(int n);
 
 //forward declarations needed for parser
 static struct PortDecl parsePortDecl();
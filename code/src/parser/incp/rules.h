@@ -27,13 +27,13 @@ static struct Expression* parseCall(struct Expression* expr);
 static struct Expression* parseAttribute(struct Expression* expr);
 static struct Expression* parseBinary(struct Expression* expr);
 static struct Expression* parseUnary();
-static struct Expression* parseIdentifier();
+static struct Expression* parseName();
 static struct Expression* parseCharLiteral();
 static struct Expression* parseStringLiteral();
 static struct Expression* parseNumericLiteral();
 
 static struct ParseRule rules[] = { 
-   [TOKEN_IDENTIFIER]   = {parseIdentifier      , NULL            , LOWEST_PREC},
+   [TOKEN_IDENTIFIER]   = {parseName            , NULL            , LOWEST_PREC},
    [TOKEN_CHARLIT]      = {parseCharLiteral     , NULL            , LOWEST_PREC},
    [TOKEN_STRINGLIT]    = {parseStringLiteral   , NULL            , LOWEST_PREC},
    [TOKEN_NUMBERLIT]    = {parseNumericLiteral  , NULL            , LOWEST_PREC},
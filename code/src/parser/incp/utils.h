@@ -5,20 +5,32 @@
 
 #include "internal_parser.h"
 
+//tree allocations, everything lives until FreeProgram releases the arena
+void* newNode(size_t size);
+char* copyLiteral(struct Token t);
+Dba* newBlockArray(size_t bsize);
+struct ExpressionList* appendExpression(struct ExpressionList* list, struct Expression* expr);
+struct IdentifierList* appendIdentifier(struct IdentifierList* list, struct Identifier* ident);
+
 bool match(enum TOKEN_TYPE type);
 bool peek(enum TOKEN_TYPE type);
+bool peekAhead(int n, enum TOKEN_TYPE type);
 
 void consume(enum TOKEN_TYPE type, const char* msg);
 void consumeNext(enum TOKEN_TYPE type, const char* msg);
 
-struct Token copyToken(struct Token oldToken);
-void destroyToken(struct Token thisToken);
-
 bool validDataType();
 bool userDefinedDataType();
 bool validAssignment();
 
-struct ComponentDecl* getComponentFromStore(char* cname);
+void addComponentToStore(struct Declaration* decl);
+struct ComponentDecl* getComponentFromStore(uint32_t cname);
+
+void indexInterface(struct InterfaceIndex* idx, struct IdentifierList* names, bool isGeneric, uint32_t index);
+struct PortDecl* portAtPosition(struct ComponentDecl* comp, uint32_t pos);
+struct PortDecl* portNamed(struct ComponentDecl* comp, uint32_t symbol);
+struct GenericDecl* genericAtPosition(struct ComponentDecl* comp, uint32_t pos);
+struct GenericDecl* genericNamed(struct ComponentDecl* comp, uint32_t symbol);
 
 bool endOfProgram();
 bool thereAreDeclarations();
@@ -26,7 +38,7 @@ bool thereAreDesignUnits();
 bool thisIsADeclaration();
 bool thisIsAPort();
 bool thisIsAWildCard(struct Expression* map);
-bool thisIsAGenericMap(struct Expression* map, struct Identifier* name, uint16_t pos);
+bool thisIsAGenericMap(struct Expression* map, struct ComponentDecl* comp, uint32_t pos);
 
 bool positionalMapping(struct Expression* expr);
 bool associativeMapping(struct Expression* expr);
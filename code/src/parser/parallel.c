@@ -0,0 +1,399 @@
+/*
+	parallel.c
+
+	Parses the top-level units (use/ent/arch) of one file on several
+	threads. A quick pre-scan finds where each unit starts by matching
+	braces (skipping comments, strings and char literals), the units
+	are split into contiguous slices and every slice is parsed by its
+	own VentParser. The slices are then merged into a single program in
+	source order.
+
+	Cross-slice resolution:
+		a slice only sees the components and enum types it declares
+		itself, while a single pass also sees everything declared before
+		it. So every slice keeps the mappings of each instance whose
+		component it could not find, and the enum type names it looked up
+		and did not find. Once all slices are parsed they are walked in
+		source order, collecting what each one declares. Kept instances
+		whose component an earlier slice declares are mapped again against
+		it. A missed type changes how the rest of the slice parses, so a
+		slice that missed a type an earlier slice declares is parsed again,
+		seeded with everything declared before it. Either way the tree is
+		exactly the one a single pass would have built.
+
+		anything out of the ordinary (a parse error, a slice that stops
+		before its end, unbalanced braces) makes the whole file fall back
+		to a single pass, so diagnostics always come out as they always
+		have.
+	--
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include <symbol.h>
+
+//private includes
+#include "internal_parser.h"
+#include "utils.h"
+#include "error.h"
+
+//slices per job, a few extra keep the threads busy when slices differ in cost
+#define SLICES_PER_JOB 4
+
+struct unitStart {
+	size_t offset;
+	int line;
+};
+
+struct unitSlice {
+	const char* text;
+	size_t length;
+	int line;
+
+	struct VentParser* parser;
+	struct Program* prog;
+	int seededComponents;
+	bool stoppedEarly;
+};
+
+struct sliceQueue {
+	struct unitSlice* slices;
+	uint32_t count;
+	uint32_t next;
+};
+
+//everything declared by the slices merged so far
+struct knownStores {
+	Dba* components;
+	struct SymbolMap* componentNames;
+	struct SymbolMap* types;
+};
+
+static size_t skipComment(const char* src, size_t i, size_t length, int* line){
+	if(src[i+1] == '/'){
+		//leave the '\n' for the caller to count
+		while(i < length && src[i] != '\n' && src[i] != '\0') i++;
+		return i;
+	}
+
+	i += 2;
+	while(i < length && src[i] != '\0'){
+		if(src[i] == '*' && i + 1 < length && src[i+1] == '/') return i + 2;
+		if(src[i] == '\n') (*line)++;
+		i++;
+	}
+
+	return i;
+}
+
+static size_t skipSpaceAndComments(const char* src, size_t i, size_t length, int* line){
+	while(i < length && src[i] != '\0'){
+		char c = src[i];
+
+		if(c == '\n'){
+			(*line)++;
+			i++;
+		} else if(c == ' ' || c == '\t' || c == '\r'){
+			i++;
+		} else if(c == '/' && i + 1 < length && (src[i+1] == '/' || src[i+1] == '*')){
+			i = skipComment(src, i, length, line);
+		} else {
+			break;
+		}
+	}
+
+	return i;
+}
+
+//finds where every top-level unit starts, false if the braces don't balance
+static bool findUnits(const char* src, size_t length, Dba* units){
+	size_t i = 0;
+	int line = 1;
+
+	for(;;){
+		i = skipSpaceAndComments(src, i, length, &line);
+		if(i >= length || src[i] == '\0') return true;
+
+		struct unitStart start = {i, line};
+		WriteBlockArray(units, (char*)(&start));
+
+		//a unit ends with its closing brace, or with a ';' outside any braces (use)
+		int depth = 0;
+		bool ended = false;
+		while(!ended && i < length && src[i] != '\0'){
+			char c = src[i];
+
+			if(c == '/' && i + 1 < length && (src[i+1] == '/' || src[i+1] == '*')){
+				i = skipComment(src, i, length, &line);
+				continue;
+			}
+
+			if(c == '"'){
+				for(i++; i < length && src[i] != '"' && src[i] != '\0'; i++){
+					if(src[i] == '\n') line++;
+				}
+			} else if(c == '\'' && i + 2 < length && src[i+2] == '\''){
+				i += 2;
+			} else if(c == '\n'){
+				line++;
+			} else if(c == '{'){
+				depth++;
+			} else if(c == '}'){
+				if(--depth < 0) return false;
+				ended = depth == 0;
+			} else if(c == ';' && depth == 0){
+				ended = true;
+			}
+
+			i++;
+		}
+
+		if(!ended) return depth == 0;
+	}
+}
+
+static void seedStores(struct knownStores* known){
+	for(int i = 0; i < BlockCount(known->components); i++){
+		addComponentToStore((struct Declaration*)ReadBlockArray(known->components, i));
+	}
+
+	uint32_t cursor = 0;
+	uint32_t type = NO_SYMBOL;
+	while(NextInSymbolMap(known->types, &cursor, &type, NULL)){
+		SetInSymbolMap(p->enumTypeTable, type, 1);
+	}
+}
+
+static void parseSlice(struct unitSlice* slice, struct knownStores* seed){
+	struct VentParser* outer = p;
+	p = slice->parser;
+
+	initParser();
+	p->quietErrors = true;
+	p->pendingInstances = InitBlockArray(sizeof(struct PendingInstance));
+	p->missedTypes = InitSymbolMap();
+
+	if(seed) seedStores(seed);
+	slice->seededComponents = BlockCount(p->componentStore);
+
+	p->lexer = InitVentLexer(slice->text, slice->length);
+	if(p->lexer) SetVentLexerLine(p->lexer, slice->line);
+
+	slice->prog = parseProgram();
+	slice->stoppedEarly = !endOfProgram();
+
+	p = outer;
+}
+
+static void* parseSlices(void* arg){
+	struct sliceQueue* queue = (struct sliceQueue*)arg;
+
+	for(;;){
+		uint32_t i = __atomic_fetch_add(&queue->next, 1, __ATOMIC_RELAXED);
+		if(i >= queue->count) break;
+
+		parseSlice(&queue->slices[i], NULL);
+	}
+
+	return NULL;
+}
+
+static bool anyKeyIn(struct SymbolMap* keys, struct SymbolMap* table){
+	if(SymbolMapCount(keys) == 0 || SymbolMapCount(table) == 0) return false;
+
+	uint32_t cursor = 0;
+	uint32_t key = NO_SYMBOL;
+	while(NextInSymbolMap(keys, &cursor, &key, NULL)){
+		if(GetInSymbolMap(table, key, NULL)) return true;
+	}
+
+	return false;
+}
+
+static void learnSlice(struct unitSlice* slice, struct knownStores* known){
+	struct VentParser* parser = slice->parser;
+
+	//only what the slice declared itself, the seed is already known
+	for(int i = slice->seededComponents; i < BlockCount(parser->componentStore); i++){
+		struct Declaration* decl = (struct Declaration*)ReadBlockArray(parser->componentStore, i);
+		WriteBlockArray(known->components, (char*)decl);
+
+		//a later declaration of the same name wins, as it does in a single pass
+		struct Identifier* name = decl->as.componentDeclaration.name;
+		if(name) SetInSymbolMap(known->componentNames, name->symbol, BlockCount(known->components) - 1);
+	}
+
+	uint32_t cursor = 0;
+	uint32_t type = NO_SYMBOL;
+	while(NextInSymbolMap(parser->enumTypeTable, &cursor, &type, NULL)){
+		SetInSymbolMap(known->types, type, 1);
+	}
+}
+
+static void mapPendingInstances(struct unitSlice* slice, struct knownStores* known){
+	struct VentParser* outer = p;
+	p = slice->parser;
+
+	//the new map nodes go in the slice's own arena
+	for(int i = 0; i < BlockCount(p->pendingInstances); i++){
+		struct PendingInstance* pending = (struct PendingInstance*)ReadBlockArray(p->pendingInstances, i);
+		if(pending->statements == NULL) continue;
+
+		struct ConcurrentStatement* stmt = (struct ConcurrentStatement*)ReadBlockArray(pending->statements, pending->index);
+		struct Instantiation* instance = &(stmt->as.instantiation);
+		uint64_t index = 0;
+
+		if(GetInSymbolMap(known->componentNames, instance->name->symbol, &index)){
+			struct Declaration* decl = (struct Declaration*)ReadBlockArray(known->components, index);
+			mapInstance(instance, &(decl->as.componentDeclaration), pending->mappings);
+		}
+	}
+
+	p = outer;
+}
+
+static bool resolveSlices(struct unitSlice* slices, uint32_t count){
+	struct knownStores known = {
+		.components = InitSegmentedBlockArray(sizeof(struct Declaration)),
+		.componentNames = InitSymbolMap(),
+		.types = InitSymbolMap(),
+	};
+
+	bool ok = true;
+	for(uint32_t i = 0; ok && i < count; i++){
+		struct unitSlice* slice = &slices[i];
+
+		//a type changes how the slice parses, a component only how its instances map
+		if(i > 0 && anyKeyIn(slice->parser->missedTypes, known.types)){
+			FreeArena(slice->prog->arena);
+			parseSlice(slice, &known);
+		}
+		mapPendingInstances(slice, &known);
+
+		ok = !slice->parser->hadError && !slice->stoppedEarly;
+		if(ok) learnSlice(slice, &known);
+	}
+
+	FreeBlockArray(known.components);
+	FreeSymbolMap(known.componentNames);
+	FreeSymbolMap(known.types);
+
+	return ok;
+}
+
+static void releaseArena(void* arena){
+	FreeArena((struct Arena*)arena);
+}
+
+static struct Program* mergeSlices(struct unitSlice* slices, uint32_t count){
+	struct Program* prog = newNode(sizeof(struct Program));
+	prog->self.type = AST_PROGRAM;
+	prog->arena = p->arena;
+
+	for(uint32_t i = 0; i < count; i++){
+		struct Program* part = slices[i].prog;
+
+		//the nodes stay where they are, the program's arena frees them
+		ArenaOnRelease(p->arena, releaseArena, part->arena);
+
+		if(part->units && BlockCount(part->units) > 0){
+			if(prog->units == NULL){
+				prog->units = newBlockArray(sizeof(struct DesignUnit));
+			}
+			AppendBlockArray(prog->units, BlocksBegin(part->units), BlockCount(part->units));
+		}
+	}
+
+	return prog;
+}
+
+static uint32_t sliceUnits(const char* src, size_t length, Dba* units, uint32_t wanted, struct unitSlice* slices){
+	uint32_t unitCount = BlockCount(units);
+	uint32_t count = 0;
+	size_t target = length / wanted;
+
+	//cut at unit starts once a slice holds about its share of the bytes
+	for(uint32_t u = 0; u < unitCount; u++){
+		struct unitStart* start = (struct unitStart*)ReadBlockArray(units, u);
+
+		if(count == 0 || (start->offset >= target * count && count < wanted)){
+			if(count > 0) slices[count-1].length = start->offset - (slices[count-1].text - src);
+
+			slices[count].text = src + start->offset;
+			slices[count].line = start->line;
+			count++;
+		}
+	}
+	slices[count-1].length = length - (slices[count-1].text - src);
+
+	return count;
+}
+
+struct Program* parseUnitsInParallel(struct VentParser* parser, const char* ventProgram, size_t length){
+	Dba* units = InitBlockArray(sizeof(struct unitStart));
+	if(units == NULL) return NULL;
+
+	//nothing to split, or braces a single pass should report on
+	if(!findUnits(ventProgram, length, units) || BlockCount(units) < 2){
+		FreeBlockArray(units);
+		return NULL;
+	}
+
+	uint32_t wanted = (uint32_t)parser->jobs * SLICES_PER_JOB;
+	if(wanted > (uint32_t)BlockCount(units)) wanted = BlockCount(units);
+
+	struct unitSlice* slices = calloc(wanted, sizeof(struct unitSlice));
+	uint32_t count = slices ? sliceUnits(ventProgram, length, units, wanted, slices) : 0;
+	FreeBlockArray(units);
+
+	bool ok = slices != NULL;
+	for(uint32_t i = 0; ok && i < count; i++){
+		slices[i].parser = InitVentParser();
+		ok = slices[i].parser != NULL;
+		if(ok) SetVentParserShareExpressions(slices[i].parser, parser->shareExpressionsFlag);
+	}
+
+	struct Program* prog = NULL;
+	if(ok){
+		struct sliceQueue queue = {slices, count, 0};
+
+		//this thread works through the queue too, so it still finishes if no thread starts
+		pthread_t* threads = calloc(parser->jobs, sizeof(pthread_t));
+		int started = 0;
+		for(int t = 1; threads && t < parser->jobs && (uint32_t)t < count; t++){
+			if(pthread_create(&threads[started], NULL, parseSlices, &queue) == 0) started++;
+		}
+		parseSlices(&queue);
+		for(int t = 0; t < started; t++){
+			pthread_join(threads[t], NULL);
+		}
+		free(threads);
+
+		struct VentParser* outer = p;
+		p = parser;
+
+		releaseParserState(parser);
+		resetErrors();
+
+		if(resolveSlices(slices, count)){
+			p->arena = InitArena(0);
+			prog = mergeSlices(slices, count);
+		} else {
+			for(uint32_t i = 0; i < count; i++){
+				FreeArena(slices[i].prog->arena);
+			}
+		}
+
+		p = outer;
+	}
+
+	for(uint32_t i = 0; slices && i < count; i++){
+		FreeVentParser(slices[i].parser);
+	}
+	free(slices);
+
+	return prog;
+}
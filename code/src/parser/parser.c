@@ -106,6 +106,8 @@
 #include <stdbool.h>
 #include <stdio.h>
 
+#include <symbol.h>
+
 //private includes
 #include "internal_parser.h"
 #include "rules.h"
@@ -113,176 +115,403 @@
 #include "utils.h"
 #include "expression.h"
 
-static struct parser parser;
-struct parser *p = &parser;
+_Thread_local struct VentParser* p = NULL;
+
+_Thread_local struct VentParser defaultParser;
+
+VentParser* InitVentParser(void){
+	struct VentParser* parser = calloc(1, sizeof(struct VentParser));
+	if(parser == NULL){
+		printf("Error: Unable to allocate parser\r\n");
+	}
+
+	return parser;
+}
+
+void FreeVentParser(VentParser* parser){
+	if(parser == NULL) return;
 
-struct DynamicBlockArray* componentStore;
-struct DynamicHashTable* enumTypeTable;
+	releaseParserState(parser);
+	free(parser);
+}
+
+void SetVentParserPrintTokens(VentParser* parser, bool on){
+	parser->printTokenFlag = on;
+}
+
+void SetVentParserPreLex(VentParser* parser, bool on){
+	parser->preLexFlag = on;
+}
+
+void SetVentParserShareExpressions(VentParser* parser, bool on){
+	parser->shareExpressionsFlag = on;
+}
+
+void SetVentParserJobs(VentParser* parser, int jobs){
+	parser->jobs = jobs;
+}
+
+bool VentParserHadError(VentParser* parser){
+	return parser->hadError;
+}
 
 void SetPrintTokenFlag(){
-	p->printTokenFlag = true;
+	SetVentParserPrintTokens(&defaultParser, true);
 }
 
-static void initParser(){
+void SetPreLexFlag(){
+	SetVentParserPreLex(&defaultParser, true);
+}
+
+bool ThereWasAnError(){
+	return VentParserHadError(&defaultParser);
+}
 
-	//preserve printToken btw inits
+void initParser(){
+
+	//stores left over from a program that was never freed
+	releaseParserState(p);
+
+	//preserve flags btw inits
 	bool keepPrinting = p->printTokenFlag;
+	bool keepPreLexing = p->preLexFlag;
+	bool keepSharing = p->shareExpressionsFlag;
+	int keepJobs = p->jobs;
 
-	memset(p, 0, sizeof(struct parser));
+	memset(p, 0, sizeof(struct VentParser));
 
 	p->printTokenFlag = keepPrinting;
-	p->currToken = NextToken();
-	p->peekToken = NextToken();
-
-	componentStore = InitBlockArray(sizeof(struct Declaration));
-	enumTypeTable = InitHashTable();
+	p->preLexFlag = keepPreLexing;
+	p->shareExpressionsFlag = keepSharing;
+	p->jobs = keepJobs;
+
+	//segmented, so a component found in the store stays put while more are added
+	p->symbols = InitSymbolCache();
+	p->componentStore = InitSegmentedBlockArray(sizeof(struct Declaration));
+	p->componentIndex = InitSymbolMap();
+	p->enumTypeTable = InitSymbolMap();
+	if(p->shareExpressionsFlag) p->sharedExpressions = InitHashTable();
 	
 	resetErrors();
 }
 
+static void primeTokens(){
+	if(p->tokens != NULL){
+		if(p->printTokenFlag) PrintTokenStream(p->tokens);
+
+		p->currToken = TokenAt(p->tokens, 0);
+		p->peekToken = TokenAt(p->tokens, 1);
+	} else {
+		p->currToken = NextVentToken(p->lexer);
+		p->peekToken = NextVentToken(p->lexer);
+	}
+}
+
 void nextToken(){	
 	
-	if(p->printTokenFlag) PrintToken(p->currToken);
+	if(p->tokens != NULL){
+		//the stream was already printed in one go
+		p->tokenIndex++;
+		p->currToken = p->peekToken;
+		p->peekToken = TokenAt(p->tokens, p->tokenIndex + 1);
+		return;
+	}
 
-	free(p->currToken.literal);
+	if(p->printTokenFlag) PrintToken(p->currToken);
 
 	p->currToken = p->peekToken;
-	p->peekToken = NextToken();
+	p->peekToken = NextVentToken(p->lexer);
 }
 
-static struct ParseRule* getRule(enum TOKEN_TYPE type){
-	return &rules[type];
-}
-
-static struct Expression* parseExpression(enum Precedence precedence){
-	ParsePrefixFn prefixRule = getRule(p->currToken.type)->prefix;
-
-	if(prefixRule == NULL){
-		error(p->currToken.lineNumber, p->currToken.literal, "Expect l-value expression");
-		return NULL;
-	}	
-	struct Expression* leftExp = prefixRule();
-
-	//never move past the semicolon at the end of an expression
-	if(!match(TOKEN_SCOLON)) nextToken();	
+struct Token lookAhead(int n){
+	if(n == 0) return p->currToken;
+	if(n == 1) return p->peekToken;
 
-	while(!peek(TOKEN_SCOLON) && precedence < getRule(p->currToken.type)->precedence){
-		ParseInfixFn infixRule = getRule(p->currToken.type)->infix;
-
-		if(infixRule == NULL){
-			return leftExp;
-		}
+	if(p->tokens != NULL) return TokenAt(p->tokens, p->tokenIndex + n);
+	return PeekVentToken(p->lexer, n - 2);
+}
 
-		leftExp = infixRule(leftExp);
-	}
+static struct ParseRule* getRule(enum TOKEN_TYPE type){
+	//tokens past the last one in the table, like TOKEN_EOP, have no rule
+	static struct ParseRule noRule = {0};
+	if(type >= sizeof(rules) / sizeof(rules[0])) return &noRule;
 
-	return leftExp;
+	return &rules[type];
 }
 
+static struct Expression* parseExpression(enum Precedence precedence);
+
 static struct Expression* parseIdentifier(){
-	struct Identifier* ident = calloc(1, sizeof(struct Identifier));
+	struct Identifier* ident = newNode(sizeof(struct Identifier));
 #ifdef DEBUG
 	memcpy(&(ident->self.root.token), &(p->currToken), sizeof(struct Token));
 #endif
 	ident->self.root.type = AST_IDENTIFIER;
 	ident->self.type = NAME_EXPR;
 
-	int size = strlen(p->currToken.literal) + 1;
-	ident->value = calloc(size, sizeof(char));
-	memcpy(ident->value, p->currToken.literal, size);
+	const char* spelling = NULL;
+	ident->symbol = InternCachedSymbol(p->symbols, p->currToken.literal, p->currToken.length, &spelling);
+	ident->value = (char*)spelling;
 	
 	return &(ident->self);
 }
 
+//an identifier used as a value, unlike a declared name it can be shared
+static struct Expression* parseName(){
+	char key[EXPR_KEY_SIZE];
+	struct Expression* shared = findLeaf(key, NAME_EXPR, p->currToken);
+	if(shared) return shared;
+
+	return keepExpression(key, parseIdentifier());
+}
+
 static struct Expression* parseCharLiteral(){
-	struct CharExpr* chexp = calloc(1, sizeof(struct CharExpr));
+	char key[EXPR_KEY_SIZE];
+	struct Expression* shared = findLeaf(key, CHAR_EXPR, p->currToken);
+	if(shared) return shared;
+
+	struct CharExpr* chexp = newNode(sizeof(struct CharExpr));
 #ifdef DEBUG
 	memcpy(&(chexp->self.root.token), &(p->currToken), sizeof(struct Token));
 #endif
 	chexp->self.root.type = AST_EXPRESSION;
 	chexp->self.type = CHAR_EXPR;
 
-	int size = strlen(p->currToken.literal) + 1;
-	chexp->literal = calloc(size, sizeof(char));
-	memcpy(chexp->literal, p->currToken.literal, size);
+	chexp->literal = copyLiteral(p->currToken);
 	
-	return &(chexp->self);
+	return keepExpression(key, &(chexp->self));
 }
 
 static struct Expression* parseStringLiteral(){
-	struct StringExpr* stexp = calloc(1, sizeof(struct StringExpr));
+	char key[EXPR_KEY_SIZE];
+	struct Expression* shared = findLeaf(key, STRING_EXPR, p->currToken);
+	if(shared) return shared;
+
+	struct StringExpr* stexp = newNode(sizeof(struct StringExpr));
 #ifdef DEBUG
 	memcpy(&(stexp->self.root.token), &(p->currToken), sizeof(struct Token));
 #endif
 	stexp->self.root.type = AST_EXPRESSION;
 	stexp->self.type = STRING_EXPR;
 
-	int size = strlen(p->currToken.literal) + 1;
-	stexp->literal = calloc(size, sizeof(char));
-	memcpy(stexp->literal, p->currToken.literal, size);
+	stexp->literal = copyLiteral(p->currToken);
 	
-	return &(stexp->self);
+	return keepExpression(key, &(stexp->self));
 }
 
 static struct Expression* parseNumericLiteral(){
-	struct NumExpr* nexp = calloc(1, sizeof(struct NumExpr));
+	char key[EXPR_KEY_SIZE];
+	struct Expression* shared = findLeaf(key, NUM_EXPR, p->currToken);
+	if(shared) return shared;
+
+	struct NumExpr* nexp = newNode(sizeof(struct NumExpr));
 #ifdef DEBUG
 	memcpy(&(nexp->self.root.token), &(p->currToken), sizeof(struct Token));
 #endif
 	nexp->self.root.type = AST_EXPRESSION;
 	nexp->self.type = NUM_EXPR;
 
-	int size = strlen(p->currToken.literal) + 1;
-	nexp->literal = calloc(size, sizeof(char));
-	memcpy(nexp->literal, p->currToken.literal, size);
+	nexp->literal = copyLiteral(p->currToken);
 
-	return &(nexp->self);
+	return keepExpression(key, &(nexp->self));
 }
 
-static struct Expression* parseUnary(){
-	struct UnaryExpr* uexp = calloc(1, sizeof(struct UnaryExpr));
-#ifdef DEBUG
-	memcpy(&(uexp->self.root.token), &(p->currToken), sizeof(struct Token));
-#endif
-	uexp->self.root.type = AST_EXPRESSION;
-	uexp->self.type = UNARY_EXPR;
+//a streamed token's text is reused before the operand is parsed, so keep the operator's own copy
+#define OPERATOR_SIZE 16
+static struct Token keepOperator(char* opText){
+	struct Token opToken = p->currToken;
 
-	int size = strlen(p->currToken.literal) + 1;
-	uexp->op = calloc(size, sizeof(char));
-	memcpy(uexp->op, p->currToken.literal, size);
+	int length = opToken.length < OPERATOR_SIZE ? opToken.length : OPERATOR_SIZE - 1;
+	memcpy(opText, opToken.literal, length);
+	opText[length] = '\0';
 
-	enum Precedence precedence = getRule(p->currToken.type)->precedence;
-	nextToken();
+	opToken.literal = opText;
+	opToken.length = length;
+	return opToken;
+}
 
-	uexp->right = parseExpression(precedence);
+static struct Expression* unaryNode(struct Token opToken, struct Expression* right){
+	char key[EXPR_KEY_SIZE];
+	struct Expression* shared = findNode(key, UNARY_EXPR, opToken, NULL, right);
+	if(shared) return shared;
 
-	return &(uexp->self);
-}
+	struct UnaryExpr* uexp = newNode(sizeof(struct UnaryExpr));
+	uexp->self.root.type = AST_EXPRESSION;
+	uexp->self.type = UNARY_EXPR;
 
-static struct Expression* parseBinary(struct Expression* expr){
-	struct BinaryExpr* biexp = calloc(1, sizeof(struct BinaryExpr));
+	uexp->op = copyLiteral(opToken);
 #ifdef DEBUG
-	memcpy(&(biexp->self.root.token), &(p->currToken), sizeof(struct Token));
+	memcpy(&(uexp->self.root.token), &opToken, sizeof(struct Token));
+	uexp->self.root.token.literal = uexp->op;
 #endif
+	uexp->right = right;
+
+	return keepExpression(key, &(uexp->self));
+}
+
+static struct Expression* binaryNode(struct Expression* left, struct Token opToken, struct Expression* right){
+	char key[EXPR_KEY_SIZE];
+	struct Expression* shared = findNode(key, BINARY_EXPR, opToken, left, right);
+	if(shared) return shared;
+
+	struct BinaryExpr* biexp = newNode(sizeof(struct BinaryExpr));
 	biexp->self.root.type = AST_EXPRESSION;
 
 	biexp->self.type = BINARY_EXPR;
-	biexp->left = expr;
+	biexp->left = left;
+
+	biexp->op = copyLiteral(opToken);
+#ifdef DEBUG
+	memcpy(&(biexp->self.root.token), &opToken, sizeof(struct Token));
+	biexp->self.root.token.literal = biexp->op;
+#endif
+	biexp->right = right;
+
+	return keepExpression(key, &(biexp->self));
+}
+
+//rule table entries for operators, parseExpression spots these and keeps the
+//operators on its own stack, called directly they parse a single operator
+static struct Expression* parseUnary(){
+	char opText[OPERATOR_SIZE];
+	struct Token opToken = keepOperator(opText);
+	enum Precedence precedence = getRule(p->currToken.type)->precedence;
+	nextToken();
 
-	int size = strlen(p->currToken.literal) + 1;
-	biexp->op = calloc(size, sizeof(char));
-	memcpy(biexp->op, p->currToken.literal, size);
+	//the operand comes first so a shared node is found before anything is allocated
+	struct Expression* right = parseExpression(precedence);
+	return unaryNode(opToken, right);
+}
 
+static struct Expression* parseBinary(struct Expression* expr){
+	char opText[OPERATOR_SIZE];
+	struct Token opToken = keepOperator(opText);
 	enum Precedence precedence = getRule(p->currToken.type)->precedence;
 	nextToken();
 	
-	biexp->right = parseExpression(precedence);
+	struct Expression* right = parseExpression(precedence);
+	return binaryNode(expr, opToken, right);
+}
+
+//an operator whose right operand is still being parsed
+struct PendingOperator {
+	struct Expression* left;	//NULL for a prefix operator
+	struct Token opToken;
+	char opText[OPERATOR_SIZE];
+	enum Precedence precedence;
+};
+
+static struct Expression* reduceOperator(struct PendingOperator* pending, struct Expression* right){
+	//the stack may have moved since the operator was kept
+	pending->opToken.literal = pending->opText;
+
+	if(pending->left == NULL) return unaryNode(pending->opToken, right);
+	return binaryNode(pending->left, pending->opToken, right);
+}
+
+static enum Precedence pushOperator(Dba* pending, struct Expression* left){
+	struct PendingOperator op = {.left = left};
+	op.opToken = keepOperator(op.opText);
+	op.precedence = getRule(p->currToken.type)->precedence;
+	WriteBlockArray(pending, (char*)&op);
+
+	nextToken();
+	return op.precedence;
+}
+
+//call arguments and statement blocks still nest on the call stack, a file
+//nested deeper than this is reported and given up instead of overflowing it
+#define MAX_NESTING 1000
 
-	return &(biexp->self);
+static bool enterNesting(){
+	if(p->nesting == MAX_NESTING){
+		error(p->currToken, "Calls or blocks nested too deeply");
+
+		//nothing left in the file can be parsed in its place, skip to the end
+		p->gaveUp = true;
+		while(!match(TOKEN_EOP)) nextToken();
+		return false;
+	}
+
+	p->nesting++;
+	return true;
+}
+
+static void leaveNesting(){
+	p->nesting--;
+}
+
+//precedence climbing with the pending operators on a heap stack instead of
+//the call stack, so long operator chains and runs of prefix operators from
+//generated code parse in bounded stack space. Only call arguments recurse,
+//and enterNesting bounds how deep
+static struct Expression* parseExpression(enum Precedence precedence){
+	if(!enterNesting()) return NULL;
+
+	//a call argument parses its own expression on top of the caller's operators
+	if(p->pendingOperators == NULL) p->pendingOperators = InitBlockArray(sizeof(struct PendingOperator));
+	Dba* pending = p->pendingOperators;
+	int depth = 0;
+
+	//binding power of the innermost pending operator
+	enum Precedence bound = precedence;
+	struct Expression* leftExp = NULL;
+
+	for(;;){
+		while(getRule(p->currToken.type)->prefix == parseUnary){
+			bound = pushOperator(pending, NULL);
+			depth++;
+		}
+
+		ParsePrefixFn prefixRule = getRule(p->currToken.type)->prefix;
+		if(prefixRule == NULL){
+			error(p->currToken, "Expect l-value expression");
+			if(depth == 0) break;
+		} else {
+			leftExp = prefixRule();
+
+			//never move past the semicolon at the end of an expression
+			if(!match(TOKEN_SCOLON)) nextToken();	
+		}
+
+		//apply infix operators until one binds an operand that is still to come
+		bool operandNext = false;
+		while(!operandNext){
+			ParseInfixFn infixRule = getRule(p->currToken.type)->infix;
+			if(!peek(TOKEN_SCOLON) && bound < getRule(p->currToken.type)->precedence && infixRule != NULL){
+				if(infixRule == parseBinary){
+					bound = pushOperator(pending, leftExp);
+					depth++;
+					operandNext = true;
+				} else {
+					leftExp = infixRule(leftExp);
+				}
+				continue;
+			}
+
+			if(depth == 0) break;
+
+			struct PendingOperator op;
+			PopBlockArray(pending, (char*)&op);
+			depth--;
+			leftExp = reduceOperator(&op, leftExp);
+
+			bound = precedence;
+			if(depth > 0){
+				bound = ((struct PendingOperator*)ReadBlockArray(pending, BlockCount(pending) - 1))->precedence;
+			}
+		}
+
+		if(!operandNext) break;
+		leftExp = NULL;
+	}
+
+	leaveNesting();
+	return leftExp;
 }
 
 static struct Expression* parseAttribute(struct Expression* expr){
-	struct AttributeExpr* atexp = calloc(1, sizeof(struct AttributeExpr));
+	struct AttributeExpr* atexp = newNode(sizeof(struct AttributeExpr));
 #ifdef DEBUG
 	memcpy(&(atexp->self.root.token), &(p->currToken), sizeof(struct Token));
 #endif
@@ -302,7 +531,7 @@ static struct Expression* parseAttribute(struct Expression* expr){
 }
 
 static struct Expression* parseCall(struct Expression* expr){
-	struct CallExpr* cexp = calloc(1, sizeof(struct CallExpr));
+	struct CallExpr* cexp = newNode(sizeof(struct CallExpr));
 #ifdef DEBUG
 	memcpy(&(cexp->self.root.token), &(p->currToken), sizeof(struct Token));
 #endif
@@ -317,20 +546,14 @@ static struct Expression* parseCall(struct Expression* expr){
 	enum Precedence precedence = getRule(p->currToken.type)->precedence;
 	
     if(!match(TOKEN_RPAREN)){
-	    struct ExpressionNode* argList = calloc(1, sizeof(struct ExpressionNode));
-        struct ExpressionNode* argCurr = argList;
-
-        argCurr->expression = parseExpression(precedence);
+        struct ExpressionList* args = appendExpression(NULL, parseExpression(precedence));
 
         while(match(TOKEN_COMMA)){
             nextToken();
-            argCurr->next = calloc(1, sizeof(struct ExpressionNode));
-            argCurr = argCurr->next;
-
-            argCurr->expression = parseExpression(precedence);
+            args = appendExpression(args, parseExpression(precedence));
         }
             
-        cexp->arguments = argList; 
+        cexp->arguments = args; 
     }
 
 	consume(TOKEN_RPAREN, "Expect ')' after parameter in call expression");
@@ -339,26 +562,28 @@ static struct Expression* parseCall(struct Expression* expr){
 	return &(cexp->self);
 }
 
-static struct Identifier* parseIdentifierList(){
-	struct Identifier* ident = NULL;
+static struct IdentifierList* parseIdentifierList(){
+	struct IdentifierList* idents = NULL;
 
 	if(match(TOKEN_IDENTIFIER)){
 		consume(TOKEN_IDENTIFIER, "expect identifier");
-		ident = (struct Identifier*)parseIdentifier();
+		idents = appendIdentifier(idents, (struct Identifier*)parseIdentifier());
 	}
 
-	if(peek(TOKEN_COMMA)){
-		struct Identifier* iList = ident;
-
+	if(idents && peek(TOKEN_COMMA)){
 		while(peek(TOKEN_COMMA)) {
 			nextToken();
 			consumeNext(TOKEN_IDENTIFIER, "expect identifer after comma in identifier list");
-			iList->next = (struct Identifier*)parseIdentifier();
-			iList = iList->next;
+			idents = appendIdentifier(idents, (struct Identifier*)parseIdentifier());
 		}
 	}
 
-	return ident;
+	return idents;
+}
+
+//a declaration of several names is mapped by its first one
+static struct Expression* firstName(struct IdentifierList* names){
+	return names && names->count > 0 ? &(names->items[0]->self) : NULL;
 }
 
 static struct Label* parseLabel(){
@@ -366,12 +591,10 @@ static struct Label* parseLabel(){
 	if(match(TOKEN_IDENTIFIER) && peek(TOKEN_COLON)){
 		
 		//we got a label
-		struct Label* label = calloc(1, sizeof(struct Label));
+		struct Label* label = newNode(sizeof(struct Label));
 		label->self.type = AST_LABEL;
 		
-		int size = strlen(p->currToken.literal) + 1;
-		label->value = calloc(size, sizeof(char));
-		memcpy(label->value, p->currToken.literal, size);
+		label->value = copyLiteral(p->currToken);
 		
 		//step past label name and colon
 		nextToken();
@@ -384,7 +607,7 @@ static struct Label* parseLabel(){
 }
 
 static struct Range* parseRange(){
-	struct Range* rng = calloc(1, sizeof(struct Range));
+	struct Range* rng = newNode(sizeof(struct Range));
 	rng->self.type = AST_RANGE;
 	
 	rng->left = parseExpression(LOWEST_PREC);
@@ -403,23 +626,21 @@ static struct Range* parseRange(){
 
 static char* parseAssignmentOperator(){
 	int len = 3; // two chars  + \0
-	char* op = calloc(len, sizeof(char));
+	char* op = newNode(len);
 	
-	memcpy(op, p->currToken.literal, len-1); 
+	memcpy(op, p->currToken.literal, p->currToken.length < len-1 ? p->currToken.length : len-1); 
 
 	return op;
 }
 
-static struct DataType* parseDataType(char* val){
-	struct DataType* dt = calloc(1, sizeof(struct DataType));
+static struct DataType* parseDataType(struct Token val){
+	struct DataType* dt = newNode(sizeof(struct DataType));
 #ifdef DEBUG
 	memcpy(&(dt->self.token), &(p->currToken), sizeof(struct Token));
 #endif
 	dt->self.type = AST_DTYPE;
 
-	int size = strlen(val) + 1;
-	dt->value = calloc(size, sizeof(char));
-	memcpy(dt->value, val, size);
+	dt->value = copyLiteral(val);
 
 	if(peek(TOKEN_LPAREN)){
 		consumeNext(TOKEN_LPAREN, "Expect '(' before range in data type");
@@ -433,16 +654,14 @@ static struct DataType* parseDataType(char* val){
 	return dt;
 }
 
-static struct PortMode* parsePortMode(char* val){
-	struct PortMode* pm = calloc(1, sizeof(struct PortMode));
+static struct PortMode* parsePortMode(struct Token val){
+	struct PortMode* pm = newNode(sizeof(struct PortMode));
 #ifdef DEBUG
 	memcpy(&(pm->self.token), &(p->currToken), sizeof(struct Token));
 #endif
 	pm->self.type = AST_PMODE;
 
-	int size = strlen(val) +1;
-	pm->value = calloc(size, sizeof(char));
-	memcpy(pm->value, val, size);
+	pm->value = copyLiteral(val);
 
 	return pm;
 }
@@ -455,9 +674,9 @@ static void parseVariableDeclaration(struct VariableDecl* decl){
 		
 	nextToken();
 	if(!validDataType()){
-		error(p->currToken.lineNumber, p->currToken.literal, "Expect valid data type after signal identifier");
+		error(p->currToken, "Expect valid data type after signal identifier");
 	}	
-	decl->dtype = parseDataType(p->currToken.literal);
+	decl->dtype = parseDataType(p->currToken);
 		
 	nextToken();
 	if(match(TOKEN_VASSIGN)){
@@ -468,31 +687,29 @@ static void parseVariableDeclaration(struct VariableDecl* decl){
 	consume(TOKEN_SCOLON, "Expect semicolon at end of variable declaration");
 }
 
-struct ExpressionNode* parseEnumerationList(){
+struct ExpressionList* parseEnumerationList(){
 
-	struct ExpressionNode* elist = calloc(1, sizeof(struct ExpressionNode));
-	struct ExpressionNode *currList = elist;
+	struct ExpressionList* elist = NULL;
 	
 	while(!match(TOKEN_RBRACE)){
 				
-		struct Token prevToken = copyToken(p->currToken);
+		//a streamed token's text only lasts a few tokens, the entry can be longer
+		struct Token prevToken = p->currToken;
+		prevToken.literal = copyLiteral(prevToken);
 
 		struct Expression* curr = parseExpression(LOWEST_PREC);
 		if(curr == NULL) return NULL;
 
+		//a bad entry keeps its place in the list
 		if(curr->type != NAME_EXPR && curr->type != CHAR_EXPR){
-			error(prevToken.lineNumber, prevToken.literal, "Expect only identifier or char literal in type enumeration list");
-		} else {
-			currList->expression = curr;
+			error(prevToken, "Expect only identifier or char literal in type enumeration list");
+			curr = NULL;
 		}
-		destroyToken(prevToken);
+		elist = appendExpression(elist, curr);
 	
 		if(!match(TOKEN_RBRACE)) {		
 			consume(TOKEN_COMMA, "Expect comma after expression in expression list");
 			nextToken();
-
-			currList->next = calloc(1, sizeof(struct ExpressionNode));
-			currList = currList->next; 
 		}
 	}
 		
@@ -508,13 +725,13 @@ static void parseTypeDeclaration(struct TypeDecl* decl){
 
 	nextToken();
 	if(match(TOKEN_RBRACE)){
-		error(p->currToken.lineNumber, p->currToken.literal, "Expect non-empty enumeration list in type declaration");
+		error(p->currToken, "Expect non-empty enumeration list in type declaration");
 	} else {
 		decl->enumList = parseEnumerationList();
 	}
 
 	//add this new type to the enumType lookup table
-	SetInHashTable(enumTypeTable, decl->typeName->value, 1);
+	SetInSymbolMap(p->enumTypeTable, decl->typeName->symbol, 1);
 
 	consume(TOKEN_RBRACE, "Expect } after last enum in type declaration");
 	consumeNext(TOKEN_SCOLON, "Expect semicolon at end of type declaration");
@@ -528,9 +745,9 @@ static void parseSignalDeclaration(struct SignalDecl* decl){
 		
 	nextToken();
 	if(validDataType() || userDefinedDataType()){
-		decl->dtype = parseDataType(p->currToken.literal);
+		decl->dtype = parseDataType(p->currToken);
 	} else {
-		error(p->currToken.lineNumber, p->currToken.literal, "Expect valid data type after signal identifier");
+		error(p->currToken, "Expect valid data type after signal identifier");
 	}
 		
 	nextToken();
@@ -545,31 +762,33 @@ static void parseSignalDeclaration(struct SignalDecl* decl){
 static void parseComponentInterior(struct ComponentDecl *cDecl){
 
 	nextToken();
-	uint16_t posInComponent = 1;
+	uint32_t posInComponent = 1;
 
 	while(!match(TOKEN_RBRACE) && !match(TOKEN_EOP)){
-		struct Identifier* names = parseIdentifierList();
+		struct IdentifierList* names = parseIdentifierList();
 
 		if(thisIsAPort()) {
 			struct PortDecl port = parsePortDecl();	
-			port.name = names;
+			port.names = names;
 			port.position = posInComponent++;
 
 			if(cDecl->ports == NULL) {
-				cDecl->ports = InitBlockArray(sizeof(struct PortDecl)); 	
+				cDecl->ports = newBlockArray(sizeof(struct PortDecl)); 	
 			}
 
 			WriteBlockArray(cDecl->ports, (char*)(&port));
+			indexInterface(&(cDecl->interface), names, false, BlockCount(cDecl->ports) - 1);
 		} else { //this is a generic
 			struct GenericDecl generic = parseGenericDecl();	
-			generic.name = names;
+			generic.names = names;
 			generic.position = posInComponent++;
 
 			if(cDecl->generics == NULL) {
-				cDecl->generics = InitBlockArray(sizeof(struct GenericDecl)); 	
+				cDecl->generics = newBlockArray(sizeof(struct GenericDecl)); 	
 			}
 
 			WriteBlockArray(cDecl->generics, (char*)(&generic));
+			indexInterface(&(cDecl->interface), names, true, BlockCount(cDecl->generics) - 1);
 		}
 		nextToken();
 	}
@@ -606,7 +825,7 @@ static void parseVariableAssignment(struct VariableAssign *varAssign){
 	
 	nextToken();
 	if(!validAssignment()){
-		error(p->currToken.lineNumber, p->currToken.literal, "Expect valid variable assignment operator");
+		error(p->currToken, "Expect valid variable assignment operator");
 	}
 	varAssign->op = parseAssignmentOperator();
 	
@@ -659,22 +878,22 @@ static void parseSequentialAssignment(struct SequentialStatement* seqStmt){
 		}
 
 		default:
-			error(p->peekToken.lineNumber, p->peekToken.literal, "Expect valid assignment type in assignment statement");
+			error(p->peekToken, "Expect valid assignment type in assignment statement");
 			break;
 	}
 }
 
 static struct Choice* parseCaseChoices(){
-	struct Choice* listOfChoices = calloc(1, sizeof(struct Choice));	
+	struct Choice* listOfChoices = newNode(sizeof(struct Choice));	
 	struct Choice* choice = listOfChoices;
 
-	while(!match(TOKEN_COLON)){
+	while(!match(TOKEN_COLON) && !match(TOKEN_EOP)){
 		if(peek(TOKEN_TO) || peek(TOKEN_DOWNTO)){
 			choice->type = CHOICE_RANGE;
 			choice->as.range = parseRange();	
 		} else {
 			if(match(TOKEN_BAR)){
-				choice->nextChoice = calloc(1, sizeof(struct Choice));
+				choice->nextChoice = newNode(sizeof(struct Choice));
 				choice = choice->nextChoice;
 			} else {
 				choice->as.numExpr = parseNumericLiteral();
@@ -687,10 +906,10 @@ static struct Choice* parseCaseChoices(){
 }
 
 //need this forward declaration because sequentials can nest
-static Dba* parseSequentialStatements();
+static StmtVec* parseSequentialStatements();
 
 static Dba* parseCaseStatements(){
-	Dba* cstmts = InitBlockArray(sizeof(struct CaseStatement));
+	Dba* cstmts = newBlockArray(sizeof(struct CaseStatement));
 
 	while(match(TOKEN_CASE) || match(TOKEN_DEFAULT)){
 		struct CaseStatement caseStmt = {0};
@@ -734,7 +953,7 @@ static void parseSwitchStatement(struct SwitchStatement* switchStmt){
 
 	nextToken();
 	if(match(TOKEN_RPAREN)){
-		error(p->currToken.lineNumber, p->currToken.literal, "Expect valid expression in switch  statement");
+		error(p->currToken, "Expect valid expression in switch  statement");
 	} else {
 		switchStmt->expression = parseExpression(LOWEST_PREC);
 	}
@@ -749,44 +968,48 @@ static void parseSwitchStatement(struct SwitchStatement* switchStmt){
 };
 
 static void parseIfStatement(struct IfStatement* ifStmt){
+	//elsif branches are chained in a loop, generated decoders can have thousands
+	struct IfStatement* branch = ifStmt;
+	for(;;){
 #ifdef DEBUG
-	memcpy(&(ifStmt->self.token), &(p->currToken), sizeof(struct Token));
+		memcpy(&(branch->self.token), &(p->currToken), sizeof(struct Token));
 #endif
-	if(ifStmt->inElsIf == true){
-		ifStmt->self.type = AST_ELSIF;	
-	} else {
-		ifStmt->self.type = AST_IF;
-	}
+		if(branch->inElsIf == true){
+			branch->self.type = AST_ELSIF;	
+		} else {
+			branch->self.type = AST_IF;
+		}
 
-	if(ifStmt->inElsIf == true){
-		consume(TOKEN_ELSIF, "Expect token elsif at start of elsif statement");
-	} else {
-		consume(TOKEN_IF, "Expect token if at start of if statement");
-	}
-	consumeNext(TOKEN_LPAREN, "Expect '(' after if token");	
+		if(branch->inElsIf == true){
+			consume(TOKEN_ELSIF, "Expect token elsif at start of elsif statement");
+		} else {
+			consume(TOKEN_IF, "Expect token if at start of if statement");
+		}
+		consumeNext(TOKEN_LPAREN, "Expect '(' after if token");	
 
-	nextToken();
-	if(match(TOKEN_RPAREN)){
-		error(p->currToken.lineNumber, p->currToken.literal, "Expect valid antecedent in if statement");
-	} else {
-		ifStmt->antecedent = parseExpression(LOWEST_PREC);
-	}
-	consume(TOKEN_RPAREN, "Expect ')' after if antecedent");
-	consumeNext(TOKEN_LBRACE, "Expect '{' at start of if statement body");
+		nextToken();
+		if(match(TOKEN_RPAREN)){
+			error(p->currToken, "Expect valid antecedent in if statement");
+		} else {
+			branch->antecedent = parseExpression(LOWEST_PREC);
+		}
+		consume(TOKEN_RPAREN, "Expect ')' after if antecedent");
+		consumeNext(TOKEN_LBRACE, "Expect '{' at start of if statement body");
 
-	nextToken();
-	if(!match(TOKEN_RBRACE)){
-		ifStmt->consequentStatements = parseSequentialStatements();
-	}
-	consume(TOKEN_RBRACE, "expect '}' at end of if statement");
+		nextToken();
+		if(!match(TOKEN_RBRACE)){
+			branch->consequentStatements = parseSequentialStatements();
+		}
+		consume(TOKEN_RBRACE, "expect '}' at end of if statement");
+
+		//check for elsif block
+		if(!peek(TOKEN_ELSIF)) break;
 
-	//check for elsif block
-	if(peek(TOKEN_ELSIF)){
-		ifStmt->elsif = calloc(1, sizeof(struct IfStatement));
-		ifStmt->elsif->inElsIf = true;		
+		branch->elsif = newNode(sizeof(struct IfStatement));
+		branch->elsif->inElsIf = true;		
 
 		nextToken();
-		parseIfStatement(ifStmt->elsif);
+		branch = branch->elsif;
 	}
 
 	// check for else block
@@ -862,7 +1085,7 @@ static struct SeverityStatement parseSeverityStatement(){
 			break;
 
 		default:
-			error(p->currToken.lineNumber, p->currToken.literal, "Expect valid Severity level in severity statement");
+			error(p->currToken, "Expect valid Severity level in severity statement");
 			break;
 	}	
 	
@@ -879,7 +1102,7 @@ static void parseReportStatement(struct ReportStatement* rStmt){
 
 	nextToken();
 	if(!match(TOKEN_STRINGLIT)){
-		error(p->currToken.lineNumber, p->currToken.literal, "Expect string literalin report statement");
+		error(p->currToken, "Expect string literalin report statement");
 	}
 	rStmt->stringExpr = parseStringLiteral();
 
@@ -903,7 +1126,7 @@ static void parseAssertStatement(struct AssertStatement * aStmt){
 
 	nextToken();
 	if(match(TOKEN_RPAREN)){
-		error(p->currToken.lineNumber, p->currToken.literal, "Expect valid condition in assert statement");
+		error(p->currToken, "Expect valid condition in assert statement");
 	} else {
 		aStmt->condition = parseExpression(LOWEST_PREC);
 	}
@@ -972,121 +1195,120 @@ static void parseWaitStatement(struct WaitStatement* wStmt){
 	consume(TOKEN_SCOLON, "Expect semicolon at end of wait statement");	
 }
 
-static Dba* parseSequentialStatements(){
-	Dba* stmts = InitBlockArray(sizeof(struct SequentialStatement));
+static StmtVec* parseSequentialStatements(){
+	StmtVec* stmts = StmtVecOf(newBlockArray(sizeof(struct SequentialStatement)));
+	if(!enterNesting()) return stmts;
 	
 	while(!match(TOKEN_RBRACE) && !match(TOKEN_CASE) && !match(TOKEN_DEFAULT) && !match(TOKEN_EOP)){
 		
-		struct SequentialStatement seqStmt = {0};
+		struct SequentialStatement* seqStmt = StmtVecEmplace(stmts);
 		
 		switch(p->currToken.type){
 			case TOKEN_IDENTIFIER: { 
-				parseSequentialAssignment(&seqStmt);
+				parseSequentialAssignment(seqStmt);
 				break;
 			}
 
 			case TOKEN_IF: {
-				seqStmt.type = IF_STATEMENT;
-				parseIfStatement(&(seqStmt.as.ifStatement));
+				seqStmt->type = IF_STATEMENT;
+				parseIfStatement(&(seqStmt->as.ifStatement));
 				break;
 			}
 
 			case TOKEN_FOR: {
-				seqStmt.type = FOR_STATEMENT;
-				parseForStatement(&(seqStmt.as.forStatement));
+				seqStmt->type = FOR_STATEMENT;
+				parseForStatement(&(seqStmt->as.forStatement));
 				break;
 			}
 
 			case TOKEN_LOOP: {
-				seqStmt.type = LOOP_STATEMENT;
-				parseLoopStatement(&(seqStmt.as.loopStatement));
+				seqStmt->type = LOOP_STATEMENT;
+				parseLoopStatement(&(seqStmt->as.loopStatement));
 				break;
 			}
 
 			case TOKEN_NULL: {
-				seqStmt.type = NULL_STATEMENT;
-				parseNullStatement(&(seqStmt.as.nullStatement));
+				seqStmt->type = NULL_STATEMENT;
+				parseNullStatement(&(seqStmt->as.nullStatement));
 				break;
 			}
 
 			case TOKEN_ASSERT: {
-				seqStmt.type = ASSERT_STATEMENT;
-				parseAssertStatement(&(seqStmt.as.assertStatement));
+				seqStmt->type = ASSERT_STATEMENT;
+				parseAssertStatement(&(seqStmt->as.assertStatement));
 				break;
 			}
 
 			case TOKEN_REPORT: {
-				seqStmt.type = REPORT_STATEMENT;
-				parseReportStatement(&(seqStmt.as.reportStatement));
+				seqStmt->type = REPORT_STATEMENT;
+				parseReportStatement(&(seqStmt->as.reportStatement));
 				break;
 			}
 
 			case TOKEN_SWITCH: {
-				seqStmt.type = SWITCH_STATEMENT;
-				parseSwitchStatement(&(seqStmt.as.switchStatement));
+				seqStmt->type = SWITCH_STATEMENT;
+				parseSwitchStatement(&(seqStmt->as.switchStatement));
 				break;
 			}
 
 			case TOKEN_WAIT: {
-				seqStmt.type = WAIT_STATEMENT;
-				parseWaitStatement(&(seqStmt.as.waitStatement));
+				seqStmt->type = WAIT_STATEMENT;
+				parseWaitStatement(&(seqStmt->as.waitStatement));
 				break;
 			}
 	
 			case TOKEN_WHILE: {
-				seqStmt.type = WHILE_STATEMENT;
-				parseWhileStatement(&(seqStmt.as.whileStatement));
+				seqStmt->type = WHILE_STATEMENT;
+				parseWhileStatement(&(seqStmt->as.whileStatement));
 				break;
 			}
 	
 			default:
-				error(p->currToken.lineNumber, p->currToken.literal, "Expect valid sequential statement");
+				error(p->currToken, "Expect valid sequential statement");
 				break;
 		}
 
-		WriteBlockArray(stmts, (char*)(&seqStmt));
 		nextToken();	
 	}
 
+	leaveNesting();
 	return stmts;
 }
 
 static Dba* parseProcessBodyDeclarations(){
-	Dba* decls = InitBlockArray(sizeof(struct Declaration));
+	Dba* decls = newBlockArray(sizeof(struct Declaration));
 
 	while(thereAreDeclarations()){
 		
-		struct Declaration decl = {0};
+		struct Declaration* decl = EmplaceBlockArray(decls);
 
 		switch(p->currToken.type){
 			// TODO: VHDL does not support SIGNAL declarations in process declaration zone need to remove this and fix tests
 			case TOKEN_SIG: {
-				decl.type = SIGNAL_DECLARATION;
-				parseSignalDeclaration(&(decl.as.signalDeclaration));
+				decl->type = SIGNAL_DECLARATION;
+				parseSignalDeclaration(&(decl->as.signalDeclaration));
 				break;
 			}
 
 			case TOKEN_VAR: {
-				decl.type = VARIABLE_DECLARATION;
-				parseVariableDeclaration(&(decl.as.variableDeclaration));
+				decl->type = VARIABLE_DECLARATION;
+				parseVariableDeclaration(&(decl->as.variableDeclaration));
 				break;
 			}
 
 			default:
-				error(p->currToken.lineNumber, p->currToken.literal, "Expect valid declaration in process body");
+				error(p->currToken, "Expect valid declaration in process body");
 				break;
 		}
 
-		WriteBlockArray(decls, (char*)(&decl));
 		nextToken();	
 	}
 
 	return decls;
 }
 
-static void parseWildCardMap(struct ExpressionNode **portHead, struct Identifier* name){
-	struct ExpressionNode *portMap = NULL, *pHead = NULL;
-	struct ComponentDecl* comp = getComponentFromStore(name->value);
+static struct ExpressionList* parseWildCardMap(struct ComponentDecl* comp){
+	struct ExpressionList* portMap = NULL;
 
 	//build the instance mappings from the component
 	if(comp){
@@ -1094,114 +1316,100 @@ static void parseWildCardMap(struct ExpressionNode **portHead, struct Identifier
 		//a default value has been set up or an instance value has been passed in
 		for(int i=0; i<BlockCount(comp->ports); i++){
 			struct PortDecl* port = (struct PortDecl*)ReadBlockArray(comp->ports, i);
-			if(portMap == NULL){
-				portMap = calloc(1, sizeof(struct ExpressionNode));
-            	pHead = portMap;
-         	} else {
-            	portMap->next = calloc(1, sizeof(struct ExpressionNode));
-            	portMap = portMap->next;
-         	}
-         	portMap->expression = createBinaryExpression((struct Expression*) port->name, "=>", (struct Expression*) port->name);
+			struct Expression* name = firstName(port->names);
+			portMap = appendExpression(portMap, createBinaryExpression(name, "=>", name));
 		}
 	}
 
-	*portHead = pHead;
+	return portMap;
 }
 
-static struct Expression* parseGenericMap(struct Expression* map, struct Identifier* name, uint16_t pos){
-	struct DynamicBlockArray* generics = NULL;
-	struct ComponentDecl* comp = getComponentFromStore(name->value);
+static struct Expression* parseGenericMap(struct Expression* map, struct ComponentDecl* comp, uint32_t pos){
+	if(positionalMapping(map)){
+		struct GenericDecl* generic = genericAtPosition(comp, pos);
+		if(generic) return createBinaryExpression(firstName(generic->names), "=>", map);
+	} else if (associativeMapping(map)) {
+		struct BinaryExpr* bexp = (struct BinaryExpr*)map;
+		struct Identifier* left = (struct Identifier*)bexp->left;
+		if(genericNamed(comp, left->symbol)) return map;
+	} else if(comp && comp->generics) {
+		mappingError(map->type);
+	}
 
-	if(comp) generics = comp->generics;
+	return NULL;
+}
 
-   if(generics){
-      for(int i=0; i<BlockCount(generics); i++){
-         struct GenericDecl* generic = (struct GenericDecl*)ReadBlockArray(generics, i); 
-         if(positionalMapping(map)){
-            if(generic->position == pos){
-               	struct Expression* expr = createBinaryExpression((struct Expression*) generic->name, "=>", map);
-				freeExpression(map);
-				return expr;
-            }
-         } else if (associativeMapping(map)) {
-            struct BinaryExpr* bexp = (struct BinaryExpr*)map;
-            struct Identifier* left = (struct Identifier*)bexp->left;
-            if(strncmp(generic->name->value, left->value, sizeof(left->value)) == 0) { return map; }
-		} else { printf("Error determining mapping! Map type == %d\r\n", map->type); }
-      }   
-   }   
+static struct Expression* parsePortMap(struct Expression* map, struct ComponentDecl* comp, uint32_t pos){
+	if(positionalMapping(map)){
+		struct PortDecl* port = portAtPosition(comp, pos);
+		if(port) return createBinaryExpression(firstName(port->names), "=>", map);
+	} else if (associativeMapping(map)) {
+		struct BinaryExpr* bexp = (struct BinaryExpr*)map;
+		struct Identifier* left = (struct Identifier*)bexp->left;
+		if(portNamed(comp, left->symbol)) return map;
+	} else if(comp && comp->ports) {
+		mappingError(map->type);
+	}
 
 	return NULL;
 }
 
-static struct Expression* parsePortMap(struct Expression* map, struct Identifier* name, uint16_t pos){
-	struct DynamicBlockArray* ports = NULL;
-	struct ComponentDecl* comp = getComponentFromStore(name->value);
-
-	if(comp) ports = comp->ports;
-
-   if(ports){
-      for(int i=0; i<BlockCount(ports); i++){
-         struct PortDecl* port = (struct PortDecl*)ReadBlockArray(ports, i); 
-         if(positionalMapping(map)){
-            if(port->position == pos){
-               struct Expression* expr = createBinaryExpression((struct Expression*) port->name, "=>", map);
-					freeExpression(map);
-					return expr;
-            }
-         } else if (associativeMapping(map)) {
-            struct BinaryExpr* bexp = (struct BinaryExpr*)map;
-            struct Identifier* left = (struct Identifier*)bexp->left;
-            if(strncmp(port->name->value, left->value, sizeof(left->value)) == 0) { return map; }
-         } else { printf("Error determining mapping! Map type == %d\r\n", map->type); }
-      }   
-   }   
+void mapInstance(struct Instantiation* instance, struct ComponentDecl* comp, struct ExpressionList* mappings){
+	struct ExpressionList *portMap = NULL, *genericMap = NULL;
 
-	return NULL;
+	for(uint32_t i = 0; i < ExpressionCount(mappings); i++){
+		struct Expression* mapping = mappings->items[i];
+		uint32_t posInMap = i + 1;
+
+	   if(thisIsAWildCard(mapping)){
+			portMap = parseWildCardMap(comp);
+		} else if(thisIsAGenericMap(mapping, comp, posInMap)) {
+			genericMap = appendExpression(genericMap, parseGenericMap(mapping, comp, posInMap));
+		} else { //this is a port map
+			portMap = appendExpression(portMap, parsePortMap(mapping, comp, posInMap));
+		}
+	}
+
+	instance->genericMap = genericMap;
+	instance->portMap = portMap;
 }
 
-static struct ExpressionNode* parseInstanceMappings(struct Instantiation* instance){
-	struct ExpressionNode *portMap = NULL, *genericMap = NULL;
-	struct ExpressionNode *portHead = NULL, *genericHead = NULL;
+static void parseInstanceMappings(struct Instantiation* instance){
+	struct ExpressionList* mappings = NULL;
 
-	uint16_t posInMap = 1;
 	nextToken();
 
 	while(!match(TOKEN_RPAREN) && !match(TOKEN_EOP)){
-
-		struct Expression* mapping = parseExpression(LOWEST_PREC);
+		mappings = appendExpression(mappings, parseExpression(LOWEST_PREC));
 		
 		if(!match(TOKEN_RPAREN)){
 			consume(TOKEN_COMMA, "expect comma after identifier in mapping");		
 			nextToken();
 		}
+	}
 
-	   if(thisIsAWildCard(mapping)){
-			parseWildCardMap(&portHead, instance->name);
-		} else if(thisIsAGenericMap(mapping, instance->name, posInMap)) {
-			if(genericMap == NULL){
-				genericMap = calloc(1, sizeof(struct ExpressionNode));
-				genericHead = genericMap;
-			} else {
-				genericMap->next = calloc(1, sizeof(struct ExpressionNode));
-				genericMap = genericMap->next;
-			}
-			genericMap->expression = parseGenericMap(mapping, instance->name, posInMap);
-		} else { //this is a port map
-			if(portMap == NULL){
-				portMap = calloc(1, sizeof(struct ExpressionNode));
-				portHead = portMap;
-			} else {
-				portMap->next = calloc(1, sizeof(struct ExpressionNode));
-				portMap = portMap->next;
-			}
-			portMap->expression = parsePortMap(mapping, instance->name, posInMap);
-		}
-		posInMap++;
+	//resolve the component once for every mapping of this instance
+	struct ComponentDecl* comp = getComponentFromStore(instance->name->symbol);
+
+	//an earlier slice of the file may declare it, see parallel.c
+	if(comp == NULL && p->pendingInstances){
+		struct PendingInstance pending = {NULL, 0, mappings};
+		WriteBlockArray(p->pendingInstances, (char*)(&pending));
 	}
 
-	instance->genericMap = genericHead;
-	instance->portMap = portHead;
+	mapInstance(instance, comp, mappings);
+}
+
+//the instance is parsed into a statement that is copied into the architecture afterwards
+static void placePendingInstance(struct DynamicBlockArray* statements){
+	int count = p->pendingInstances ? BlockCount(p->pendingInstances) : 0;
+	if(count == 0) return;
+
+	struct PendingInstance* pending = (struct PendingInstance*)ReadBlockArray(p->pendingInstances, count - 1);
+	if(pending->statements == NULL){
+		pending->statements = statements;
+		pending->index = BlockCount(statements) - 1;
+	}
 }
 
 static void parseInstantiation(struct Instantiation* instance){
@@ -1246,15 +1454,15 @@ static void parseProcessStatement(struct Process* proc){
 	consume(TOKEN_RBRACE, "expect '}' at end of process statement");
 }
 
-static struct ConcurrentStatement parseArchBodyStatement(){
+//conStmt is a zeroed block of the architecture's statements, see EmplaceBlockArray
+static void parseArchBodyStatement(struct ConcurrentStatement* conStmt){
 		
-	struct ConcurrentStatement conStmt = {0};
-	conStmt.label = parseLabel();
+	conStmt->label = parseLabel();
 		
 	switch(p->currToken.type){
 		case TOKEN_PROC: {
-			conStmt.type = PROCESS;
-			parseProcessStatement(&(conStmt.as.process));
+			conStmt->type = PROCESS;
+			parseProcessStatement(&(conStmt->as.process));
 			break;
 		}
 	
@@ -1262,19 +1470,19 @@ static struct ConcurrentStatement parseArchBodyStatement(){
 			//some concurrent statements begin with identifiers
 			switch(p->peekToken.type){
 				case TOKEN_MAP: {
-					conStmt.type = INSTANTIATION;
-					parseInstantiation(&(conStmt.as.instantiation));
+					conStmt->type = INSTANTIATION;
+					parseInstantiation(&(conStmt->as.instantiation));
 					break;
 				}
 
 				case TOKEN_LESS_EQUAL: {
-					conStmt.type = SIGNAL_ASSIGNMENT;
-					parseSignalAssignment(&(conStmt.as.signalAssignment));
+					conStmt->type = SIGNAL_ASSIGNMENT;
+					parseSignalAssignment(&(conStmt->as.signalAssignment));
 					break;
 				}
 					
 				default:
-					error(p->currToken.lineNumber, p->currToken.literal, 
+					error(p->currToken, 
 						"Expect valid concurrent statement in architecture body");
 					break;
 			}
@@ -1282,67 +1490,60 @@ static struct ConcurrentStatement parseArchBodyStatement(){
 		}
 	
 		default:
-			error(p->currToken.lineNumber, p->currToken.literal, 
+			error(p->currToken, 
 				"Expect valid concurrent statement in architecture body");
 			break;
 	}
-
-	return conStmt;
 }
 
-static struct Declaration parseArchBodyDeclaration(){
-		
-	struct Declaration decl = {0};
+static void parseArchBodyDeclaration(struct Declaration* decl){
 
 	switch(p->currToken.type){
 		case TOKEN_TYPE: {
-			decl.type = TYPE_DECLARATION;
-			parseTypeDeclaration(&(decl.as.typeDeclaration));
+			decl->type = TYPE_DECLARATION;
+			parseTypeDeclaration(&(decl->as.typeDeclaration));
 			break;
 		}
 
 		case TOKEN_SIG: {
-			decl.type = SIGNAL_DECLARATION;
-			parseSignalDeclaration(&(decl.as.signalDeclaration));
+			decl->type = SIGNAL_DECLARATION;
+			parseSignalDeclaration(&(decl->as.signalDeclaration));
 			break;
 		}
 
 		case TOKEN_COMP: {
-			decl.type = COMPONENT_DECLARATION;
-			parseComponentDeclaration(&(decl.as.componentDeclaration));
-			WriteBlockArray(componentStore, (char*)(&decl));
+			decl->type = COMPONENT_DECLARATION;
+			parseComponentDeclaration(&(decl->as.componentDeclaration));
+			addComponentToStore(decl);
 			break;
 		}
 
 		default:
-			error(p->currToken.lineNumber, p->currToken.literal, 
+			error(p->currToken, 
 				"Expect valid declaration statement in architecture declarations");
 			break;
 	}
-
-	return decl;
 }
 
 static void parseArchitectureInterior(struct ArchitectureDecl* aDecl){
 	
 	while(!match(TOKEN_RBRACE) && !match(TOKEN_EOP)){
 	
+		//the nodes are parsed straight into the array, nothing else appends to it meanwhile
 		if(thisIsADeclaration()){
-			struct Declaration decl = parseArchBodyDeclaration();
-
 			if(aDecl->declarations == NULL) {
-				aDecl->declarations = InitBlockArray(sizeof(struct Declaration));
+				aDecl->declarations = newBlockArray(sizeof(struct Declaration));
 			}
 
-			WriteBlockArray(aDecl->declarations, (char*)(&decl));
+			parseArchBodyDeclaration(EmplaceBlockArray(aDecl->declarations));
 		} else { //this is a statement
-			struct ConcurrentStatement stmt = parseArchBodyStatement();
-
 			if(aDecl->statements == NULL) {
-				aDecl->statements = InitBlockArray(sizeof(struct ConcurrentStatement));
+				aDecl->statements = newBlockArray(sizeof(struct ConcurrentStatement));
 			}
 
-			WriteBlockArray(aDecl->statements, (char*)(&stmt));
+			struct ConcurrentStatement* stmt = EmplaceBlockArray(aDecl->statements);
+			parseArchBodyStatement(stmt);
+			if(stmt->type == INSTANTIATION) placePendingInstance(aDecl->statements);
 		}
 
 		nextToken();	
@@ -1381,9 +1582,9 @@ static struct GenericDecl parseGenericDecl(){
 
 	nextToken();
 	if(!validDataType()){
-		error(p->currToken.lineNumber, p->currToken.literal, "Expect valid data type");
+		error(p->currToken, "Expect valid data type");
 	}	
-	generic.dtype = parseDataType(p->currToken.literal);
+	generic.dtype = parseDataType(p->currToken);
 
 	nextToken();
 	if(match(TOKEN_VASSIGN)){
@@ -1403,15 +1604,15 @@ static struct PortDecl parsePortDecl(){
 
 	nextToken();
 	if(!match(TOKEN_INPUT) && !match(TOKEN_OUTPUT) && !match(TOKEN_INOUT)){
-		error(p->currToken.lineNumber, p->currToken.literal, "Expect valid port mode");
+		error(p->currToken, "Expect valid port mode");
 	}	
-	port.pmode = parsePortMode(p->currToken.literal);
+	port.pmode = parsePortMode(p->currToken);
 	
 	nextToken();
 	if(!validDataType()){
-		error(p->currToken.lineNumber, p->currToken.literal, "Expect valid data type");
+		error(p->currToken, "Expect valid data type");
 	}	
-	port.dtype = parseDataType(p->currToken.literal);
+	port.dtype = parseDataType(p->currToken);
 	
 	consumeNext(TOKEN_SCOLON, "Expect ; at end of port declaration");
 		
@@ -1421,31 +1622,33 @@ static struct PortDecl parsePortDecl(){
 static void parseEntityInterior(struct EntityDecl *eDecl){
 
 	nextToken();
-	uint16_t posInEntity = 1;
+	uint32_t posInEntity = 1;
 	
 	while(!match(TOKEN_RBRACE) && !match(TOKEN_EOP)){
-		struct Identifier* names = parseIdentifierList();
+		struct IdentifierList* names = parseIdentifierList();
 
 		if(thisIsAPort()) {
 			struct PortDecl port = parsePortDecl();	
-			port.name = names;
+			port.names = names;
 			port.position = posInEntity++;
 
 			if(eDecl->ports == NULL) {
-				eDecl->ports = InitBlockArray(sizeof(struct PortDecl)); 	
+				eDecl->ports = newBlockArray(sizeof(struct PortDecl)); 	
 			}
 
 			WriteBlockArray(eDecl->ports, (char*)(&port));
+			indexInterface(&(eDecl->interface), names, false, BlockCount(eDecl->ports) - 1);
 		} else {
 			struct GenericDecl generic = parseGenericDecl();	
-			generic.name = names;
+			generic.names = names;
 			generic.position = posInEntity++;
 
 			if(eDecl->generics == NULL) {
-				eDecl->generics = InitBlockArray(sizeof(struct GenericDecl)); 	
+				eDecl->generics = newBlockArray(sizeof(struct GenericDecl)); 	
 			}
 
 			WriteBlockArray(eDecl->generics, (char*)(&generic));
+			indexInterface(&(eDecl->interface), names, true, BlockCount(eDecl->generics) - 1);
 		}
 
 		nextToken();
@@ -1480,9 +1683,8 @@ static void parseUseStatement(struct UseStatement* stmt){
 
 	consumeNext(TOKEN_IDENTIFIER, "Expect use path after use keyword");
 	
-	int size = strlen(p->currToken.literal) + 1;
-	stmt->value = calloc(size, sizeof(char));
-	memcpy(stmt->value, p->currToken.literal, size);
+	int size = p->currToken.length + 1;
+	stmt->value = copyLiteral(p->currToken);
     
     // extract library (lop off '.' and add '\0')
     char* libEnd = stmt->value;
@@ -1490,7 +1692,7 @@ static void parseUseStatement(struct UseStatement* stmt){
     while(*libEnd != '.' && libLen <= size){
         libLen++; libEnd++;
     }
-	stmt->library = calloc(libLen, sizeof(char));
+	stmt->library = newNode(libLen);
 	memcpy(stmt->library, stmt->value, libLen-1);
     stmt->library[libLen-1] = '\0';
 	
@@ -1513,7 +1715,7 @@ static void parseLibraryUnit(struct LibraryUnit* libUnit){
 		}
 
 		default:
-			error(p->currToken.lineNumber, p->currToken.literal, "Expect valid library unit type");
+			error(p->currToken, "Expect valid library unit type");
 			break;
 	}
 }
@@ -1532,19 +1734,21 @@ static struct DesignUnit parseDesignUnit(){
 	return unit;
 }
 
-struct Program* ParseProgram(char* ventProgram){
-	// do some setup
-	InitLexer(ventProgram);
-	initParser();
+struct Program* parseProgram(){
+	primeTokens();
+
+	//every node of this program comes from its arena
+	p->arena = InitArena(0);
 
-	struct Program* prog = calloc(1, sizeof(struct Program));
+	struct Program* prog = newNode(sizeof(struct Program));
 	prog->self.type = AST_PROGRAM;
+	prog->arena = p->arena;
 
 	while(!endOfProgram() && thereAreDesignUnits()){
 		struct DesignUnit unit = parseDesignUnit();
 			
 		if(prog->units == NULL){
-			prog->units = InitBlockArray(sizeof(struct DesignUnit));	
+			prog->units = newBlockArray(sizeof(struct DesignUnit));	
 		}
 		WriteBlockArray(prog->units, (char*)(&unit));
 		nextToken();
@@ -1553,3 +1757,50 @@ struct Program* ParseProgram(char* ventProgram){
 	return prog;
 }
 
+struct Program* ParseVentProgram(VentParser* parser, const char* ventProgram, size_t length){
+	//split the file into top-level units and parse them side by side when asked to
+	if(parser->jobs > 1 && !parser->printTokenFlag){
+		struct Program* prog = parseUnitsInParallel(parser, ventProgram, length);
+		if(prog) return prog;
+	}
+
+	struct VentParser* outer = p;
+	p = parser;
+
+	// do some setup
+	initParser();
+
+	//the token stream can't hold offsets past 4 GiB, lex those as we go
+	if(p->preLexFlag) p->tokens = LexTokenStream(ventProgram, length);
+	if(p->tokens == NULL) p->lexer = InitVentLexer(ventProgram, length);
+
+	struct Program* prog = parseProgram();
+
+	p = outer;
+	return prog;
+}
+
+struct Program* ParseVentProgramFromFd(VentParser* parser, int fd){
+	struct VentParser* outer = p;
+	p = parser;
+
+	initParser();
+	p->lexer = InitVentStreamLexer(fd, 0);
+
+	struct Program* prog = parseProgram();
+
+	p = outer;
+	return prog;
+}
+
+struct Program* ParseProgramWithLength(const char* ventProgram, size_t length){
+	return ParseVentProgram(&defaultParser, ventProgram, length);
+}
+
+struct Program* ParseProgramFromFd(int fd){
+	return ParseVentProgramFromFd(&defaultParser, fd);
+}
+
+struct Program* ParseProgram(char* ventProgram){
+	return ParseProgramWithLength(ventProgram, strlen(ventProgram));
+}
@@ -1,10 +1,71 @@
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdio.h>
 
+#include <symbol.h>
+
 #include "error.h"
 #include "utils.h"
 
+void* newNode(size_t size){
+	return ArenaAlloc(p->arena, size);
+}
+
+char* copyLiteral(struct Token t){
+	return ArenaCopyString(p->arena, t.literal, t.length);
+}
+
+static void releaseBlockArray(void* arr){
+	FreeBlockArray((Dba*)arr);
+}
+
+Dba* newBlockArray(size_t bsize){
+	//the header and the first blocks come from the arena, so a small array costs no malloc
+	Dba* arr = InitBlockArrayInPlace(newNode(BlockArraySize(bsize)), bsize);
+
+	//a larger array grows on the heap, so free it along with the arena
+	if(arr && !ArenaOnRelease(p->arena, releaseBlockArray, arr)){
+		FreeBlockArray(arr);
+		arr = NULL;
+	}
+
+	return arr;
+}
+
+//a list block grows by doubling, once it holds LIST_MIN items it is full
+//whenever its count is a power of two, so no capacity has to be kept
+#define LIST_MIN 4
+
+static bool listIsFull(uint32_t count){
+	return count >= LIST_MIN && (count & (count - 1)) == 0;
+}
+
+//both list kinds are a count followed by pointers, the old block is left to the arena
+static void* growList(void* list, uint32_t count){
+	if(list != NULL && !listIsFull(count)) return list;
+
+	uint32_t capacity = count < LIST_MIN ? LIST_MIN : count * 2;
+	void* grown = newNode(offsetof(struct ExpressionList, items) + capacity * sizeof(void*));
+	if(grown && list) memcpy(grown, list, offsetof(struct ExpressionList, items) + count * sizeof(void*));
+
+	return grown;
+}
+
+struct ExpressionList* appendExpression(struct ExpressionList* list, struct Expression* expr){
+	list = growList(list, ExpressionCount(list));
+	if(list) list->items[list->count++] = expr;
+
+	return list;
+}
+
+struct IdentifierList* appendIdentifier(struct IdentifierList* list, struct Identifier* ident){
+	list = growList(list, list ? list->count : 0);
+	if(list) list->items[list->count++] = ident;
+
+	return list;
+}
+
 bool match(enum TOKEN_TYPE type){
 	return p->currToken.type == type;
 }
@@ -13,9 +74,13 @@ bool peek(enum TOKEN_TYPE type){
 	return p->peekToken.type == type;
 }
 
+bool peekAhead(int n, enum TOKEN_TYPE type){
+	return lookAhead(n).type == type;
+}
+
 void consume(enum TOKEN_TYPE type, const char* msg){
 	if(!match(type)){
-		error(p->currToken.lineNumber, p->currToken.literal, msg);
+		error(p->currToken, msg);
 		
 		// first check if next token is the one we expect
 		nextToken();
@@ -39,19 +104,6 @@ void consumeNext(enum TOKEN_TYPE type, const char* msg){
 	consume(type, msg);
 }
 
-struct Token copyToken(struct Token oldToken){
-	struct Token newToken = oldToken;
-
-	newToken.literal = calloc(1, sizeof(strlen(oldToken.literal)));
-	strncpy(newToken.literal,  oldToken.literal, sizeof(strlen(oldToken.literal)));
-
-	return newToken;
-}
-
-void destroyToken(struct Token thisToken){
-	free(thisToken.literal);
-}
-
 bool validDataType(){
 	bool valid = false; 
 	
@@ -64,7 +116,16 @@ bool validDataType(){
 }
 
 bool userDefinedDataType(){
-	return match(TOKEN_IDENTIFIER) && GetInHashTable(enumTypeTable, p->currToken.literal, NULL);
+	if(!match(TOKEN_IDENTIFIER)) return false;
+
+	//types are looked up by symbol, like components, so the spelling never needs a copy
+	uint32_t typeName = InternCachedSymbol(p->symbols, p->currToken.literal, p->currToken.length, NULL);
+	bool found = GetInSymbolMap(p->enumTypeTable, typeName, NULL);
+
+	//an earlier slice of the file may declare it, see parallel.c
+	if(!found && p->missedTypes) SetInSymbolMap(p->missedTypes, typeName, 1);
+
+	return found;
 }
 
 bool validAssignment(){
@@ -116,11 +177,17 @@ bool thisIsADeclaration(){
 }
 
 bool thisIsAPort(){
+	//skip over the rest of an identifier list to find the port mode
+	int n = 1;
+	while(peekAhead(n, TOKEN_COMMA) && peekAhead(n+1, TOKEN_IDENTIFIER)){
+		n += 2;
+	}
+
 	bool valid = false;
 
-	valid = 	peek(TOKEN_INPUT) ||
-				peek(TOKEN_OUTPUT) ||
-				peek(TOKEN_INOUT);
+	valid = 	peekAhead(n, TOKEN_INPUT) ||
+				peekAhead(n, TOKEN_OUTPUT) ||
+				peekAhead(n, TOKEN_INOUT);
 
 	return valid;
 }
@@ -129,58 +196,107 @@ bool thisIsAWildCard(struct Expression* map){
 	if(map->type == CHAR_EXPR){
 		struct CharExpr* charLit = (struct CharExpr*)map;
 		if(*(charLit->literal) == '*') {		
-
-			//trash the '*' char as we don't need it anymore
-			free(charLit->literal);
-			free(charLit);
-
+			//the '*' char is no longer needed, it goes away with the arena
 			return true;	
 		}
 	}
 	return false;
 }
 
-struct ComponentDecl* getComponentFromStore(char* cname){
-	struct ComponentDecl* thisComp = NULL;
-		
+void addComponentToStore(struct Declaration* decl){
+	WriteBlockArray(p->componentStore, (char*)decl);
+
+	//index by symbol, a later declaration of the same name wins
+	struct Identifier* name = decl->as.componentDeclaration.name;
+	if(name) SetInSymbolMap(p->componentIndex, name->symbol, BlockCount(p->componentStore) - 1);
+}
+
+//the pointer stays valid while later components are added, see initParser
+struct ComponentDecl* getComponentFromStore(uint32_t cname){
+	uint64_t index = 0;
+
 	//find the component corresponding to the instance
-	for(int i=0; i<BlockCount(componentStore); i++){
-		struct Declaration* decl = (struct Declaration*)ReadBlockArray(componentStore, i);
-		if(decl) {
-			struct ComponentDecl* comp = &(decl->as.componentDeclaration);
-			if(strncmp(comp->name->value, cname, sizeof(cname)) == 0){
-				thisComp = comp;
-			}
-		}
+	if(!GetInSymbolMap(p->componentIndex, cname, &index)) return NULL;
+
+	struct Declaration* decl = (struct Declaration*)ReadBlockArray(p->componentStore, index);
+	return decl ? &(decl->as.componentDeclaration) : NULL;
+}
+
+//a slot packs the index into ports or generics with a bit saying which one
+#define SLOT_GENERIC 1u
+#define makeSlot(index, isGeneric) (((uint32_t)(index) << 1) | ((isGeneric) ? SLOT_GENERIC : 0))
+
+static void releaseSymbolMap(void* map){
+	FreeSymbolMap((struct SymbolMap*)map);
+}
+
+void indexInterface(struct InterfaceIndex* idx, struct IdentifierList* names, bool isGeneric, uint32_t index){
+	if(idx->byName == NULL){
+		idx->byName = InitSymbolMap();
+		if(idx->byName) ArenaOnRelease(p->arena, releaseSymbolMap, idx->byName);
+		idx->byPosition = newBlockArray(sizeof(uint32_t));
 	}
 
-	return thisComp;
-}
-
-bool thisIsAGenericMap(struct Expression* map, struct Identifier* name, uint16_t pos){
-	struct DynamicBlockArray* generics = NULL;
-	struct ComponentDecl* comp = NULL;
-
-	comp = getComponentFromStore(name->value);
-	if(comp) generics = comp->generics;
-
-	if(generics){
-		for(int i=0; i<BlockCount(generics); i++){
-   		struct GenericDecl* generic = (struct GenericDecl*)ReadBlockArray(generics, i);
-			if(positionalMapping(map)){
-      		if(generic->position == pos){
-					return true;
-				}
-			} else if (associativeMapping(map)) {
-      		struct BinaryExpr* bexp = (struct BinaryExpr*)map;
-      		struct Identifier* left = (struct Identifier*)bexp->left;
-				if(strncmp(generic->name->value, left->value, sizeof(left->value)) == 0) {
-					return true;
-				}
-			} else {
-				printf("Error determining mapping! Map type == %d\r\n", map->type);
-			}    
-		}
+	//ports and generics share one position count, so this is the next position
+	uint32_t slot = makeSlot(index, isGeneric);
+	WriteBlockArray(idx->byPosition, (char*)(&slot));
+
+	//every name in a list maps to the same declaration
+	for(uint32_t i = 0; names && i < names->count; i++){
+		SetInSymbolMap(idx->byName, names->items[i]->symbol, slot);
+	}
+}
+
+static void* slotToDecl(struct ComponentDecl* comp, uint32_t slot, bool wantGeneric){
+	bool isGeneric = (slot & SLOT_GENERIC) != 0;
+	if(isGeneric != wantGeneric) return NULL;
+
+	Dba* decls = isGeneric ? comp->generics : comp->ports;
+	return decls ? ReadBlockArray(decls, slot >> 1) : NULL;
+}
+
+static void* declAtPosition(struct ComponentDecl* comp, uint32_t pos, bool wantGeneric){
+	if(comp == NULL || comp->interface.byPosition == NULL) return NULL;
+	if(pos < 1 || pos > (uint32_t)BlockCount(comp->interface.byPosition)) return NULL;
+
+	uint32_t slot = *(uint32_t*)ReadBlockArray(comp->interface.byPosition, pos - 1);
+	return slotToDecl(comp, slot, wantGeneric);
+}
+
+static void* declNamed(struct ComponentDecl* comp, uint32_t symbol, bool wantGeneric){
+	if(comp == NULL || comp->interface.byName == NULL) return NULL;
+
+	uint64_t slot = 0;
+	if(!GetInSymbolMap(comp->interface.byName, symbol, &slot)) return NULL;
+
+	return slotToDecl(comp, (uint32_t)slot, wantGeneric);
+}
+
+struct PortDecl* portAtPosition(struct ComponentDecl* comp, uint32_t pos){
+	return (struct PortDecl*)declAtPosition(comp, pos, false);
+}
+
+struct PortDecl* portNamed(struct ComponentDecl* comp, uint32_t symbol){
+	return (struct PortDecl*)declNamed(comp, symbol, false);
+}
+
+struct GenericDecl* genericAtPosition(struct ComponentDecl* comp, uint32_t pos){
+	return (struct GenericDecl*)declAtPosition(comp, pos, true);
+}
+
+struct GenericDecl* genericNamed(struct ComponentDecl* comp, uint32_t symbol){
+	return (struct GenericDecl*)declNamed(comp, symbol, true);
+}
+
+bool thisIsAGenericMap(struct Expression* map, struct ComponentDecl* comp, uint32_t pos){
+	if(positionalMapping(map)){
+		return genericAtPosition(comp, pos) != NULL;
+	} else if (associativeMapping(map)) {
+		struct BinaryExpr* bexp = (struct BinaryExpr*)map;
+		struct Identifier* left = (struct Identifier*)bexp->left;
+		return genericNamed(comp, left->symbol) != NULL;
+	} else if(comp && comp->generics) {
+		mappingError(map->type);
 	}
 
 	return false;
@@ -0,0 +1,349 @@
+/*
+	scan.c
+
+	This file contains the character class table and the run scanners
+	the lexer uses to step over whitespace, identifiers and comments.
+	The scalar scanners work everywhere, the SSE2 and AVX2 scanners are
+	only built for x86 and only handed out when the CPU supports them.
+	--
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <scan.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_X86_SCANNERS
+#include <immintrin.h>
+#endif
+
+const uint8_t CharClassTable[256] = {
+	['\0']		= CC_DELIM,
+	['\t']		= CC_SPACE,
+	['\n']		= CC_NEWLINE | CC_DELIM,
+	['\r']		= CC_SPACE,
+	[' ']			= CC_SPACE | CC_DELIM,
+
+	//everything that can't appear in an identifier
+	['!']			= CC_DELIM,	['"']			= CC_DELIM,	['&']			= CC_DELIM,
+	['\'']		= CC_DELIM,	['(']			= CC_DELIM,	[')']			= CC_DELIM,
+	['*']			= CC_DELIM,	['+']			= CC_DELIM,	[',']			= CC_DELIM,
+	['-']			= CC_DELIM,	['/']			= CC_DELIM,	[':']			= CC_DELIM,
+	[';']			= CC_DELIM,	['<']			= CC_DELIM,	['=']			= CC_DELIM,
+	['>']			= CC_DELIM,	['?']			= CC_DELIM,	['@']			= CC_DELIM,
+	['`']			= CC_DELIM,	['{']			= CC_DELIM,	['}']			= CC_DELIM,
+	['~']			= CC_DELIM,
+
+	['0' ... '9']	= CC_DIGIT,
+	['a' ... 'z']	= CC_LETTER,
+	['A' ... 'Z']	= CC_LETTER,
+	['_']				= CC_LETTER,
+};
+
+// scalar scanners
+
+static size_t scalarSkipSpace(const char* s, size_t n, int* newlines){
+	size_t i = 0;
+
+	while(i < n && CharHasClass(s[i], CC_SPACE | CC_NEWLINE)){
+		if(s[i] == '\n') (*newlines)++;
+		i++;
+	}
+
+	return i;
+}
+
+static size_t scalarSkipIdentifier(const char* s, size_t n){
+	size_t i = 0;
+
+	while(i < n && !CharHasClass(s[i], CC_DELIM)){
+		i++;
+	}
+
+	return i;
+}
+
+static size_t scalarSkipUntil(const char* s, size_t n, char stop, int* newlines){
+	size_t i = 0;
+
+	while(i < n && s[i] != stop && s[i] != '\0'){
+		if(s[i] == '\n') (*newlines)++;
+		i++;
+	}
+
+	return i;
+}
+
+static const struct RunScanner scalarScanner = {
+	.name 				= "scalar",
+	.skipSpace			= scalarSkipSpace,
+	.skipIdentifier	= scalarSkipIdentifier,
+	.skipUntil			= scalarSkipUntil,
+};
+
+#ifdef HAVE_X86_SCANNERS
+
+/*
+	All of the vector scanners work the same way: build a bitmask with
+	one bit per byte saying whether the byte belongs to the run, and stop
+	at the first zero bit. Whole blocks are only loaded while they fit
+	inside the buffer, the scalar scanner finishes off the tail.
+
+	Most runs in real source are only a few chars long, so the first
+	SCALAR_PREFIX chars are checked one at a time and the vector loop
+	only starts once a run turns out to be longer than that.
+*/
+#define SCALAR_PREFIX 8
+#define PREFIX_LEN(n) ((n) < SCALAR_PREFIX ? (n) : SCALAR_PREFIX)
+
+// SSE2 scanners
+
+__attribute__((target("sse2")))
+static size_t sse2SkipSpace(const char* s, size_t n, int* newlines){
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tab = _mm_set1_epi8('\t');
+	const __m128i cr = _mm_set1_epi8('\r');
+	const __m128i nl = _mm_set1_epi8('\n');
+
+	size_t i = scalarSkipSpace(s, PREFIX_LEN(n), newlines);
+	if(i < PREFIX_LEN(n)) return i;
+
+	for(; i + 16 <= n; i += 16){
+		__m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+		__m128i isNewline = _mm_cmpeq_epi8(v, nl);
+		__m128i isSpace = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+			_mm_or_si128(_mm_cmpeq_epi8(v, cr), isNewline));
+
+		unsigned int inRun = (unsigned int)_mm_movemask_epi8(isSpace);
+		unsigned int newlineBits = (unsigned int)_mm_movemask_epi8(isNewline);
+
+		if(inRun != 0xFFFF){
+			unsigned int run = __builtin_ctz(~inRun);
+			*newlines += __builtin_popcount(newlineBits & ((1u << run) - 1));
+			return i + run;
+		}
+		*newlines += __builtin_popcount(newlineBits);
+	}
+
+	return i + scalarSkipSpace(s + i, n - i, newlines);
+}
+
+__attribute__((target("sse2")))
+static size_t sse2SkipIdentifier(const char* s, size_t n){
+	//most delimiters sit in two ranges, 0x20-0x2F and 0x3A-0x40
+	const __m128i below20 = _mm_set1_epi8(0x1F);
+	const __m128i above2F = _mm_set1_epi8(0x30);
+	const __m128i below3A = _mm_set1_epi8(0x39);
+	const __m128i above40 = _mm_set1_epi8(0x41);
+
+	size_t i = scalarSkipIdentifier(s, PREFIX_LEN(n));
+	if(i < PREFIX_LEN(n)) return i;
+
+	for(; i + 16 <= n; i += 16){
+		__m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+
+		__m128i lowRange = _mm_and_si128(_mm_cmpgt_epi8(v, below20), _mm_cmpgt_epi8(above2F, v));
+		__m128i allowed = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('#')), _mm_cmpeq_epi8(v, _mm_set1_epi8('$'))),
+			_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('%')), _mm_cmpeq_epi8(v, _mm_set1_epi8('.'))));
+		lowRange = _mm_andnot_si128(allowed, lowRange);
+
+		__m128i highRange = _mm_and_si128(_mm_cmpgt_epi8(v, below3A), _mm_cmpgt_epi8(above40, v));
+
+		__m128i others = _mm_or_si128(
+			_mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(v, _mm_setzero_si128()), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))),
+				_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('`')), _mm_cmpeq_epi8(v, _mm_set1_epi8('~')))),
+			_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('{')), _mm_cmpeq_epi8(v, _mm_set1_epi8('}'))));
+
+		__m128i isDelim = _mm_or_si128(_mm_or_si128(lowRange, highRange), others);
+		unsigned int delims = (unsigned int)_mm_movemask_epi8(isDelim);
+
+		if(delims != 0){
+			return i + __builtin_ctz(delims);
+		}
+	}
+
+	return i + scalarSkipIdentifier(s + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static size_t sse2SkipUntil(const char* s, size_t n, char stop, int* newlines){
+	const __m128i stopChar = _mm_set1_epi8(stop);
+	const __m128i nul = _mm_setzero_si128();
+	const __m128i nl = _mm_set1_epi8('\n');
+
+	size_t i = scalarSkipUntil(s, PREFIX_LEN(n), stop, newlines);
+	if(i < PREFIX_LEN(n)) return i;
+
+	for(; i + 16 <= n; i += 16){
+		__m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+		__m128i isStop = _mm_or_si128(_mm_cmpeq_epi8(v, stopChar), _mm_cmpeq_epi8(v, nul));
+
+		unsigned int stops = (unsigned int)_mm_movemask_epi8(isStop);
+		unsigned int newlineBits = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl));
+
+		if(stops != 0){
+			unsigned int run = __builtin_ctz(stops);
+			*newlines += __builtin_popcount(newlineBits & ((1u << run) - 1));
+			return i + run;
+		}
+		*newlines += __builtin_popcount(newlineBits);
+	}
+
+	return i + scalarSkipUntil(s + i, n - i, stop, newlines);
+}
+
+static const struct RunScanner sse2Scanner = {
+	.name 				= "sse2",
+	.skipSpace			= sse2SkipSpace,
+	.skipIdentifier	= sse2SkipIdentifier,
+	.skipUntil			= sse2SkipUntil,
+};
+
+// AVX2 scanners
+
+__attribute__((target("avx2")))
+static size_t avx2SkipSpace(const char* s, size_t n, int* newlines){
+	const __m256i space = _mm256_set1_epi8(' ');
+	const __m256i tab = _mm256_set1_epi8('\t');
+	const __m256i cr = _mm256_set1_epi8('\r');
+	const __m256i nl = _mm256_set1_epi8('\n');
+
+	size_t i = scalarSkipSpace(s, PREFIX_LEN(n), newlines);
+	if(i < PREFIX_LEN(n)) return i;
+
+	for(; i + 32 <= n; i += 32){
+		__m256i v = _mm256_loadu_si256((const __m256i*)(s + i));
+		__m256i isNewline = _mm256_cmpeq_epi8(v, nl);
+		__m256i isSpace = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, cr), isNewline));
+
+		uint32_t inRun = (uint32_t)_mm256_movemask_epi8(isSpace);
+		uint32_t newlineBits = (uint32_t)_mm256_movemask_epi8(isNewline);
+
+		if(inRun != 0xFFFFFFFF){
+			unsigned int run = __builtin_ctz(~inRun);
+			*newlines += __builtin_popcount(newlineBits & ((1u << run) - 1));
+			return i + run;
+		}
+		*newlines += __builtin_popcount(newlineBits);
+	}
+
+	return i + sse2SkipSpace(s + i, n - i, newlines);
+}
+
+/*
+	Identifier delimiters are found with a nibble lookup. Every delimiter
+	is below 0x80, so each possible high nibble (0-7) gets its own bit and
+	delimLowNibbles[lo] holds the bits of every high nibble that forms a
+	delimiter with that low nibble. A byte is a delimiter when the lookups
+	for its two nibbles share a bit. Bytes >= 0x80 look up a 0 high mask.
+*/
+static const int8_t delimLowNibbles[16] = {
+	0x55, 0x04, 0x04, 0x00, 0x00, 0x00, 0x04, 0x04,
+	0x04, 0x04, 0x0d, (int8_t)0x8c, 0x0c, (int8_t)0x8c, (int8_t)0x88, 0x0c,
+};
+
+static const int8_t delimHighNibbles[16] = {
+	0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (int8_t)0x80,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+__attribute__((target("avx2")))
+static size_t avx2SkipIdentifier(const char* s, size_t n){
+	const __m128i low128 = _mm_loadu_si128((const __m128i*)delimLowNibbles);
+	const __m128i high128 = _mm_loadu_si128((const __m128i*)delimHighNibbles);
+	const __m256i lowTable = _mm256_broadcastsi128_si256(low128);
+	const __m256i highTable = _mm256_broadcastsi128_si256(high128);
+	const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+
+	size_t i = scalarSkipIdentifier(s, PREFIX_LEN(n));
+	if(i < PREFIX_LEN(n)) return i;
+
+	for(; i + 32 <= n; i += 32){
+		__m256i v = _mm256_loadu_si256((const __m256i*)(s + i));
+
+		__m256i lo = _mm256_and_si256(v, nibbleMask);
+		__m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibbleMask);
+		__m256i hits = _mm256_and_si256(_mm256_shuffle_epi8(lowTable, lo), _mm256_shuffle_epi8(highTable, hi));
+
+		__m256i notDelim = _mm256_cmpeq_epi8(hits, _mm256_setzero_si256());
+		uint32_t identChars = (uint32_t)_mm256_movemask_epi8(notDelim);
+
+		if(identChars != 0xFFFFFFFF){
+			return i + __builtin_ctz(~identChars);
+		}
+	}
+
+	return i + sse2SkipIdentifier(s + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static size_t avx2SkipUntil(const char* s, size_t n, char stop, int* newlines){
+	const __m256i stopChar = _mm256_set1_epi8(stop);
+	const __m256i nul = _mm256_setzero_si256();
+	const __m256i nl = _mm256_set1_epi8('\n');
+
+	size_t i = scalarSkipUntil(s, PREFIX_LEN(n), stop, newlines);
+	if(i < PREFIX_LEN(n)) return i;
+
+	for(; i + 32 <= n; i += 32){
+		__m256i v = _mm256_loadu_si256((const __m256i*)(s + i));
+		__m256i isStop = _mm256_or_si256(_mm256_cmpeq_epi8(v, stopChar), _mm256_cmpeq_epi8(v, nul));
+
+		uint32_t stops = (uint32_t)_mm256_movemask_epi8(isStop);
+		uint32_t newlineBits = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl));
+
+		if(stops != 0){
+			unsigned int run = __builtin_ctz(stops);
+			*newlines += __builtin_popcount(newlineBits & ((1u << run) - 1));
+			return i + run;
+		}
+		*newlines += __builtin_popcount(newlineBits);
+	}
+
+	return i + sse2SkipUntil(s + i, n - i, stop, newlines);
+}
+
+static const struct RunScanner avx2Scanner = {
+	.name 				= "avx2",
+	.skipSpace			= avx2SkipSpace,
+	.skipIdentifier	= avx2SkipIdentifier,
+	.skipUntil			= avx2SkipUntil,
+};
+
+#endif // HAVE_X86_SCANNERS
+
+// public interface
+
+const struct RunScanner* GetRunScanner(enum ScanLevel level){
+	switch(level){
+		case SCAN_SCALAR:
+			return &scalarScanner;
+
+#ifdef HAVE_X86_SCANNERS
+		case SCAN_SSE2:
+			return __builtin_cpu_supports("sse2") ? &sse2Scanner : NULL;
+
+		case SCAN_AVX2:
+			return __builtin_cpu_supports("avx2") ? &avx2Scanner : NULL;
+#endif
+
+		default:
+			return NULL;
+	}
+}
+
+const struct RunScanner* SelectRunScanner(void){
+	const struct RunScanner* scanner = NULL;
+
+	for(int level = SCAN_AVX2; level >= SCAN_SCALAR && scanner == NULL; level--){
+		scanner = GetRunScanner(level);
+	}
+
+	return scanner;
+}
@@ -0,0 +1,426 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include <symbol.h>
+#include <dba.h>
+
+//interned strings are packed into chunks of this size, longer names get a chunk of their own
+#define NAME_CHUNK_SIZE (16 * 1024)
+
+//names shorter than this are case-folded on the stack
+#define FOLD_BUFFER_SIZE 256
+
+struct nameChunk {
+	struct nameChunk* next;
+	size_t used;
+	size_t capacity;
+	char text[];
+};
+
+struct internEntry {
+	const char* text;
+	uint32_t length;
+	uint32_t hash;
+	uint32_t symbol;
+};
+
+//open addressing over a dense entry array, a slot holds an entry index + 1 (0 == empty)
+struct internTable {
+	struct internEntry* entries;
+	uint32_t count;
+	uint32_t capacity;
+
+	uint32_t* slots;
+	uint32_t slotCount;
+};
+
+//the mutex only guards interning, names are read without it: the name of
+//symbol i+1 is block i of a segmented array, whose blocks never move, and
+//published is only raised once that block is written
+struct symbolTable {
+	pthread_mutex_t lock;
+	struct internTable symbols;	//case-folded names, entry i is symbol i+1
+	struct internTable spellings;	//names exactly as written, each knows its symbol
+	struct nameChunk* chunks;
+
+	Dba* names;
+	uint32_t published;
+};
+
+//spellings a parser has already interned, looked up without the lock
+struct SymbolCache {
+	struct internTable spellings;
+};
+
+//open addressing keyed by the symbol itself, NO_SYMBOL marks an empty entry
+struct mapEntry {
+	uint32_t symbol;
+	uint64_t value;
+};
+
+struct SymbolMap {
+	struct mapEntry* entries;
+	uint32_t count;
+	uint32_t capacity;
+};
+
+static struct symbolTable table = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static const uint32_t FNV_OFFSET_BASIS = 2166136261u;
+static const uint32_t FNV_PRIME = 16777619u;
+
+static uint32_t hashName(const char* text, size_t length){
+	uint32_t hash = FNV_OFFSET_BASIS;
+
+	for(size_t i=0; i<length; i++){
+		hash ^= (unsigned char)text[i];
+		hash *= FNV_PRIME;
+	}
+
+	return hash;
+}
+
+static void foldName(char* dest, const char* text, size_t length){
+	for(size_t i=0; i<length; i++){
+		char c = text[i];
+		dest[i] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+	}
+}
+
+static const char* storeName(const char* text, size_t length){
+	struct nameChunk* chunk = table.chunks;
+
+	if(chunk == NULL || chunk->capacity - chunk->used < length + 1){
+		size_t capacity = length + 1 > NAME_CHUNK_SIZE ? length + 1 : NAME_CHUNK_SIZE;
+		chunk = malloc(sizeof(struct nameChunk) + capacity);
+		if(chunk == NULL){
+			printf("Error: Unable to allocate symbol storage\r\n");
+			return NULL;
+		}
+
+		chunk->used = 0;
+		chunk->capacity = capacity;
+		chunk->next = table.chunks;
+		table.chunks = chunk;
+	}
+
+	char* name = chunk->text + chunk->used;
+	memcpy(name, text, length);
+	name[length] = '\0';
+	chunk->used += length + 1;
+
+	return name;
+}
+
+static uint32_t* findSlot(struct internTable* t, const char* text, uint32_t length, uint32_t hash){
+	uint32_t mask = t->slotCount - 1;
+	uint32_t index = hash & mask;
+
+	for(;;){
+		uint32_t* slot = &t->slots[index];
+		if(*slot == 0) return slot;
+
+		struct internEntry* entry = &t->entries[*slot - 1];
+		if(entry->hash == hash && entry->length == length && memcmp(entry->text, text, length) == 0){
+			return slot;
+		}
+
+		index = (index + 1) & mask;
+	}
+}
+
+static bool growSlots(struct internTable* t){
+	uint32_t slotCount = t->slotCount < 64 ? 64 : t->slotCount * 2;
+	uint32_t* slots = calloc(slotCount, sizeof(uint32_t));
+	if(slots == NULL) return false;
+
+	//every entry already has its hash, so rehashing never touches the strings
+	uint32_t mask = slotCount - 1;
+	for(uint32_t i=0; i<t->count; i++){
+		uint32_t index = t->entries[i].hash & mask;
+		while(slots[index] != 0) index = (index + 1) & mask;
+		slots[index] = i + 1;
+	}
+
+	free(t->slots);
+	t->slots = slots;
+	t->slotCount = slotCount;
+
+	return true;
+}
+
+static struct internEntry* lookupEntry(struct internTable* t, const char* text, uint32_t length, uint32_t hash){
+	if(t->count == 0) return NULL;
+
+	uint32_t* slot = findSlot(t, text, length, hash);
+	return *slot != 0 ? &t->entries[*slot - 1] : NULL;
+}
+
+static struct internEntry* addEntry(struct internTable* t, const char* text, uint32_t length, uint32_t hash){
+	//keep the load factor at or below one half
+	if((t->count + 1) * 2 > t->slotCount && !growSlots(t)) return NULL;
+
+	if(t->count == t->capacity){
+		uint32_t capacity = t->capacity < 64 ? 64 : t->capacity * 2;
+		struct internEntry* entries = realloc(t->entries, capacity * sizeof(struct internEntry));
+		if(entries == NULL) return NULL;
+
+		t->entries = entries;
+		t->capacity = capacity;
+	}
+
+	struct internEntry* entry = &t->entries[t->count++];
+	entry->text = text;
+	entry->length = length;
+	entry->hash = hash;
+	entry->symbol = t->count;
+
+	*findSlot(t, text, length, hash) = t->count;
+	return entry;
+}
+
+static struct mapEntry* findMapEntry(struct SymbolMap* map, uint32_t symbol){
+	//multiplying by an odd constant spreads consecutive IDs over the whole table
+	uint32_t mask = map->capacity - 1;
+	uint32_t index = (symbol * 2654435761u) & mask;
+
+	while(map->entries[index].symbol != NO_SYMBOL && map->entries[index].symbol != symbol){
+		index = (index + 1) & mask;
+	}
+
+	return &map->entries[index];
+}
+
+static bool growMap(struct SymbolMap* map){
+	struct SymbolMap grown = {0};
+	grown.capacity = map->capacity < 8 ? 8 : map->capacity * 2;
+	grown.entries = calloc(grown.capacity, sizeof(struct mapEntry));
+	if(grown.entries == NULL) return false;
+
+	for(uint32_t i = 0; i < map->capacity; i++){
+		if(map->entries[i].symbol != NO_SYMBOL) *findMapEntry(&grown, map->entries[i].symbol) = map->entries[i];
+	}
+
+	free(map->entries);
+	map->entries = grown.entries;
+	map->capacity = grown.capacity;
+
+	return true;
+}
+
+static void freeInternTable(struct internTable* t){
+	free(t->entries);
+	free(t->slots);
+	memset(t, 0, sizeof(struct internTable));
+}
+
+//called with the lock held for a name that has no symbol yet
+static struct internEntry* publishName(const char* name, uint32_t length, uint32_t hash){
+	if(table.names == NULL) table.names = InitSegmentedBlockArray(sizeof(const char*));
+	if(table.names == NULL) return NULL;
+
+	struct internEntry* symbol = addEntry(&table.symbols, name, length, hash);
+	if(symbol){
+		WriteBlockArray(table.names, (char*)&name);
+		__atomic_store_n(&table.published, symbol->symbol, __ATOMIC_RELEASE);
+	}
+
+	return symbol;
+}
+
+//called with the lock held when the spelling has never been seen
+static struct internEntry* internSpelling(const char* text, uint32_t length, uint32_t hash){
+	char buffer[FOLD_BUFFER_SIZE];
+	char* folded = length <= FOLD_BUFFER_SIZE ? buffer : malloc(length);
+	if(folded == NULL) return NULL;
+
+	foldName(folded, text, length);
+	bool alreadyFolded = memcmp(folded, text, length) == 0;
+	uint32_t foldedHash = alreadyFolded ? hash : hashName(folded, length);
+
+	struct internEntry* spelling = NULL;
+	struct internEntry* symbol = lookupEntry(&table.symbols, folded, length, foldedHash);
+	if(symbol == NULL){
+		const char* name = storeName(folded, length);
+		if(name) symbol = publishName(name, length, foldedHash);
+	}
+
+	if(symbol){
+		//a lowercase spelling is the symbol name itself, no need to keep it twice
+		uint32_t id = symbol->symbol;
+		const char* name = alreadyFolded ? symbol->text : storeName(text, length);
+		if(name) spelling = addEntry(&table.spellings, name, length, hash);
+		if(spelling) spelling->symbol = id;
+	}
+
+	if(folded != buffer) free(folded);
+	return spelling;
+}
+
+static uint32_t internHashed(const char* text, uint32_t length, uint32_t hash, const char** spelling){
+	pthread_mutex_lock(&table.lock);
+
+	struct internEntry* entry = lookupEntry(&table.spellings, text, length, hash);
+	if(entry == NULL) entry = internSpelling(text, length, hash);
+
+	uint32_t symbol = NO_SYMBOL;
+	if(entry){
+		symbol = entry->symbol;
+		if(spelling != NULL) *spelling = entry->text;
+	} else {
+		printf("Error: Unable to intern symbol\r\n");
+	}
+
+	pthread_mutex_unlock(&table.lock);
+
+	return symbol;
+}
+
+// public interface
+
+uint32_t InternSymbol(const char* text, size_t length, const char** spelling){
+	if(spelling != NULL) *spelling = NULL;
+	if(text == NULL || length == 0 || length > UINT32_MAX) return NO_SYMBOL;
+
+	return internHashed(text, length, hashName(text, length), spelling);
+}
+
+struct SymbolCache* InitSymbolCache(void){
+	struct SymbolCache* cache = calloc(1, sizeof(struct SymbolCache));
+	if(cache == NULL){
+		printf("Error: Unable to allocate symbol cache\r\n");
+	}
+
+	return cache;
+}
+
+void FreeSymbolCache(struct SymbolCache* cache){
+	if(cache == NULL) return;
+
+	freeInternTable(&cache->spellings);
+	free(cache);
+}
+
+uint32_t InternCachedSymbol(struct SymbolCache* cache, const char* text, size_t length, const char** spelling){
+	if(cache == NULL) return InternSymbol(text, length, spelling);
+
+	if(spelling != NULL) *spelling = NULL;
+	if(text == NULL || length == 0 || length > UINT32_MAX) return NO_SYMBOL;
+
+	uint32_t hash = hashName(text, length);
+
+	struct internEntry* entry = lookupEntry(&cache->spellings, text, length, hash);
+	if(entry){
+		if(spelling != NULL) *spelling = entry->text;
+		return entry->symbol;
+	}
+
+	//first time this cache sees the spelling, the cache keeps the interned copy
+	const char* interned = NULL;
+	uint32_t symbol = internHashed(text, length, hash, &interned);
+	if(symbol != NO_SYMBOL){
+		entry = addEntry(&cache->spellings, interned, length, hash);
+		if(entry) entry->symbol = symbol;
+	}
+
+	if(spelling != NULL) *spelling = interned;
+	return symbol;
+}
+
+struct SymbolMap* InitSymbolMap(void){
+	struct SymbolMap* map = calloc(1, sizeof(struct SymbolMap));
+	if(map == NULL){
+		printf("Error: Unable to allocate symbol map\r\n");
+	}
+
+	return map;
+}
+
+void FreeSymbolMap(struct SymbolMap* map){
+	if(map == NULL) return;
+
+	free(map->entries);
+	free(map);
+}
+
+bool SetInSymbolMap(struct SymbolMap* map, uint32_t symbol, uint64_t val){
+	if(map == NULL || symbol == NO_SYMBOL) return false;
+
+	//keep the load factor at or below one half
+	if((map->count + 1) * 2 > map->capacity && !growMap(map)) return false;
+
+	struct mapEntry* entry = findMapEntry(map, symbol);
+	bool isNew = entry->symbol == NO_SYMBOL;
+	if(isNew){
+		entry->symbol = symbol;
+		map->count++;
+	}
+	entry->value = val;
+
+	return isNew;
+}
+
+bool GetInSymbolMap(struct SymbolMap* map, uint32_t symbol, uint64_t* val){
+	if(map == NULL || map->count == 0 || symbol == NO_SYMBOL) return false;
+
+	struct mapEntry* entry = findMapEntry(map, symbol);
+	if(entry->symbol == NO_SYMBOL) return false;
+
+	if(val != NULL) *val = entry->value;
+	return true;
+}
+
+uint32_t SymbolMapCount(struct SymbolMap* map){
+	return map ? map->count : 0;
+}
+
+bool NextInSymbolMap(struct SymbolMap* map, uint32_t* cursor, uint32_t* symbol, uint64_t* val){
+	if(map == NULL) return false;
+
+	for(uint32_t i = *cursor; i < map->capacity; i++){
+		if(map->entries[i].symbol == NO_SYMBOL) continue;
+
+		*cursor = i + 1;
+		if(symbol != NULL) *symbol = map->entries[i].symbol;
+		if(val != NULL) *val = map->entries[i].value;
+		return true;
+	}
+
+	*cursor = map->capacity;
+	return false;
+}
+
+const char* SymbolName(uint32_t symbol){
+	uint32_t published = __atomic_load_n(&table.published, __ATOMIC_ACQUIRE);
+	if(symbol == NO_SYMBOL || symbol > published) return NULL;
+
+	return *(const char**)BlockAt(table.names, symbol - 1);
+}
+
+uint32_t SymbolCount(void){
+	return __atomic_load_n(&table.published, __ATOMIC_ACQUIRE);
+}
+
+void FreeSymbolTable(void){
+	pthread_mutex_lock(&table.lock);
+
+	__atomic_store_n(&table.published, 0, __ATOMIC_RELEASE);
+	if(table.names) FreeBlockArray(table.names);
+	table.names = NULL;
+
+	freeInternTable(&table.symbols);
+	freeInternTable(&table.spellings);
+
+	struct nameChunk* chunk = table.chunks;
+	while(chunk != NULL){
+		struct nameChunk* next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+	table.chunks = NULL;
+
+	pthread_mutex_unlock(&table.lock);
+}
@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cutest.h"
+#include "arena.h"
+
+void TestArena_AllocIsZeroedAndAligned(CuTest* tc){
+	struct Arena* arena = InitArena(0);
+
+	for(size_t size = 1; size < 200; size += 7){
+		unsigned char* mem = ArenaAlloc(arena, size);
+		CuAssertPtrNotNull(tc, mem);
+		CuAssertIntEquals(tc, 0, (uintptr_t)mem % _Alignof(max_align_t));
+
+		for(size_t i = 0; i < size; i++){
+			CuAssertIntEquals(tc, 0, mem[i]);
+		}
+		memset(mem, 0xAB, size);
+	}
+
+	FreeArena(arena);
+}
+
+void TestArena_GrowsInFewChunks(CuTest* tc){
+	struct Arena* arena = InitArena(64);
+
+	//a mix of small nodes and one allocation bigger than any chunk so far
+	for(int i = 0; i < 10000; i++){
+		int* node = ArenaAlloc(arena, 24);
+		*node = i;
+	}
+	char* big = ArenaAlloc(arena, 100000);
+	big[99999] = 'x';
+
+	CuAssertTrue(tc, ArenaBytesUsed(arena) >= 10000 * 24 + 100000);
+	CuAssertTrue(tc, ArenaChunkCount(arena) < 20);
+
+	FreeArena(arena);
+}
+
+void TestArena_CopyString(CuTest* tc){
+	struct Arena* arena = InitArena(0);
+
+	const char* source = "sig counter : stl;";
+	char* copy = ArenaCopyString(arena, source + 4, 7);
+
+	CuAssertStrEquals(tc, "counter", copy);
+	CuAssertTrue(tc, copy != source + 4);
+
+	FreeArena(arena);
+}
+
+static int releaseOrder[4];
+static int releaseCount;
+
+static void recordRelease(void* ptr){
+	releaseOrder[releaseCount++] = *(int*)ptr;
+}
+
+void TestArena_ReleaseHooksRunNewestFirst(CuTest* tc){
+	static int ids[3] = {1, 2, 3};
+	struct Arena* arena = InitArena(0);
+	releaseCount = 0;
+
+	for(int i = 0; i < 3; i++){
+		CuAssertTrue(tc, ArenaOnRelease(arena, recordRelease, &ids[i]));
+	}
+	CuAssertIntEquals(tc, 0, releaseCount);
+
+	FreeArena(arena);
+
+	CuAssertIntEquals(tc, 3, releaseCount);
+	CuAssertIntEquals(tc, 3, releaseOrder[0]);
+	CuAssertIntEquals(tc, 2, releaseOrder[1]);
+	CuAssertIntEquals(tc, 1, releaseOrder[2]);
+
+	//freeing nothing is fine
+	FreeArena(NULL);
+	CuAssertPtrEquals(tc, NULL, ArenaAlloc(NULL, 8));
+}
+
+CuSuite* ArenaTestGetSuite(){
+	CuSuite* suite = CuSuiteNew();
+
+	SUITE_ADD_TEST(suite, TestArena_AllocIsZeroedAndAligned);
+	SUITE_ADD_TEST(suite, TestArena_GrowsInFewChunks);
+	SUITE_ADD_TEST(suite, TestArena_CopyString);
+	SUITE_ADD_TEST(suite, TestArena_ReleaseHooksRunNewestFirst);
+
+	return suite;
+}
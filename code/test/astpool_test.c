@@ -0,0 +1,420 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <parser.h>
+#include <emitter.h>
+#include <astpool.h>
+#include <ast.h>
+#include <dba.h>
+
+#include "cutest.h"
+
+static const char* poolProgram = " \
+	use ieee.std_logic_1164.all;\n \
+	\n \
+	ent pooled {\n \
+		WIDTH int := 8;\n \
+		clk -> stl;\n \
+		rst -> stl;\n \
+		q <- stlv(WIDTH-1 downto 0);\n \
+	}\n \
+	\n \
+	arch behavioral(pooled){\n \
+		type state_t {Idle, Run, Done};\n \
+		sig state state_t;\n \
+		sig count int := 0;\n \
+		sig q stlv(7 downto 0);\n \
+		\n \
+		comp counter {\n \
+			SIZE int := 64;\n \
+			clk -> stl;\n \
+			rst -> stl;\n \
+			Q <- stlv(3 downto 0);\n \
+		}\n \
+		\n \
+		C1: counter map(8, clk, rst, q);\n \
+		C2: counter map (*);\n \
+		\n \
+		proc(clk, rst) {\n \
+			var i int := 0;\n \
+			if(rst == '0'){\n \
+				count <= 0;\n \
+			} elsif(clk'UP){\n \
+				switch(state) {\n \
+					case Idle:\n \
+						state <= Run;\n \
+					case Run:\n \
+						count <= count + 1;\n \
+					default:\n \
+						null;\n \
+				}\n \
+			} else {\n \
+				for (j : 0 to 5) {\n \
+					assert (j != 10) report \"j out of bounds\" severity error;\n \
+				}\n \
+				while(i < 10){\n \
+					i := i + 2;\n \
+				}\n \
+				loop {\n \
+					i += 1;\n \
+					i--;\n \
+				}\n \
+				report \"done\" severity note;\n \
+			}\n \
+		}\n \
+		\n \
+		q <= not q;\n \
+	}\n \
+";
+
+static char* transpileToString(struct Program* prog){
+	TranspileProgram(prog, NULL);
+
+	FILE* vhdl = fopen("./a.vhdl", "r");
+	if(vhdl == NULL) return NULL;
+
+	fseek(vhdl, 0, SEEK_END);
+	long length = ftell(vhdl);
+	fseek(vhdl, 0, SEEK_SET);
+
+	char* text = calloc(1, length + 1);
+	if(fread(text, 1, length, vhdl) != (size_t)length){
+		free(text);
+		text = NULL;
+	}
+
+	fclose(vhdl);
+	remove("./a.vhdl");
+	return text;
+}
+
+void TestAstPool_RoundTrip(CuTest* tc){
+	VentParser* parser = InitVentParser();
+	struct Program* prog = ParseVentProgram(parser, poolProgram, strlen(poolProgram));
+	CuAssertTrue(tc, VentParserHadError(parser) == false);
+
+	struct AstPool* pool = PackProgram(prog);
+	CuAssertPtrNotNull(tc, pool);
+	CuAssertTrue(tc, AstPoolNodeCount(pool) > 0);
+
+	struct Program* unpacked = UnpackProgram(pool);
+	CuAssertPtrNotNull(tc, unpacked);
+
+	//the rebuilt tree transpiles to exactly the same VHDL
+	char* expected = transpileToString(prog);
+	char* actual = transpileToString(unpacked);
+	CuAssertPtrNotNull(tc, expected);
+	CuAssertStrEquals(tc, expected, actual);
+
+	//and packs back into a pool of the same shape
+	struct AstPool* repacked = PackProgram(unpacked);
+	CuAssertIntEquals(tc, AstPoolNodeCount(pool), AstPoolNodeCount(repacked));
+	CuAssertIntEquals(tc, AstPoolBytes(pool), AstPoolBytes(repacked));
+
+	free(expected);
+	free(actual);
+	FreeAstPool(repacked);
+	FreeUnpackedProgram(unpacked);
+	FreeAstPool(pool);
+	FreeVentProgram(parser, prog);
+	FreeVentParser(parser);
+}
+
+void TestAstPool_SharedNodesStayShared(CuTest* tc){
+	VentParser* parser = InitVentParser();
+	SetVentParserShareExpressions(parser, true);
+	struct Program* prog = ParseVentProgram(parser, poolProgram, strlen(poolProgram));
+	CuAssertTrue(tc, VentParserHadError(parser) == false);
+
+	struct AstPool* pool = PackProgram(prog);
+	struct Program* unpacked = UnpackProgram(pool);
+
+	struct DesignUnit* unit = (struct DesignUnit*)ReadBlockArray(unpacked->units, 2);
+	struct ArchitectureDecl* arch = &(unit->as.libraryUnit.as.architecture);
+	struct ConcurrentStatement* c2 = (struct ConcurrentStatement*)ReadBlockArray(arch->statements, 1);
+
+	//a wildcard map points both sides of every mapping at the port name
+	struct BinaryExpr* mapping = (struct BinaryExpr*)c2->as.instantiation.portMap->items[0];
+	CuAssertStrEquals(tc, "clk", ((struct Identifier*)mapping->left)->value);
+	CuAssertPtrEquals(tc, mapping->left, mapping->right);
+
+	//names are interned again, so they compare by symbol
+	struct Identifier* name = c2->as.instantiation.name;
+	CuAssertStrEquals(tc, "counter", name->value);
+	CuAssertTrue(tc, name->symbol != 0);
+
+	FreeUnpackedProgram(unpacked);
+	FreeAstPool(pool);
+	FreeVentProgram(parser, prog);
+	FreeVentParser(parser);
+}
+
+void TestAstPool_EmptyProgram(CuTest* tc){
+	CuAssertPtrEquals(tc, NULL, PackProgram(NULL));
+	CuAssertPtrEquals(tc, NULL, UnpackProgram(NULL));
+
+	VentParser* parser = InitVentParser();
+	struct Program* prog = ParseVentProgram(parser, "", 0);
+
+	struct AstPool* pool = PackProgram(prog);
+	CuAssertIntEquals(tc, 0, AstPoolNodeCount(pool));
+
+	struct Program* unpacked = UnpackProgram(pool);
+	CuAssertPtrNotNull(tc, unpacked);
+	CuAssertPtrEquals(tc, NULL, unpacked->units);
+
+	FreeUnpackedProgram(unpacked);
+	FreeAstPool(pool);
+	FreeVentProgram(parser, prog);
+	FreeVentParser(parser);
+}
+
+void TestAstPool_FileRoundTrip(CuTest* tc){
+	VentParser* parser = InitVentParser();
+	struct Program* prog = ParseVentProgram(parser, poolProgram, strlen(poolProgram));
+	struct AstPool* pool = PackProgram(prog);
+
+	CuAssertTrue(tc, WriteAstPool(pool, "./pool_test.vast"));
+
+	struct AstPool* loaded = LoadAstPool("./pool_test.vast");
+	CuAssertPtrNotNull(tc, loaded);
+	CuAssertIntEquals(tc, AstPoolNodeCount(pool), AstPoolNodeCount(loaded));
+	CuAssertIntEquals(tc, AstPoolBytes(pool), AstPoolBytes(loaded));
+
+	//a tree rebuilt from the mapped file transpiles like the parsed one
+	struct Program* unpacked = UnpackProgram(loaded);
+	char* expected = transpileToString(prog);
+	char* actual = transpileToString(unpacked);
+	CuAssertPtrNotNull(tc, expected);
+	CuAssertStrEquals(tc, expected, actual);
+
+	free(expected);
+	free(actual);
+	FreeUnpackedProgram(unpacked);
+	FreeAstPool(loaded);
+	FreeAstPool(pool);
+	FreeVentProgram(parser, prog);
+	FreeVentParser(parser);
+	remove("./pool_test.vast");
+}
+
+struct walkedNodes {
+	uint32_t count;
+	uint32_t lastRef;
+	bool inOrder;
+	char names[256];
+};
+
+static void collectNode(struct AstPoolNode* node, void* data){
+	struct walkedNodes* walked = data;
+	if(node->ref <= walked->lastRef) walked->inOrder = false;
+	walked->lastRef = node->ref;
+	walked->count++;
+
+	size_t used = strlen(walked->names);
+	snprintf(walked->names + used, sizeof(walked->names) - used, "%s ", node->text ? node->text : "");
+}
+
+void TestAstPool_Walk(CuTest* tc){
+	VentParser* parser = InitVentParser();
+	struct Program* prog = ParseVentProgram(parser, poolProgram, strlen(poolProgram));
+	struct AstPool* pool = PackProgram(prog);
+
+	struct walkedNodes all = {0, 0, true, ""};
+	WalkAstPool(pool, 0, collectNode, &all);
+	CuAssertIntEquals(tc, AstPoolNodeCount(pool), all.count);
+	CuAssertTrue(tc, all.inOrder);
+
+	//identifiers come out in preorder, the way they are written
+	struct walkedNodes idents = {0, 0, true, ""};
+	WalkAstPool(pool, AST_MASK(AST_IDENTIFIER), collectNode, &idents);
+	CuAssertStrEquals(tc, "pooled WIDTH clk rst q WIDTH behavioral pooled state_t Idle Run Done state count q "
+		"counter SIZE clk rst Q counter clk rst q counter clk rst i rst count clk UP state state Run count count "
+		"j j i i i i i q q ", idents.names);
+
+	//a shared expression is stored once, so it is visited once
+	VentParser* sharing = InitVentParser();
+	SetVentParserShareExpressions(sharing, true);
+	struct Program* shared = ParseVentProgram(sharing, poolProgram, strlen(poolProgram));
+	struct AstPool* sharedPool = PackProgram(shared);
+
+	struct walkedNodes sharedAll = {0, 0, true, ""};
+	WalkAstPool(sharedPool, 0, collectNode, &sharedAll);
+	CuAssertIntEquals(tc, AstPoolNodeCount(sharedPool), sharedAll.count);
+	CuAssertTrue(tc, sharedAll.count < all.count);
+
+	WalkAstPool(NULL, 0, collectNode, &all);
+
+	FreeAstPool(sharedPool);
+	FreeVentProgram(sharing, shared);
+	FreeVentParser(sharing);
+	FreeAstPool(pool);
+	FreeVentProgram(parser, prog);
+	FreeVentParser(parser);
+}
+
+//the header WriteAstPool() writes in front of the words
+struct poolFileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint32_t wordCount;
+	uint32_t charCount;
+	uint32_t units;
+	uint32_t nodeCount;
+};
+
+static char* readPoolFile(const char* path, size_t* size){
+	FILE* file = fopen(path, "rb");
+	if(file == NULL) return NULL;
+
+	fseek(file, 0, SEEK_END);
+	*size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	char* bytes = malloc(*size);
+	if(bytes && fread(bytes, 1, *size, file) != *size){
+		free(bytes);
+		bytes = NULL;
+	}
+
+	fclose(file);
+	return bytes;
+}
+
+//loads a copy of good with word ref of the pool set to value
+static struct AstPool* loadCorrupted(const char* good, size_t size, uint32_t ref, uint32_t value){
+	FILE* file = fopen("./pool_test.vast", "wb");
+	if(file == NULL) return NULL;
+
+	size_t at = sizeof(struct poolFileHeader) + ref * sizeof(uint32_t);
+	fwrite(good, 1, at, file);
+	fwrite(&value, sizeof(value), 1, file);
+	fwrite(good + at + sizeof(value), 1, size - at - sizeof(value), file);
+	fclose(file);
+
+	return LoadAstPool("./pool_test.vast");
+}
+
+//every rejected file prints an error, thousands of them say nothing
+static int quietStdout(){
+	fflush(stdout);
+	int out = dup(STDOUT_FILENO);
+	int null = open("/dev/null", O_WRONLY);
+	dup2(null, STDOUT_FILENO);
+	close(null);
+	return out;
+}
+
+static void restoreStdout(int out){
+	fflush(stdout);
+	dup2(out, STDOUT_FILENO);
+	close(out);
+}
+
+void TestAstPool_LoadRejectsBadFiles(CuTest* tc){
+	CuAssertPtrEquals(tc, NULL, LoadAstPool("./no_such_file.vast"));
+
+	VentParser* parser = InitVentParser();
+	struct Program* prog = ParseVentProgram(parser, poolProgram, strlen(poolProgram));
+	struct AstPool* pool = PackProgram(prog);
+	CuAssertTrue(tc, WriteAstPool(pool, "./pool_test.vast"));
+
+	//cut short
+	FILE* file = fopen("./pool_test.vast", "r+b");
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fclose(file);
+	CuAssertTrue(tc, truncate("./pool_test.vast", length - 1) == 0);
+	CuAssertPtrEquals(tc, NULL, LoadAstPool("./pool_test.vast"));
+
+	//references that point outside the file, at the wrong node or back at
+	//their own node. With shared expressions on, the good file also has
+	//references back to expressions packed earlier and still has to load
+	SetVentParserShareExpressions(parser, true);
+	struct Program* shared = ParseVentProgram(parser, poolProgram, strlen(poolProgram));
+	struct AstPool* sharedPool = PackProgram(shared);
+	CuAssertTrue(tc, WriteAstPool(sharedPool, "./pool_test.vast"));
+
+	size_t size = 0;
+	char* good = readPoolFile("./pool_test.vast", &size);
+	CuAssertPtrNotNull(tc, good);
+
+	struct AstPool* loaded = LoadAstPool("./pool_test.vast");
+	CuAssertPtrNotNull(tc, loaded);
+	FreeAstPool(loaded);
+
+	struct poolFileHeader* head = (struct poolFileHeader*)good;
+	uint32_t* words = (uint32_t*)(head + 1);
+
+	//poolProgram is a use statement, an entity whose third port is q with
+	//range WIDTH-1 downto 0, then an architecture that starts with a type
+	uint32_t units = head->units;
+	uint32_t use = words[units + 1];
+	uint32_t ent = words[units + 2];
+	uint32_t arch = words[units + 3];
+	uint32_t typeDecl = words[words[arch + 3] + 1];
+	uint32_t range = words[words[words[words[ent + 3] + 3] + 4] + 2];
+	uint32_t binary = words[range + 1];
+
+	CuAssertPtrEquals(tc, NULL, loadCorrupted(good, size, use + 1, 0x7fffffff));
+	CuAssertPtrEquals(tc, NULL, loadCorrupted(good, size, use + 2, head->charCount));
+	CuAssertPtrEquals(tc, NULL, loadCorrupted(good, size, units + 1, 0xffffff));
+	CuAssertPtrEquals(tc, NULL, loadCorrupted(good, size, units + 1, head->wordCount));
+	CuAssertPtrEquals(tc, NULL, loadCorrupted(good, size, units + 1, use + 1));
+	CuAssertPtrEquals(tc, NULL, loadCorrupted(good, size, units + 1, arch));
+	CuAssertPtrEquals(tc, NULL, loadCorrupted(good, size, units + 3, units));
+	CuAssertPtrEquals(tc, NULL, loadCorrupted(good, size, arch + 1, typeDecl));
+	CuAssertPtrEquals(tc, NULL, loadCorrupted(good, size, typeDecl + 1, typeDecl));
+	CuAssertPtrEquals(tc, NULL, loadCorrupted(good, size, range + 1, range));
+
+	//an expression that is its own operand
+	CuAssertPtrEquals(tc, NULL, loadCorrupted(good, size, binary + 1, binary));
+	CuAssertPtrEquals(tc, NULL, loadCorrupted(good, size, binary + 3, binary));
+
+	//any one word pointed at its own node or far out of the file, whatever
+	//still loads has to unpack
+	int out = quietStdout();
+	for(uint32_t ref = 1; ref < head->wordCount; ref++){
+		uint32_t values[] = {ref, 0x7fffffff};
+		for(int i = 0; i < 2; i++){
+			loaded = loadCorrupted(good, size, ref, values[i]);
+			if(loaded) FreeUnpackedProgram(UnpackProgram(loaded));
+			FreeAstPool(loaded);
+		}
+	}
+	restoreStdout(out);
+
+	free(good);
+	FreeAstPool(sharedPool);
+	FreeVentProgram(parser, shared);
+
+	//not an AST file at all
+	file = fopen("./pool_test.vast", "wb");
+	fputs("ent notAnAst { a -> stl; }", file);
+	fclose(file);
+	CuAssertPtrEquals(tc, NULL, LoadAstPool("./pool_test.vast"));
+
+	FreeAstPool(pool);
+	FreeVentProgram(parser, prog);
+	FreeVentParser(parser);
+	remove("./pool_test.vast");
+}
+
+CuSuite* AstPoolTestGetSuite(){
+	CuSuite* suite = CuSuiteNew();
+
+	SUITE_ADD_TEST(suite, TestAstPool_RoundTrip);
+	SUITE_ADD_TEST(suite, TestAstPool_SharedNodesStayShared);
+	SUITE_ADD_TEST(suite, TestAstPool_EmptyProgram);
+	SUITE_ADD_TEST(suite, TestAstPool_FileRoundTrip);
+	SUITE_ADD_TEST(suite, TestAstPool_Walk);
+	SUITE_ADD_TEST(suite, TestAstPool_LoadRejectsBadFiles);
+
+	return suite;
+}
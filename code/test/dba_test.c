@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <time.h>
 
 #include "cutest.h"
@@ -183,12 +184,199 @@ void TestDba_ArrayOfUnions(CuTest* tc) {
 	FreeBlockArray(myBlock);
 }
 
+void TestDba_PopAsStack(CuTest* tc){
+	Dba* stack = InitBlockArray(sizeof(int));
+
+	for(int i=0; i<100; i++){
+		WriteBlockArray(stack, (char*)&i);
+	}
+
+	//blocks come back newest first
+	int top = -1;
+	for(int i=99; i>=50; i--){
+		CuAssertTrue(tc, PopBlockArray(stack, (char*)&top));
+		CuAssertIntEquals(tc, i, top);
+	}
+	CuAssertIntEquals(tc, 50, BlockCount(stack));
+
+	//a popped slot is reused by the next write
+	int fresh = 1000;
+	WriteBlockArray(stack, (char*)&fresh);
+	CuAssertIntEquals(tc, 1000, *(int*)ReadBlockArray(stack, 50));
+
+	while(PopBlockArray(stack, NULL));
+	CuAssertIntEquals(tc, 0, BlockCount(stack));
+	CuAssertTrue(tc, !PopBlockArray(stack, (char*)&top));
+
+	FreeBlockArray(stack);
+}
+
+void TestDba_InPlaceSpillsToHeap(CuTest* tc){
+	void* mem = malloc(BlockArraySize(sizeof(long)));
+	Dba* arr = InitBlockArrayInPlace(mem, sizeof(long));
+	CuAssertPtrEquals(tc, mem, arr);
+
+	//the first blocks sit inline after the header
+	long first = 0;
+	WriteBlockArray(arr, (char*)&first);
+	CuAssertTrue(tc, (char*)ReadBlockArray(arr, 0) < (char*)mem + BlockArraySize(sizeof(long)));
+
+	//later ones spill to the heap and keep the earlier values
+	for(long i = 1; i < 100; i++){
+		long value = i * 7;
+		WriteBlockArray(arr, (char*)&value);
+	}
+	CuAssertIntEquals(tc, 100, BlockCount(arr));
+	for(int i = 0; i < 100; i++){
+		CuAssertIntEquals(tc, i * 7, *(long*)ReadBlockArray(arr, i));
+	}
+
+	//only the spilled blocks are freed, mem is still ours
+	FreeBlockArray(arr);
+	CuAssertIntEquals(tc, 0, BlockCount(arr));
+	free(mem);
+
+	CuAssertPtrEquals(tc, NULL, InitBlockArrayInPlace(NULL, sizeof(long)));
+}
+
+void TestDba_FastPath(CuTest* tc){
+	struct testBlock {
+		int a;
+		double b;
+	};
+
+	Dba* arr = InitBlockArray(sizeof(struct testBlock));
+
+	//an emplaced block starts zeroed and is filled where it lies
+	struct testBlock* first = EmplaceBlockArray(arr);
+	CuAssertIntEquals(tc, 0, first->a);
+	first->a = 1;
+	first->b = 0.5;
+
+	struct testBlock more[40];
+	for(int i = 0; i < 40; i++){
+		more[i].a = i + 2;
+		more[i].b = (i + 2) * 0.5;
+	}
+	ReserveBlockArray(arr, 41);
+	char* reserved = BlocksBegin(arr);
+	AppendBlockArray(arr, (char*)more, 40);
+	CuAssertPtrEquals(tc, reserved, BlocksBegin(arr));
+	CuAssertIntEquals(tc, 41, BlockCount(arr));
+
+	int expect = 1;
+	FOR_EACH_BLOCK(struct testBlock, it, arr){
+		CuAssertIntEquals(tc, expect, it->a);
+		CuAssertDblEquals(tc, expect * 0.5, it->b, 0.0000001);
+		CuAssertPtrEquals(tc, ReadBlockArray(arr, expect - 1), BlockAt(arr, expect - 1));
+		expect++;
+	}
+	CuAssertIntEquals(tc, 42, expect);
+
+	//a few blocks fit inline again after shrinking
+	while(BlockCount(arr) > 2) PopBlockArray(arr, NULL);
+	ShrinkBlockArray(arr);
+	CuAssertIntEquals(tc, 2, ((struct testBlock*)BlockAt(arr, 1))->a);
+	CuAssertTrue(tc, (char*)BlocksBegin(arr) < (char*)arr + BlockArraySize(sizeof(struct testBlock)));
+
+	//a NULL array is an empty loop
+	Dba* none = NULL;
+	FOR_EACH_BLOCK(struct testBlock, it, none){
+		CuFail(tc, "no blocks to visit");
+	}
+
+	FreeBlockArray(arr);
+}
+
+void TestDba_SegmentedKeepsAddresses(CuTest* tc){
+	Dba* arr = InitSegmentedBlockArray(sizeof(int));
+
+	int zero = 0;
+	WriteBlockArray(arr, (char*)&zero);
+	int* first = ReadBlockArray(arr, 0);
+
+	//growing adds segments, the blocks already written stay where they are
+	for(int i = 1; i < 10000; i++){
+		int* slot = EmplaceBlockArray(arr);
+		*slot = i;
+	}
+	CuAssertPtrEquals(tc, first, ReadBlockArray(arr, 0));
+
+	int more[100];
+	for(int i = 0; i < 100; i++) more[i] = 10000 + i;
+	AppendBlockArray(arr, (char*)more, 100);
+
+	CuAssertIntEquals(tc, 10100, BlockCount(arr));
+	for(int i = 0; i < 10100; i++){
+		CuAssertIntEquals(tc, i, *(int*)BlockAt(arr, i));
+	}
+
+	//popping and shrinking only drop the segments past the last block
+	int* kept = BlockAt(arr, 99);
+	while(BlockCount(arr) > 100) PopBlockArray(arr, NULL);
+	ShrinkBlockArray(arr);
+	CuAssertPtrEquals(tc, kept, BlockAt(arr, 99));
+	WriteBlockArray(arr, (char*)&zero);
+	CuAssertIntEquals(tc, 0, *(int*)ReadBlockArray(arr, 100));
+
+	FreeBlockArray(arr);
+}
+
+struct point {
+	int x;
+	int y;
+};
+
+DBA_DEFINE(PointVec, struct point)
+
+void TestDba_TypedArray(CuTest* tc){
+	PointVec* points = PointVecOf(InitBlockArray(sizeof(struct point)));
+	CuAssertPtrNotNull(tc, points);
+
+	//pushes go inline first, then spill, the blocks keep their values
+	for(int i = 0; i < 50; i++){
+		struct point p = {i, -i};
+		CuAssertIntEquals(tc, i, PointVecPush(points, &p)->x);
+	}
+	PointVecEmplace(points)->x = 50;
+	CuAssertIntEquals(tc, 51, PointVecCount(points));
+	CuAssertIntEquals(tc, -49, PointVecAt(points, 49)->y);
+	CuAssertIntEquals(tc, 0, PointVecAt(points, 50)->y);
+
+	int expect = 0;
+	for(struct point* p = PointVecBegin(points); p < PointVecEnd(points); p++){
+		CuAssertIntEquals(tc, expect++, p->x);
+	}
+	CuAssertIntEquals(tc, 51, expect);
+	FreeBlockArray(PointVecArray(points));
+
+	//typed access works on a segmented array too
+	PointVec* segmented = PointVecOf(InitSegmentedBlockArray(sizeof(struct point)));
+	for(int i = 0; i < 100; i++){
+		struct point p = {i, i};
+		PointVecPush(segmented, &p);
+	}
+	CuAssertIntEquals(tc, 99, PointVecAt(segmented, 99)->y);
+	FreeBlockArray(PointVecArray(segmented));
+
+	//an array of some other block is not a PointVec
+	Dba* ints = InitBlockArray(sizeof(int));
+	CuAssertPtrEquals(tc, NULL, PointVecOf(ints));
+	CuAssertIntEquals(tc, 0, PointVecCount(NULL));
+	FreeBlockArray(ints);
+}
+
 CuSuite* DbaTestGetSuite(){
 	CuSuite* suite = CuSuiteNew();
 
 	SUITE_ADD_TEST(suite, TestDba_SimpleBlockArray);
 	SUITE_ADD_TEST(suite, TestDba_ArrayOfStructs);
 	SUITE_ADD_TEST(suite, TestDba_ArrayOfUnions);
+	SUITE_ADD_TEST(suite, TestDba_PopAsStack);
+	SUITE_ADD_TEST(suite, TestDba_InPlaceSpillsToHeap);
+	SUITE_ADD_TEST(suite, TestDba_FastPath);
+	SUITE_ADD_TEST(suite, TestDba_SegmentedKeepsAddresses);
+	SUITE_ADD_TEST(suite, TestDba_TypedArray);
 
 	return suite;
 }
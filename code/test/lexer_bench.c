@@ -0,0 +1,136 @@
+/*
+	lexer_bench.c
+
+	Measures lexer throughput in MB/s for every run scanner the CPU
+	supports. Each file given on the command line is lexed repeatedly,
+	followed by a few synthetic inputs that stress long whitespace runs,
+	long identifiers and long comments.
+
+	usage: LexerBench [file.vent ...]
+	--
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lexer.h"
+#include "scan.h"
+
+//lex at least this many bytes per measurement so small files still give stable numbers
+#define BENCH_MIN_BYTES (64u * 1024u * 1024u)
+#define SYNTHETIC_BYTES (16u * 1024u * 1024u)
+
+static double now(){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static double lexThroughput(char* input, const struct RunScanner* scanner, long* tokenCount){
+	size_t len = strlen(input);
+	if(len == 0) return 0.0;
+
+	int passes = (int)(BENCH_MIN_BYTES / len) + 1;
+	long tokens = 0;
+
+	double start = now();
+	for(int i = 0; i < passes; i++){
+		VentLexer* lex = InitVentLexerWithScanner(input, len, scanner);
+		while(NextVentToken(lex).type != TOKEN_EOP){
+			tokens++;
+		}
+		FreeVentLexer(lex);
+	}
+	double elapsed = now() - start;
+
+	*tokenCount = tokens / passes;
+	return ((double)len * passes) / (1024.0 * 1024.0) / elapsed;
+}
+
+static void benchInput(const char* name, char* input){
+	printf("%-32s %10zu bytes", name, strlen(input));
+
+	for(int level = SCAN_SCALAR; level <= SCAN_AVX2; level++){
+		const struct RunScanner* scanner = GetRunScanner(level);
+		if(scanner == NULL) continue;
+
+		long tokens = 0;
+		double mbs = lexThroughput(input, scanner, &tokens);
+		printf("  %6s: %8.1f MB/s", scanner->name, mbs);
+	}
+	printf("\n");
+}
+
+static char* readFile(const char* path){
+	FILE* f = fopen(path, "rb");
+	if(f == NULL) return NULL;
+
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	char* buf = malloc(size + 1);
+	size_t got = fread(buf, 1, size, f);
+	buf[got] = '\0';
+
+	fclose(f);
+	return buf;
+}
+
+//repeat pattern until the buffer holds about SYNTHETIC_BYTES
+static char* synthesize(const char* pattern){
+	size_t plen = strlen(pattern);
+	size_t reps = SYNTHETIC_BYTES / plen;
+	char* buf = malloc(reps * plen + 1);
+
+	for(size_t i = 0; i < reps; i++){
+		memcpy(buf + i * plen, pattern, plen);
+	}
+	buf[reps * plen] = '\0';
+
+	return buf;
+}
+
+int main(int argc, char** argv){
+	printf("*** VENT lexer throughput (selected scanner: %s) ***\n", SelectRunScanner()->name);
+
+	for(int i = 1; i < argc; i++){
+		char* input = readFile(argv[i]);
+		if(input == NULL){
+			printf("could not open %s\n", argv[i]);
+			continue;
+		}
+
+		const char* name = strrchr(argv[i], '/');
+		benchInput(name ? name + 1 : argv[i], input);
+		free(input);
+	}
+
+	struct {
+		const char* name;
+		const char* pattern;
+	} synthetic[] = {
+		{"synthetic: typical",
+			"\tsig counter_value : stlv(7 downto 0) := X\"00\";\n"
+			"\tcounter_value <= counter_value + 1; // bump it\n"},
+		{"synthetic: deep indentation",
+			"\n\t\t\t\t\t\t\t\t                                \ts <= a;\n"},
+		{"synthetic: long identifiers",
+			"this_is_a_really_long_identifier_name_for_a_signal_in_a_design "
+			"another_long_identifier_that_keeps_going_and_going_and_going;\n"},
+		{"synthetic: long comments",
+			"/* a block comment that runs on for quite a while, describing\n"
+			"   what the following process is meant to do in great detail */\n"
+			"// and a line comment that also says a lot about nothing at all\n"},
+	};
+
+	for(size_t i = 0; i < sizeof(synthetic) / sizeof(synthetic[0]); i++){
+		char* input = synthesize(synthetic[i].pattern);
+		benchInput(synthetic[i].name, input);
+		free(input);
+	}
+
+	return 0;
+}
@@ -2,18 +2,25 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #include <lexer.h>
 
 #include "cutest.h"
 
+static void assertLiteralEquals(CuTest* tc, const char* expected, struct Token tk){
+	char* actual = CopyTokenLiteral(tk);
+	CuAssertStrEquals(tc, expected, actual); 
+	free(actual);
+}
+
 static void testNextToken(CuTest* tc,  enum TOKEN_TYPE type, char* lit){
 
 	struct Token tk = NextToken();
 	if(lit != NULL)
-		CuAssertStrEquals(tc, lit, tk.literal); 
+		assertLiteralEquals(tc, lit, tk); 
 	CuAssertStrEquals(tc, TokenToString(type), TokenToString(tk.type));
-	free(tk.literal);	
 }
 
 void TestNextToken_SingleToken(CuTest *tc){
@@ -26,9 +33,43 @@ void TestNextToken_SingleToken(CuTest *tc){
 	const char* expLiteral = "+";
 
 	CuAssertStrEquals(tc, expToken, TokenToString(nt.type)); 
-	CuAssertStrEquals(tc, expLiteral, nt.literal); 
+	assertLiteralEquals(tc, expLiteral, nt); 
+
+	free(input);
+	FreeLexer();
+}
+
+void TestNextToken_LiteralSpans(CuTest *tc){
+	char* input = strdup("sig abc <= x;");
+	InitLexer(input);
+
+	//every token points straight into the source
+	struct Token nt = NextToken();
+	CuAssertPtrEquals(tc, input, (char*)nt.literal);
+	CuAssertIntEquals(tc, 3, nt.length);
+
+	nt = NextToken();
+	CuAssertPtrEquals(tc, input + 4, (char*)nt.literal);
+	CuAssertIntEquals(tc, 3, nt.length);
+
+	nt = NextToken();
+	CuAssertPtrEquals(tc, input + 8, (char*)nt.literal);
+	CuAssertIntEquals(tc, 2, nt.length);
+
+	nt = NextToken();
+	CuAssertPtrEquals(tc, input + 11, (char*)nt.literal);
+	CuAssertIntEquals(tc, 1, nt.length);
+
+	nt = NextToken();
+	CuAssertPtrEquals(tc, input + 12, (char*)nt.literal);
+	assertLiteralEquals(tc, ";", nt);
+
+	//even the end of program, as an empty span on the terminator
+	nt = NextToken();
+	CuAssertIntEquals(tc, TOKEN_EOP, nt.type);
+	CuAssertPtrEquals(tc, input + 13, (char*)nt.literal);
+	CuAssertIntEquals(tc, 0, nt.length);
 
-	free(nt.literal);	
 	free(input);
 	FreeLexer();
 }
@@ -50,7 +91,6 @@ void TestNextToken_MultipleTokens(CuTest *tc){
 	for(int i=0; i<11; i++){
 		struct Token nt = NextToken();
 		CuAssertStrEquals(tc, TokenToString(expToken[i]), TokenToString(nt.type)); 
-		free(nt.literal);	
 	}
 
 	free(input);
@@ -69,8 +109,7 @@ void TestNextToken_SingleLineComment (CuTest *tc){
 	struct Token nt = NextToken();
 
 	CuAssertIntEquals(tc, expToken, nt.type);
-	CuAssertStrEquals(tc, expLiteral, nt.literal); 
-	free(nt.literal);	
+	assertLiteralEquals(tc, expLiteral, nt); 
 	
 	expToken = TOKEN_PLUS;
 	char* expLiteral2 = "+";
@@ -78,9 +117,8 @@ void TestNextToken_SingleLineComment (CuTest *tc){
 	nt = NextToken();
 
 	CuAssertIntEquals(tc, expToken, nt.type);
-	CuAssertStrEquals(tc, expLiteral2, nt.literal); 
+	assertLiteralEquals(tc, expLiteral2, nt); 
 	
-	free(nt.literal);	
 	free(input);
 	FreeLexer();
 }
@@ -103,9 +141,8 @@ important*/ \
 	
 		char* expLiteral = strdup((char[2]){expLiteralArr[i], '\0'});
 		CuAssertIntEquals(tc, expToken[i], nt.type);
-		CuAssertStrEquals(tc, expLiteral, nt.literal); 
+		assertLiteralEquals(tc, expLiteral, nt); 
 		
-		free(nt.literal);	
 		free(expLiteral);
 	}
 
@@ -126,9 +163,8 @@ void TestNextToken_MultiLineCommentUnterminated (CuTest *tc){
 	
 		char* expLiteral = strdup((char[2]){expLiteralArr[i], '\0'});
 		CuAssertIntEquals(tc, expToken[i], nt.type);
-		CuAssertStrEquals(tc, expLiteral, nt.literal); 
+		assertLiteralEquals(tc, expLiteral, nt); 
 		
-		free(nt.literal);	
 		free(expLiteral);
 	}
 
@@ -146,9 +182,8 @@ void TestNextToken_Number (CuTest *tc){
 	struct Token nt = NextToken();
 
 	CuAssertIntEquals(tc, expToken, nt.type);
-	CuAssertStrEquals(tc, expLiteral, nt.literal); 
+	assertLiteralEquals(tc, expLiteral, nt); 
 	
-	free(nt.literal);	
 	free(input);
 	FreeLexer();
 }
@@ -163,9 +198,8 @@ void TestNextToken_Char (CuTest *tc){
 	struct Token nt = NextToken();
 
 	CuAssertIntEquals(tc, expToken, nt.type);
-	CuAssertStrEquals(tc, expLiteral, nt.literal); 
+	assertLiteralEquals(tc, expLiteral, nt); 
 
-	free(nt.literal);	
 	free(input);
 	FreeLexer();
 }
@@ -180,9 +214,8 @@ void TestNextToken_BitString (CuTest *tc){
 	struct Token nt = NextToken();
 
 	CuAssertIntEquals(tc, expToken, nt.type);
-	CuAssertStrEquals(tc, expLiteral, nt.literal); 
+	assertLiteralEquals(tc, expLiteral, nt); 
 
-	free(nt.literal);	
 	free(input);
 	FreeLexer();
 }
@@ -197,9 +230,8 @@ void TestNextToken_String (CuTest *tc){
 	struct Token nt = NextToken();
 
 	CuAssertIntEquals(tc, expToken, nt.type);
-	CuAssertStrEquals(tc, expLiteral, nt.literal); 
+	assertLiteralEquals(tc, expLiteral, nt); 
 
-	free(nt.literal);	
 	free(input);
 	FreeLexer();
 }
@@ -214,9 +246,8 @@ void TestNextToken_Identifier (CuTest *tc){
 	struct Token nt = NextToken();
 
 	CuAssertIntEquals(tc, expToken, nt.type);
-	CuAssertStrEquals(tc, expLiteral, nt.literal); 
+	assertLiteralEquals(tc, expLiteral, nt); 
 
-	free(nt.literal);	
 	free(input);
 	FreeLexer();
 }
@@ -231,9 +262,8 @@ void TestNextToken_IdentifierSingleLetter (CuTest *tc){
 	struct Token nt = NextToken();
 
 	CuAssertIntEquals(tc, expToken, nt.type);
-	CuAssertStrEquals(tc, expLiteral, nt.literal); 
+	assertLiteralEquals(tc, expLiteral, nt); 
 
-	free(nt.literal);	
 	free(input);
 	FreeLexer();
 }
@@ -248,9 +278,8 @@ void TestNextToken_Entity (CuTest *tc){
 	struct Token nt = NextToken();
 
 	CuAssertIntEquals(tc, expToken, nt.type);
-	CuAssertStrEquals(tc, expLiteral, nt.literal); 
+	assertLiteralEquals(tc, expLiteral, nt); 
 
-	free(nt.literal);	
 	free(input);
 	FreeLexer();
 }
@@ -265,8 +294,7 @@ void TestNextToken_EntityDeclaration (CuTest *tc){
 	struct Token nt = NextToken();
 
 	CuAssertIntEquals(tc, expToken, nt.type);
-	CuAssertStrEquals(tc, expLiteral, nt.literal); 
-	free(nt.literal);	
+	assertLiteralEquals(tc, expLiteral, nt); 
 
 	expToken = TOKEN_IDENTIFIER;
 	char* expLiteral2 = "ander";
@@ -274,8 +302,7 @@ void TestNextToken_EntityDeclaration (CuTest *tc){
 	nt = NextToken();
 
 	CuAssertIntEquals(tc, expToken, nt.type);
-	CuAssertStrEquals(tc, expLiteral2, nt.literal); 
-	free(nt.literal);	
+	assertLiteralEquals(tc, expLiteral2, nt); 
 
 	expToken = TOKEN_LBRACE;
 	char* expLiteral3 = "{";
@@ -283,8 +310,7 @@ void TestNextToken_EntityDeclaration (CuTest *tc){
 	nt = NextToken();
 
 	CuAssertIntEquals(tc, expToken, nt.type);
-	CuAssertStrEquals(tc, expLiteral3, nt.literal); 
-	free(nt.literal);	
+	assertLiteralEquals(tc, expLiteral3, nt); 
 
 	expToken = TOKEN_RBRACE;
 	char* expLiteral4 = "}";
@@ -292,8 +318,7 @@ void TestNextToken_EntityDeclaration (CuTest *tc){
 	nt = NextToken();
 
 	CuAssertIntEquals(tc, expToken, nt.type);
-	CuAssertStrEquals(tc, expLiteral4, nt.literal); 
-	free(nt.literal);	
+	assertLiteralEquals(tc, expLiteral4, nt); 
 
 	free(input);
 	FreeLexer();
@@ -308,27 +333,24 @@ void TestNextToken_PortDirections (CuTest *tc){
 	
 	struct Token nt = NextToken();
 
-	CuAssertStrEquals(tc, expLiteral, nt.literal); 
+	assertLiteralEquals(tc, expLiteral, nt); 
 	CuAssertIntEquals(tc, expToken, nt.type);
-	free(nt.literal);	
 
 	expToken = TOKEN_OUTPUT;
 	char* expLiteral2 = "<-";
 	
 	nt = NextToken();
 
-	CuAssertStrEquals(tc, expLiteral2, nt.literal); 
+	assertLiteralEquals(tc, expLiteral2, nt); 
 	CuAssertIntEquals(tc, expToken, nt.type);
-	free(nt.literal);	
 
 	expToken = TOKEN_INOUT;
 	char* expLiteral3 = "<->";
 	
 	nt = NextToken();
 
-	CuAssertStrEquals(tc, expLiteral3, nt.literal); 
+	assertLiteralEquals(tc, expLiteral3, nt); 
 	CuAssertIntEquals(tc, expToken, nt.type);
-	free(nt.literal);	
 
 	free(input);
 	FreeLexer();
@@ -339,30 +361,24 @@ void TestNextToken_ProcessDeclaration (CuTest *tc){
 	InitLexer(input);
 
 	struct Token nt = NextToken();
-	CuAssertStrEquals(tc, "proc", nt.literal); 
+	assertLiteralEquals(tc, "proc", nt); 
 	CuAssertStrEquals(tc, TokenToString(TOKEN_PROC), TokenToString(nt.type));
-	free(nt.literal);	
 
 	nt = NextToken();
 	CuAssertIntEquals(tc, TOKEN_LPAREN, nt.type);
-	free(nt.literal);	
 
 	nt = NextToken();
-	CuAssertStrEquals(tc, "clk", nt.literal); 
+	assertLiteralEquals(tc, "clk", nt); 
 	CuAssertStrEquals(tc, TokenToString(TOKEN_IDENTIFIER), TokenToString(nt.type));
-	free(nt.literal);	
 
 	nt = NextToken();
 	CuAssertIntEquals(tc, TOKEN_RPAREN, nt.type);
-	free(nt.literal);	
 
 	nt = NextToken();
 	CuAssertIntEquals(tc, TOKEN_LBRACE, nt.type);
-	free(nt.literal);	
 
 	nt = NextToken();
 	CuAssertIntEquals(tc, TOKEN_RBRACE, nt.type);
-	free(nt.literal);	
 
 	free(input);
 	FreeLexer();
@@ -459,6 +475,299 @@ void TestNextToken_SignalWithEdge (CuTest *tc){
 	FreeLexer();
 }
 
+void TestNextToken_AllKeywords (CuTest *tc){
+
+	//every keyword must sit in the group for its first letter and lex as itself
+#define CHECK_KEYWORD(type, spelling) { \
+		CuAssertIntEquals_Msg(tc, spelling, groupChar, spelling[0]); \
+		char* input = strdup(spelling); \
+		InitLexer(input); \
+		testNextToken(tc, type, spelling); \
+		free(input); \
+		FreeLexer(); \
+	}
+#define CHECK_GROUP(firstChar, group) { char groupChar = firstChar; group(CHECK_KEYWORD) }
+
+	KEYWORD_LIST(CHECK_GROUP)
+
+#undef CHECK_GROUP
+#undef CHECK_KEYWORD
+}
+
+void TestNextToken_KeywordPrefixes (CuTest *tc){
+	char* input = strdup("ander sigs s downt i");
+	InitLexer(input);
+
+	testNextToken(tc, TOKEN_IDENTIFIER, "ander");	
+	testNextToken(tc, TOKEN_IDENTIFIER, "sigs");	
+	testNextToken(tc, TOKEN_IDENTIFIER, "s");	
+	testNextToken(tc, TOKEN_IDENTIFIER, "downt");	
+	testNextToken(tc, TOKEN_IDENTIFIER, "i");	
+	
+	free(input);
+	FreeLexer();
+}
+
+void TestVentLexer_Interleaved (CuTest *tc){
+	char* inputA = strdup("ent a {\n}");
+	char* inputB = strdup("sig b : stl;");
+
+	VentLexer* lexA = InitVentLexer(inputA, strlen(inputA));
+	VentLexer* lexB = InitVentLexer(inputB, strlen(inputB));
+
+	//each lexer keeps its own place no matter how the calls are mixed
+	CuAssertIntEquals(tc, TOKEN_ENT, NextVentToken(lexA).type);
+	CuAssertIntEquals(tc, TOKEN_SIG, NextVentToken(lexB).type);
+	CuAssertIntEquals(tc, TOKEN_IDENTIFIER, NextVentToken(lexB).type);
+	CuAssertIntEquals(tc, TOKEN_IDENTIFIER, NextVentToken(lexA).type);
+	CuAssertIntEquals(tc, TOKEN_LBRACE, NextVentToken(lexA).type);
+	CuAssertIntEquals(tc, TOKEN_COLON, NextVentToken(lexB).type);
+
+	struct Token t = NextVentToken(lexA);
+	CuAssertIntEquals(tc, TOKEN_RBRACE, t.type);
+	CuAssertIntEquals(tc, 2, t.lineNumber);
+	CuAssertIntEquals(tc, TOKEN_EOP, NextVentToken(lexA).type);
+	CuAssertIntEquals(tc, TOKEN_EOP, NextVentToken(lexA).type);
+
+	CuAssertIntEquals(tc, TOKEN_STL, NextVentToken(lexB).type);
+	CuAssertIntEquals(tc, TOKEN_SCOLON, NextVentToken(lexB).type);
+	CuAssertIntEquals(tc, TOKEN_EOP, NextVentToken(lexB).type);
+
+	FreeVentLexer(lexA);
+	FreeVentLexer(lexB);
+	free(inputA);
+	free(inputB);
+}
+
+void TestVentLexer_Peek (CuTest *tc){
+	char* input = strdup("a, b -> stl;");
+	VentLexer* lex = InitVentLexer(input, strlen(input));
+
+	CuAssertIntEquals(tc, TOKEN_IDENTIFIER, PeekVentToken(lex, 0).type);
+	CuAssertIntEquals(tc, TOKEN_INPUT, PeekVentToken(lex, 3).type);
+	CuAssertIntEquals(tc, TOKEN_EOP, PeekVentToken(lex, 10).type);
+
+	//peeking never moves the lexer
+	CuAssertIntEquals(tc, TOKEN_IDENTIFIER, NextVentToken(lex).type);
+	CuAssertIntEquals(tc, TOKEN_COMMA, NextVentToken(lex).type);
+	CuAssertIntEquals(tc, TOKEN_STL, PeekVentToken(lex, 2).type);
+	CuAssertIntEquals(tc, TOKEN_IDENTIFIER, NextVentToken(lex).type);
+
+	FreeVentLexer(lex);
+	free(input);
+}
+
+void TestTokenStream_MatchesLexer (CuTest *tc){
+	char* input = strdup("\
+		ent ander {\n\
+			a -> stl; // comment\n\
+			y <- stlv(7 downto 0);\n\
+		}\n\
+		arch rtl(ander) { y <= X\"00\" and '1'; }\n\
+	");
+
+	struct TokenStream* ts = LexTokenStream(input, strlen(input));
+	VentLexer* lex = InitVentLexer(input, strlen(input));
+
+	uint32_t i = 0;
+	struct Token expected;
+	do {
+		expected = NextVentToken(lex);
+		struct Token t = TokenAt(ts, i++);
+
+		CuAssertIntEquals(tc, expected.type, t.type);
+		CuAssertPtrEquals(tc, (void*)expected.literal, (void*)t.literal);
+		CuAssertIntEquals(tc, expected.length, t.length);
+		CuAssertIntEquals(tc, expected.lineNumber, t.lineNumber);
+	} while(expected.type != TOKEN_EOP);
+
+	CuAssertIntEquals(tc, i, ts->count);
+
+	//indexing past the end keeps giving the end of program
+	CuAssertIntEquals(tc, TOKEN_EOP, TokenAt(ts, ts->count + 5).type);
+
+	FreeVentLexer(lex);
+	FreeTokenStream(ts);
+	free(input);
+}
+
+void TestTokenStream_Grows (CuTest *tc){
+	//far more tokens than the initial guess of one per four chars
+	int reps = 5000;
+	char* input = malloc(reps * 2 + 1);
+	for(int i = 0; i < reps; i++){
+		input[i*2] = ';';
+		input[i*2 + 1] = '(';
+	}
+	input[reps * 2] = '\0';
+
+	struct TokenStream* ts = LexTokenStream(input, strlen(input));
+
+	CuAssertIntEquals(tc, reps * 2 + 1, ts->count);
+	CuAssertIntEquals(tc, TOKEN_SCOLON, TokenAt(ts, reps * 2 - 2).type);
+	CuAssertIntEquals(tc, TOKEN_LPAREN, TokenAt(ts, reps * 2 - 1).type);
+	CuAssertIntEquals(tc, reps * 2 - 1, TokenAt(ts, reps * 2 - 1).literal - input);
+
+	FreeTokenStream(ts);
+	free(input);
+}
+
+void TestVentLexer_ExplicitLength (CuTest *tc){
+	//no terminator anywhere, the lexer must stop at the length it was given
+	char input[] = {'s', 'i', 'g', ' ', 'a', 'b', 'c', '/', '*', 'x'};
+
+	VentLexer* lex = InitVentLexer(input, 6);
+	struct Token t = NextVentToken(lex);
+	CuAssertIntEquals(tc, TOKEN_SIG, t.type);
+	t = NextVentToken(lex);
+	CuAssertIntEquals(tc, TOKEN_IDENTIFIER, t.type);
+	CuAssertIntEquals(tc, 2, t.length);
+	t = NextVentToken(lex);
+	CuAssertIntEquals(tc, TOKEN_EOP, t.type);
+	CuAssertPtrEquals(tc, input + 6, (char*)t.literal);
+	FreeVentLexer(lex);
+
+	//an unterminated comment running into the end
+	lex = InitVentLexer(input, sizeof(input));
+	CuAssertIntEquals(tc, TOKEN_SIG, NextVentToken(lex).type);
+	CuAssertIntEquals(tc, 3, NextVentToken(lex).length);
+	CuAssertIntEquals(tc, TOKEN_EOP, NextVentToken(lex).type);
+	CuAssertIntEquals(tc, TOKEN_EOP, NextVentToken(lex).type);
+	FreeVentLexer(lex);
+}
+
+//a pipe already holding input, so a streaming lexer can read it back
+static int pipeWith(const char* input){
+	int fds[2];
+	if(pipe(fds) != 0) return -1;
+
+	ssize_t written = write(fds[1], input, strlen(input));
+	(void)written;
+	close(fds[1]);
+
+	return fds[0];
+}
+
+void TestVentLexer_StreamMatchesBuffer (CuTest *tc){
+	char* input = "\
+// a comment that is longer than a few of the chunks below\n\
+ent a_long_entity_name {\n\
+	clk -> stl;\n\
+	/* a block comment with ** stars\n and a newline */\n\
+	data <- stlv(7 downto 0);\n\
+}\n\
+arch rtl(a_long_entity_name){\n\
+	sig s : stl := '0';\n\
+	s <= X\"FF\" and \"a string\" and 3.14E-2;\n\
+	s <-> s; s => s;\n\
+}\n";
+
+	//every chunk size splits tokens and comments in different places
+	for(size_t chunk = 1; chunk <= 24; chunk++){
+		VentLexer* ref = InitVentLexer(input, strlen(input));
+		int fd = pipeWith(input);
+		VentLexer* lex = InitVentStreamLexer(fd, chunk);
+
+		struct Token expected, t;
+		do {
+			expected = NextVentToken(ref);
+			t = NextVentToken(lex);
+
+			CuAssertIntEquals(tc, expected.type, t.type);
+			CuAssertIntEquals(tc, expected.length, t.length);
+			CuAssertIntEquals(tc, expected.lineNumber, t.lineNumber);
+			CuAssertTrue(tc, memcmp(expected.literal, t.literal, t.length) == 0);
+		} while(expected.type != TOKEN_EOP);
+
+		FreeVentLexer(lex);
+		FreeVentLexer(ref);
+		close(fd);
+	}
+}
+
+void TestVentLexer_StreamPeek (CuTest *tc){
+	int fd = pipeWith("a, b, c -> stl;");
+	VentLexer* lex = InitVentStreamLexer(fd, 3);
+
+	CuAssertIntEquals(tc, TOKEN_INPUT, PeekVentToken(lex, 5).type);
+	CuAssertIntEquals(tc, TOKEN_ILLEGAL, PeekVentToken(lex, STREAM_LOOKAHEAD).type);
+
+	//peeked literals are still intact once they come out of NextVentToken()
+	struct Token first = NextVentToken(lex);
+	CuAssertIntEquals(tc, TOKEN_IDENTIFIER, first.type);
+	assertLiteralEquals(tc, "a", first);
+	CuAssertIntEquals(tc, TOKEN_COMMA, NextVentToken(lex).type);
+	assertLiteralEquals(tc, "b", NextVentToken(lex));
+	assertLiteralEquals(tc, "a", first);
+
+	CuAssertIntEquals(tc, TOKEN_SCOLON, PeekVentToken(lex, 4).type);
+	CuAssertIntEquals(tc, TOKEN_COMMA, NextVentToken(lex).type);
+	assertLiteralEquals(tc, "c", NextVentToken(lex));
+	assertLiteralEquals(tc, "->", NextVentToken(lex));
+	assertLiteralEquals(tc, "stl", NextVentToken(lex));
+	CuAssertIntEquals(tc, TOKEN_SCOLON, NextVentToken(lex).type);
+	CuAssertIntEquals(tc, TOKEN_EOP, NextVentToken(lex).type);
+
+	FreeVentLexer(lex);
+	close(fd);
+}
+
+struct lexJob {
+	char* input;
+	int tokens;
+	int lastLine;
+};
+
+static void* lexWholeInput(void* arg){
+	struct lexJob* job = arg;
+	VentLexer* lex = InitVentLexer(job->input, strlen(job->input));
+
+	struct Token t;
+	while((t = NextVentToken(lex)).type != TOKEN_EOP){
+		job->tokens++;
+		job->lastLine = t.lineNumber;
+	}
+
+	FreeVentLexer(lex);
+	return NULL;
+}
+
+void TestVentLexer_Threads (CuTest *tc){
+	char* input = strdup("\
+		// a comment\n\
+		ent counter {\n\
+			clk -> stl;\n\
+			count <- stlv(7 downto 0);\n\
+		}\n\
+		/* and\n another */\n\
+		arch rtl(counter){\n\
+			count <= count + 1;\n\
+		}\n\
+	");
+
+	struct lexJob expected = {input, 0, 0};
+	lexWholeInput(&expected);
+
+	#define LEX_THREADS 8
+	pthread_t threads[LEX_THREADS];
+	struct lexJob jobs[LEX_THREADS];
+
+	for(int i = 0; i < LEX_THREADS; i++){
+		jobs[i] = (struct lexJob){input, 0, 0};
+		pthread_create(&threads[i], NULL, lexWholeInput, &jobs[i]);
+	}
+
+	for(int i = 0; i < LEX_THREADS; i++){
+		pthread_join(threads[i], NULL);
+		CuAssertIntEquals(tc, expected.tokens, jobs[i].tokens);
+		CuAssertIntEquals(tc, expected.lastLine, jobs[i].lastLine);
+	}
+	#undef LEX_THREADS
+
+	CuAssertIntEquals(tc, 10, expected.lastLine);
+	free(input);
+}
+
 void TestNextToken_ (CuTest *tc){
 	char* input = strdup("");
 
@@ -474,6 +783,7 @@ CuSuite* LexerTestGetSuite(){
 	CuSuite* suite = CuSuiteNew();
 
 	SUITE_ADD_TEST(suite, TestNextToken_SingleToken);
+	SUITE_ADD_TEST(suite, TestNextToken_LiteralSpans);
 	SUITE_ADD_TEST(suite, TestNextToken_MultipleTokens);
 	SUITE_ADD_TEST(suite, TestNextToken_SingleLineComment);
 	SUITE_ADD_TEST(suite, TestNextToken_MultiLineComment);
@@ -491,6 +801,16 @@ CuSuite* LexerTestGetSuite(){
 	SUITE_ADD_TEST(suite, TestNextToken_Type);
 	SUITE_ADD_TEST(suite, TestNextToken_Component);
 	SUITE_ADD_TEST(suite, TestNextToken_SignalWithEdge);
+	SUITE_ADD_TEST(suite, TestNextToken_AllKeywords);
+	SUITE_ADD_TEST(suite, TestNextToken_KeywordPrefixes);
+	SUITE_ADD_TEST(suite, TestVentLexer_Interleaved);
+	SUITE_ADD_TEST(suite, TestVentLexer_Threads);
+	SUITE_ADD_TEST(suite, TestVentLexer_Peek);
+	SUITE_ADD_TEST(suite, TestVentLexer_ExplicitLength);
+	SUITE_ADD_TEST(suite, TestVentLexer_StreamMatchesBuffer);
+	SUITE_ADD_TEST(suite, TestVentLexer_StreamPeek);
+	SUITE_ADD_TEST(suite, TestTokenStream_MatchesLexer);
+	SUITE_ADD_TEST(suite, TestTokenStream_Grows);
 
 	return suite;
 }
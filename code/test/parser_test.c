@@ -3,6 +3,8 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #include <parser.h>
 #include <ast.h>
@@ -29,15 +31,15 @@
 #define getConStatement(a, x)		((struct ConcurrentStatement*)(ReadBlockArray((a)->statements, x)))
 #define getProcess(c)				(struct Process*)(&(c->as.process))
 
-#define getSeqStatement(p, x)		((struct SequentialStatement*)(ReadBlockArray((p)->statements, x)))
+#define getSeqStatement(p, x)		(StmtVecAt((p)->statements, x))
 #define getSigAssign(s)				(struct SignalAssign*)(&(s->as.signalAssignment))
 #define getVarAssign(s)				(struct VariableAssign*)(&(s->as.variableAssignment))
 #define getWaitStatement(s)		(struct WaitStatement*)(&(s->as.waitStatement))
 #define getWhileStatement(s)		(struct WhileStatement*)(&(s->as.whileStatement))
 
 #define getIfStatement(s)			(struct IfStatement*)(&(s->as.ifStatement))
-#define getConsequent(p, x)		((struct SequentialStatement*)(ReadBlockArray((p)->consequentStatements, x)))
-#define getAlternative(p, x)		((struct SequentialStatement*)(ReadBlockArray((p)->alternativeStatements, x)))
+#define getConsequent(p, x)		(StmtVecAt((p)->consequentStatements, x))
+#define getAlternative(p, x)		(StmtVecAt((p)->alternativeStatements, x))
 
 #define getBinaryExp(e)				(struct BinaryExpr*)(e)
 #define getNumExp(e)					(struct NumExpr*)(e)
@@ -116,17 +118,17 @@ void TestParseProgram_UseEntityWithPorts(CuTest *tc){
 	CuAssertStrEquals_Msg(tc,"Entity identifier incorrect!", "ander", (getEntity(getLibraryUnit(prog, 1)))->name->value);
 
 	struct PortDecl* port = getPortDecl(getEntity(getLibraryUnit(prog, 1)), 0);	
-	CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "a", port->name->value);
+	CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "a", port->names->items[0]->value);
 	CuAssertStrEquals_Msg(tc,"Port mode incorrect!", "->", port->pmode->value);
 	CuAssertStrEquals_Msg(tc,"Port data type incorrect!", "stl", port->dtype->value);
 
 	port = getPortDecl(getEntity(getLibraryUnit(prog, 1)), 1);	
-	CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "b", port->name->value);
+	CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "b", port->names->items[0]->value);
 	CuAssertStrEquals_Msg(tc,"Port mode incorrect!", "->", port->pmode->value);
 	CuAssertStrEquals_Msg(tc,"Port data type incorrect!", "stl", port->dtype->value);
 
 	port = getPortDecl(getEntity(getLibraryUnit(prog, 1)), 2);	
-	CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "y", port->name->value);
+	CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "y", port->names->items[0]->value);
 	CuAssertStrEquals_Msg(tc,"Port mode incorrect!", "<-", port->pmode->value);
 	CuAssertStrEquals_Msg(tc,"Port data type incorrect!", "stl", port->dtype->value);
 
@@ -245,17 +247,17 @@ void TestParseProgram_EntityWithArchitecture(CuTest *tc){
 	CuAssertStrEquals_Msg(tc,"Entity identifier incorrect!", "ander", (getEntity(getLibraryUnit(prog, 1)))->name->value);
 
 	struct PortDecl* port = getPortDecl(getEntity(getLibraryUnit(prog, 1)), 0);	
-	CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "a", port->name->value);
+	CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "a", port->names->items[0]->value);
 	CuAssertStrEquals_Msg(tc,"Port mode incorrect!", "->", port->pmode->value);
 	CuAssertStrEquals_Msg(tc,"Port data type incorrect!", "stl", port->dtype->value);
 
 	port = getPortDecl(getEntity(getLibraryUnit(prog, 1)), 1);	
-	CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "b", port->name->value);
+	CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "b", port->names->items[0]->value);
 	CuAssertStrEquals_Msg(tc,"Port mode incorrect!", "->", port->pmode->value);
 	CuAssertStrEquals_Msg(tc,"Port data type incorrect!", "stl", port->dtype->value);
 
 	port = getPortDecl(getEntity(getLibraryUnit(prog, 1)), 2);	
-	CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "y", port->name->value);
+	CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "y", port->names->items[0]->value);
 	CuAssertStrEquals_Msg(tc,"Port mode incorrect!", "<-", port->pmode->value);
 	CuAssertStrEquals_Msg(tc,"Port data type incorrect!", "stl", port->dtype->value);
 
@@ -309,17 +311,17 @@ void TestParseProgram_LoopedProgramParsing(CuTest *tc){
 		CuAssertStrEquals_Msg(tc,"Entity identifier incorrect!", "ander", (getEntity(getLibraryUnit(prog, 1)))->name->value);
 
 		struct PortDecl* port = getPortDecl(getEntity(getLibraryUnit(prog, 1)), 0);	
-		CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "a", port->name->value);
+		CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "a", port->names->items[0]->value);
 		CuAssertStrEquals_Msg(tc,"Port mode incorrect!", "->", port->pmode->value);
 		CuAssertStrEquals_Msg(tc,"Port data type incorrect!", "stl", port->dtype->value);
 
 		port = getPortDecl(getEntity(getLibraryUnit(prog, 1)), 1);	
-		CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "b", port->name->value);
+		CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "b", port->names->items[0]->value);
 		CuAssertStrEquals_Msg(tc,"Port mode incorrect!", "->", port->pmode->value);
 		CuAssertStrEquals_Msg(tc,"Port data type incorrect!", "stl", port->dtype->value);
 	
 		port = getPortDecl(getEntity(getLibraryUnit(prog, 1)), 2);	
-		CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "y", port->name->value);
+		CuAssertStrEquals_Msg(tc,"Port identifier incorrect!", "y", port->names->items[0]->value);
 		CuAssertStrEquals_Msg(tc,"Port mode incorrect!", "<-", port->pmode->value);
 		CuAssertStrEquals_Msg(tc,"Port data type incorrect!", "stl", port->dtype->value);
 
@@ -375,7 +377,7 @@ void TestParseProgram_ProcessStatement(CuTest *tc){
 	CuAssertStrEquals(tc, "stl", 	(getSigDecl(getDeclaration(getArch(getLibraryUnit(prog, 0)), 2)))->dtype->value);
 	
 	struct Process* proc = getProcess(getConStatement(getArch(getLibraryUnit(prog, 0)), 0));
-	CuAssertStrEquals(tc, "clk", proc->sensitivityList->value);
+	CuAssertStrEquals(tc, "clk", proc->sensitivityList->items[0]->value);
 	CuAssertStrEquals_Msg(tc,"Signal identifier incorrect!", "y", (getSigAssign(getSeqStatement(proc, 0)))->target->value);
 
 	//PrintProgram(prog);
@@ -518,7 +520,7 @@ void TestParseProgram_ProcessWithIf(CuTest *tc){
 	struct Program* prog = ParseProgram(input);
 
 	struct Process* proc = getProcess(getConStatement(getArch(getLibraryUnit(prog, 0)), 0));
-	CuAssertStrEquals(tc, "clk", proc->sensitivityList->value);
+	CuAssertStrEquals(tc, "clk", proc->sensitivityList->items[0]->value);
 	CuAssertStrEquals(tc, "myVar", (getVarDecl(getDeclaration(proc, 0)))->name->value);
 
 	struct IfStatement* ifs = getIfStatement(getSeqStatement(proc, 0));
@@ -688,6 +690,7 @@ void TestParseProgram_ProcessWithTypeDefinition(CuTest *tc){
 			sig temp stl;\n \
 			type OpCode {Idle, Start, Stop, Clear};\n \
 			type myLogic {'0', '1', '2', 'F'};\n \
+			sig state OPCODE;\n \
 			\n \
 			proc() {\n \
 				for (op : Opcode) {\n \
@@ -792,6 +795,269 @@ void TestParseProgram_ArchWithMapping(CuTest *tc){
 	free(input);
 }
 
+void TestParseProgram_InstanceResolvesComponent(CuTest *tc){
+	char* input = strdup(" \
+		arch behavioral(comptest){\n \
+			comp counter {\n \
+				SIZE int;\n \
+				clk -> stl;\n \
+			}\n \
+			comp shifter {\n \
+				DEPTH int;\n \
+				din -> stl;\n \
+				dout <- stl;\n \
+			}\n \
+			sig a stl;\n \
+			sig b stl;\n \
+			\n \
+			S1: SHIFTER map(8, a, b);\n \
+			C1: Counter map(clk => a, size => 4);\n \
+		}\n \
+		\
+	");
+
+	struct Program* prog = ParseProgram(input);
+	CuAssertTrue(tc, ThereWasAnError() == false);
+
+	struct ArchitectureDecl* arch = getArch(getLibraryUnit(prog, 0));
+
+	//component names are matched regardless of case
+	struct Instantiation* shifter = &(getConStatement(arch, 0)->as.instantiation);
+	struct BinaryExpr* depth = getBinaryExp(shifter->genericMap->items[0]);
+	CuAssertStrEquals(tc, "DEPTH", (getIdentifier(depth->left))->value);
+
+	struct BinaryExpr* din = getBinaryExp(shifter->portMap->items[0]);
+	struct BinaryExpr* dout = getBinaryExp(shifter->portMap->items[1]);
+	CuAssertStrEquals(tc, "din", (getIdentifier(din->left))->value);
+	CuAssertStrEquals(tc, "a", (getIdentifier(din->right))->value);
+	CuAssertStrEquals(tc, "dout", (getIdentifier(dout->left))->value);
+	CuAssertIntEquals(tc, 2, ExpressionCount(shifter->portMap));
+
+	//so are the names in an associative map
+	struct Instantiation* counter = &(getConStatement(arch, 1)->as.instantiation);
+	CuAssertStrEquals(tc, "clk", (getIdentifier((getBinaryExp(counter->portMap->items[0]))->left))->value);
+	CuAssertStrEquals(tc, "size", (getIdentifier((getBinaryExp(counter->genericMap->items[0]))->left))->value);
+
+	FreeProgram(prog);
+	free(input);
+}
+
+void TestParseProgram_WideComponentMapping(CuTest *tc){
+	//more ports than a 16-bit position can count
+	#define WIDE_PORTS 70000
+	char* input = malloc(WIDE_PORTS * 40 + 256);
+	char* w = input;
+
+	w += sprintf(w, "arch behavioral(wide){\n comp bus {\n");
+	for(int i = 0; i < WIDE_PORTS; i++) w += sprintf(w, "p%d -> stl;\n", i);
+	w += sprintf(w, "}\n sig s stl;\n W1: bus map(");
+	for(int i = 0; i < WIDE_PORTS; i++) w += sprintf(w, "%ss", i ? ", " : "");
+	w += sprintf(w, ");\n W2: bus map(P69999 => s);\n}\n");
+
+	struct Program* prog = ParseProgram(input);
+	CuAssertTrue(tc, ThereWasAnError() == false);
+
+	struct ArchitectureDecl* arch = getArch(getLibraryUnit(prog, 0));
+	struct Instantiation* positional = &(getConStatement(arch, 0)->as.instantiation);
+	CuAssertIntEquals(tc, WIDE_PORTS, ExpressionCount(positional->portMap));
+
+	struct Expression* last = positional->portMap->items[WIDE_PORTS - 1];
+	CuAssertStrEquals(tc, "p69999", (getIdentifier((getBinaryExp(last))->left))->value);
+
+	struct Instantiation* named = &(getConStatement(arch, 1)->as.instantiation);
+	CuAssertPtrNotNull(tc, named->portMap->items[0]);
+	#undef WIDE_PORTS
+
+	FreeProgram(prog);
+	free(input);
+}
+
+void TestParseProgram_WildCardSharesPortNames(CuTest *tc){
+	#define WILD_PORTS 500
+	char* input = malloc(WILD_PORTS * 20 + 256);
+	char* w = input;
+
+	w += sprintf(w, "arch behavioral(wild){\n comp bus {\n");
+	for(int i = 0; i < WILD_PORTS; i++) w += sprintf(w, "p%d -> stl;\n", i);
+	w += sprintf(w, "}\n W1: bus map(*);\n}\n");
+
+	struct Program* prog = ParseProgram(input);
+	CuAssertTrue(tc, ThereWasAnError() == false);
+
+	struct ArchitectureDecl* arch = getArch(getLibraryUnit(prog, 0));
+	struct ComponentDecl* comp = &(getDeclaration(arch, 0)->as.componentDeclaration);
+	struct Instantiation* wild = &(getConStatement(arch, 0)->as.instantiation);
+	CuAssertIntEquals(tc, WILD_PORTS, ExpressionCount(wild->portMap));
+
+	//port => port points both sides at the port's own name
+	for(int i = 0; i < WILD_PORTS; i++){
+		struct BinaryExpr* bexp = getBinaryExp(wild->portMap->items[i]);
+		struct Expression* name = (struct Expression*)getPortDecl(comp, i)->names->items[0];
+		CuAssertPtrEquals(tc, name, bexp->left);
+		CuAssertPtrEquals(tc, name, bexp->right);
+	}
+	#undef WILD_PORTS
+
+	FreeProgram(prog);
+	free(input);
+}
+
+void TestParseProgram_SharedExpressions(CuTest *tc){
+	const char* input = " \
+		arch behavioral(shared){\n \
+			sig a stl;\n \
+			sig b stl;\n \
+			sig x stl;\n \
+			sig y stl;\n \
+			x <= a and b;\n \
+			y <= a and b;\n \
+			x <= not a;\n \
+		}\n \
+		\
+	";
+
+	for(int share = 0; share < 2; share++){
+		VentParser* parser = InitVentParser();
+		SetVentParserShareExpressions(parser, share);
+
+		struct Program* prog = ParseVentProgram(parser, input, strlen(input));
+		CuAssertTrue(tc, VentParserHadError(parser) == false);
+
+		struct ArchitectureDecl* arch = getArch(getLibraryUnit(prog, 0));
+		struct SignalAssign* first = getSigAssign(getConStatement(arch, 0));
+		struct SignalAssign* second = getSigAssign(getConStatement(arch, 1));
+		struct SignalAssign* third = getSigAssign(getConStatement(arch, 2));
+
+		//identical expressions are one node only when sharing
+		CuAssertTrue(tc, (first->expression == second->expression) == share);
+		struct Expression* a = (getBinaryExp(first->expression))->left;
+		CuAssertTrue(tc, (a == ((struct UnaryExpr*)third->expression)->right) == share);
+
+		//the names being assigned are never shared
+		CuAssertTrue(tc, first->target != third->target);
+		CuAssertStrEquals(tc, "x", third->target->value);
+
+		FreeVentProgram(parser, prog);
+		FreeVentParser(parser);
+	}
+}
+
+#define PARSER_THREADS 8
+#define PARSES_PER_THREAD 25
+
+struct parseJob {
+	int id;
+	int errors;
+	int mismatches;
+};
+
+static void* parseRepeatedly(void* arg){
+	struct parseJob* job = (struct parseJob*)arg;
+	char input[256];
+	char expected[16];
+
+	//every thread declares a different port, so mixed up stores would show
+	snprintf(expected, sizeof(expected), "q%d", job->id);
+	snprintf(input, sizeof(input),
+		"arch behavioral(comptest){\n"
+		"	comp counter { SIZE int; clk -> stl; %s <- stl; }\n"
+		"	sig a stl;\n"
+		"	C1: counter map(4, a, a);\n"
+		"}\n", expected);
+
+	VentParser* parser = InitVentParser();
+	for(int i = 0; i < PARSES_PER_THREAD; i++){
+		struct Program* prog = ParseVentProgram(parser, input, strlen(input));
+
+		if(VentParserHadError(parser)) {
+			job->errors++;
+		} else {
+			struct ArchitectureDecl* arch = getArch(getLibraryUnit(prog, 0));
+			struct Instantiation* inst = &(getConStatement(arch, 0)->as.instantiation);
+			struct BinaryExpr* q = getBinaryExp(inst->portMap->items[1]);
+			if(strcmp((getIdentifier(q->left))->value, expected) != 0) job->mismatches++;
+		}
+
+		FreeVentProgram(parser, prog);
+	}
+	FreeVentParser(parser);
+
+	return NULL;
+}
+
+void TestParseProgram_ConcurrentParsers(CuTest *tc){
+	pthread_t threads[PARSER_THREADS];
+	struct parseJob jobs[PARSER_THREADS] = {0};
+
+	for(int i = 0; i < PARSER_THREADS; i++){
+		jobs[i].id = i;
+		pthread_create(&threads[i], NULL, parseRepeatedly, &jobs[i]);
+	}
+	for(int i = 0; i < PARSER_THREADS; i++){
+		pthread_join(threads[i], NULL);
+	}
+
+	for(int i = 0; i < PARSER_THREADS; i++){
+		CuAssertIntEquals(tc, 0, jobs[i].errors);
+		CuAssertIntEquals(tc, 0, jobs[i].mismatches);
+	}
+
+	//the original interface is untouched by the parsers above
+	CuAssertTrue(tc, ThereWasAnError() == false);
+}
+
+void TestParseProgram_ParallelUnits(CuTest *tc){
+	const char* input = " \
+		use ieee.std_logic_1164.all;\n \
+		arch first(top){\n \
+			type state {idle, busy};\n \
+			comp shifter {\n \
+				DEPTH int;\n \
+				din -> stl;\n \
+				dout <- stl;\n \
+			}\n \
+		}\n \
+		/* a comment with a stray { in it */\n \
+		arch second(top){\n \
+			sig s state;\n \
+			sig a stl;\n \
+			sig b stl;\n \
+			// } another one\n \
+			S1: SHIFTER map(8, a, b);\n \
+		}\n \
+		arch third(top){\n \
+			sig c stl := '}';\n \
+		}\n \
+		\
+	";
+
+	VentParser* parser = InitVentParser();
+	SetVentParserJobs(parser, 4);
+
+	struct Program* prog = ParseVentProgram(parser, input, strlen(input));
+	CuAssertTrue(tc, VentParserHadError(parser) == false);
+	CuAssertIntEquals(tc, 4, BlockCount(prog->units));
+
+	//units stay in source order
+	CuAssertStrEquals(tc, "first", (getArch(getLibraryUnit(prog, 1)))->archName->value);
+	CuAssertStrEquals(tc, "third", (getArch(getLibraryUnit(prog, 3)))->archName->value);
+
+	//the component and type declared by the first arch are seen by the second
+	struct ArchitectureDecl* arch = getArch(getLibraryUnit(prog, 2));
+	CuAssertIntEquals(tc, 3, BlockCount(arch->declarations));
+
+	struct Instantiation* shifter = &(getConStatement(arch, 0)->as.instantiation);
+	struct BinaryExpr* depth = getBinaryExp(shifter->genericMap->items[0]);
+	CuAssertStrEquals(tc, "DEPTH", (getIdentifier(depth->left))->value);
+
+	struct BinaryExpr* dout = getBinaryExp(shifter->portMap->items[1]);
+	CuAssertStrEquals(tc, "dout", (getIdentifier(dout->left))->value);
+	CuAssertStrEquals(tc, "b", (getIdentifier(dout->right))->value);
+
+	FreeVentProgram(parser, prog);
+	FreeVentParser(parser);
+}
+
 void TestParseProgram_SignalWithAttribute(CuTest *tc){
 	char* input = strdup(" \
 		arch behavioral(looper){\n \
@@ -841,6 +1107,10 @@ void TestParseProgram_ProcessWithSensitivityList(CuTest *tc){
 	struct Program* prog = ParseProgram(input);
 
 	CuAssertTrue(tc, ThereWasAnError() == false);
+
+	struct Process* proc = getProcess(getConStatement(getArch(getLibraryUnit(prog, 0)), 0));
+	CuAssertIntEquals(tc, 2, proc->sensitivityList->count);
+	CuAssertStrEquals(tc, "arst", proc->sensitivityList->items[1]->value);
 	//PrintProgram(prog);
 
 	FreeProgram(prog);
@@ -858,6 +1128,10 @@ void TestParseProgram_MultiPortDeclaration(CuTest *tc){
 	struct Program* prog = ParseProgram(input);
 
 	CuAssertTrue(tc, ThereWasAnError() == false);
+
+	struct PortDecl* port = getPortDecl(getEntity(getLibraryUnit(prog, 1)), 0);
+	CuAssertIntEquals(tc, 3, port->names->count);
+	CuAssertStrEquals(tc, "c", port->names->items[2]->value);
 	//PrintProgram(prog);
 
 	FreeProgram(prog);
@@ -910,6 +1184,243 @@ void TestParseProgram_CallExpressionsWithManyArguments(CuTest *tc){
 	free(input);
 }
 
+static int deepNodes;
+static void countDeepNode(struct Expression* expr){
+	deepNodes++;
+}
+
+void TestParseProgram_DeepExpressions(CuTest *tc){
+	//far deeper than the call stack would allow if anything recursed per operand
+	const int terms = 200000;
+	const char* head = "arch behavioral(deep){\n y <= ";
+	const char* tail = "a;\n x <= not a and b;\n}\n";
+
+	size_t length = strlen(head) + terms * strlen("not a or ") + strlen(tail) + 1;
+	char* input = malloc(length);
+	char* cursor = input + sprintf(input, "%s", head);
+	for(int i = 0; i < terms; i++){
+		cursor += sprintf(cursor, i < terms / 2 ? "a or " : "not ");
+	}
+	sprintf(cursor, "%s", tail);
+
+	VentParser* parser = InitVentParser();
+	struct Program* prog = ParseVentProgram(parser, input, strlen(input));
+	CuAssertTrue(tc, VentParserHadError(parser) == false);
+
+	struct ArchitectureDecl* arch = getArch(getLibraryUnit(prog, 0));
+	struct SignalAssign* chain = getSigAssign(getConStatement(arch, 0));
+
+	//or chains lean left, the nots nest under the last or
+	struct BinaryExpr* top = getBinaryExp(chain->expression);
+	CuAssertStrEquals(tc, "or", top->op);
+	CuAssertIntEquals(tc, UNARY_EXPR, top->right->type);
+
+	struct ExpressionOperationBlock opBlk = {.doEnterOp = countDeepNode};
+	deepNodes = 0;
+	WalkExpression(chain->expression, &opBlk);
+	CuAssertIntEquals(tc, terms / 2 * 2 + terms / 2 + 1, deepNodes);
+
+	//a prefix operator binds tighter than the operator after its operand
+	struct SignalAssign* mixed = getSigAssign(getConStatement(arch, 1));
+	struct BinaryExpr* andExp = getBinaryExp(mixed->expression);
+	CuAssertStrEquals(tc, "and", andExp->op);
+	CuAssertIntEquals(tc, UNARY_EXPR, andExp->left->type);
+	CuAssertStrEquals(tc, "b", ((struct Identifier*)andExp->right)->value);
+
+	FreeVentProgram(parser, prog);
+	FreeVentParser(parser);
+	free(input);
+}
+
+static char* nestedCalls(int depth){
+	const char* head = "arch behavioral(deep){\n y <= ";
+	const char* tail = ";\n}\n";
+
+	char* input = malloc(strlen(head) + depth * strlen("f()") + 2 + strlen(tail));
+	char* cursor = input + sprintf(input, "%s", head);
+	for(int i = 0; i < depth; i++) cursor += sprintf(cursor, "f(");
+	cursor += sprintf(cursor, "a");
+	for(int i = 0; i < depth; i++) cursor += sprintf(cursor, ")");
+	sprintf(cursor, "%s", tail);
+
+	return input;
+}
+
+static char* nestedLoops(int depth){
+	const char* head = "arch behavioral(deep){\n proc(){\n";
+	const char* tail = " }\n}\n";
+
+	char* input = malloc(strlen(head) + depth * strlen("loop{}\n\n") + strlen("null;\n") + strlen(tail) + 1);
+	char* cursor = input + sprintf(input, "%s", head);
+	for(int i = 0; i < depth; i++) cursor += sprintf(cursor, "loop{\n");
+	cursor += sprintf(cursor, "null;\n");
+	for(int i = 0; i < depth; i++) cursor += sprintf(cursor, "}\n");
+	sprintf(cursor, "%s", tail);
+
+	return input;
+}
+
+void TestParseProgram_DeepNesting(CuTest *tc){
+	VentParser* parser = InitVentParser();
+
+	//calls nest on the call stack, a sensible depth still parses
+	char* input = nestedCalls(100);
+	struct Program* prog = ParseVentProgram(parser, input, strlen(input));
+	CuAssertTrue(tc, VentParserHadError(parser) == false);
+
+	struct ArchitectureDecl* arch = getArch(getLibraryUnit(prog, 0));
+	struct SignalAssign* assign = getSigAssign(getConStatement(arch, 0));
+	struct Expression* expr = assign->expression;
+	for(int i = 0; i < 100; i++){
+		CuAssertIntEquals(tc, CALL_EXPR, expr->type);
+		expr = ((struct CallExpr*)expr)->arguments->items[0];
+	}
+	CuAssertStrEquals(tc, "a", ((struct Identifier*)expr)->value);
+
+	FreeVentProgram(parser, prog);
+	free(input);
+
+	//far past the limit is an error rather than a stack overflow
+	input = nestedCalls(100000);
+	prog = ParseVentProgram(parser, input, strlen(input));
+	CuAssertTrue(tc, VentParserHadError(parser));
+	CuAssertPtrNotNull(tc, prog);
+	FreeVentProgram(parser, prog);
+	free(input);
+
+	input = nestedLoops(100000);
+	prog = ParseVentProgram(parser, input, strlen(input));
+	CuAssertTrue(tc, VentParserHadError(parser));
+	CuAssertPtrNotNull(tc, prog);
+	FreeVentProgram(parser, prog);
+	free(input);
+
+	//the parser is fine for the next program
+	input = nestedLoops(100);
+	prog = ParseVentProgram(parser, input, strlen(input));
+	CuAssertTrue(tc, VentParserHadError(parser) == false);
+	FreeVentProgram(parser, prog);
+	free(input);
+
+	FreeVentParser(parser);
+}
+
+//parses input from a pipe, so the parser streams it, and collects what it reported on stderr
+static void streamErrors(VentParser* parser, const char* input, char* errors, size_t size){
+	int fds[2];
+	if(pipe(fds) != 0){
+		errors[0] = '\0';
+		return;
+	}
+	ssize_t written = write(fds[1], input, strlen(input));
+	(void)written;
+	close(fds[1]);
+
+	fflush(stderr);
+	int saved = dup(STDERR_FILENO);
+	FILE* log = tmpfile();
+	dup2(fileno(log), STDERR_FILENO);
+
+	struct Program* prog = ParseVentProgramFromFd(parser, fds[0]);
+	FreeVentProgram(parser, prog);
+	close(fds[0]);
+
+	fflush(stderr);
+	dup2(saved, STDERR_FILENO);
+	close(saved);
+
+	rewind(log);
+	size_t got = fread(errors, 1, size - 1, log);
+	errors[got] = '\0';
+	fclose(log);
+}
+
+void TestParseProgram_StreamedErrorToken(CuTest *tc){
+	VentParser* parser = InitVentParser();
+	char errors[1024];
+
+	//the bad entry starts 16 tokens before the last one the lexer handed out
+	streamErrors(parser, "\
+		arch rtl(e){\n \
+			type t {aa + bb + cc + dd + ee + ff + gg + hh + ii + kk, b};\n \
+		}\n \
+	", errors, sizeof(errors));
+	CuAssertTrue(tc, VentParserHadError(parser));
+	CuAssertPtrNotNull(tc, strstr(errors, "Error at 'aa'"));
+
+	//a long literal 16 tokens later lands in the same lexer slot and grows it
+	char input[512];
+	char longName[201];
+	memset(longName, 'z', 200);
+	longName[200] = '\0';
+	snprintf(input, sizeof(input), "arch rtl(e){\n type t {aa + bb + cc + dd + ee + ff + gg + hh + %s + kk, b};\n}\n", longName);
+
+	streamErrors(parser, input, errors, sizeof(errors));
+	CuAssertTrue(tc, VentParserHadError(parser));
+	CuAssertPtrNotNull(tc, strstr(errors, "Error at 'aa'"));
+
+	FreeVentParser(parser);
+}
+
+static int filteredNodes[AST_REPORT + 1];
+
+static void countFilteredNode(struct AstNode* node){
+	filteredNodes[node->type]++;
+}
+
+void TestParseProgram_FilteredWalk(CuTest *tc){
+	char* input = strdup(" \
+		ent filtered { \
+			clk -> stl; \
+			a, b -> stl; \
+			q <- stl; \
+		} \
+		arch behavioral(filtered){ \
+			sig x stl; \
+			proc(clk) { \
+				if(clk'UP){ \
+					x <= a and b; \
+				} \
+			} \
+			q <= x; \
+		} \
+	");
+
+	VentParser* parser = InitVentParser();
+	struct Program* prog = ParseVentProgram(parser, input, strlen(input));
+	CuAssertTrue(tc, VentParserHadError(parser) == false);
+
+	//ports and processes only, neither is descended into so they get their
+	//default op alone and the process body is never walked
+	struct OperationBlock opBlk = {
+		.doDefaultOp	= countFilteredNode,
+		.doCloseOp		= countFilteredNode,
+		.visitMask		= AST_MASK(AST_PORT) | AST_MASK(AST_PROCESS),
+		.descendMask	= AST_MASK(AST_PROGRAM) | AST_MASK(AST_ENTITY) | AST_MASK(AST_ARCHITECTURE),
+	};
+	memset(filteredNodes, 0, sizeof(filteredNodes));
+	WalkTree(prog, &opBlk);
+
+	CuAssertIntEquals(tc, 3, filteredNodes[AST_PORT]);
+	CuAssertIntEquals(tc, 1, filteredNodes[AST_PROCESS]);
+	CuAssertIntEquals(tc, 0, filteredNodes[AST_IF]);
+	CuAssertIntEquals(tc, 0, filteredNodes[AST_IDENTIFIER]);
+	CuAssertIntEquals(tc, 0, filteredNodes[AST_SASSIGN]);
+
+	//no masks walks everything
+	struct OperationBlock allBlk = {.doDefaultOp = countFilteredNode};
+	memset(filteredNodes, 0, sizeof(filteredNodes));
+	WalkTree(prog, &allBlk);
+
+	CuAssertIntEquals(tc, 3, filteredNodes[AST_PORT]);
+	CuAssertIntEquals(tc, 1, filteredNodes[AST_IF]);
+	CuAssertIntEquals(tc, 2, filteredNodes[AST_SASSIGN]);
+
+	FreeVentProgram(parser, prog);
+	FreeVentParser(parser);
+	free(input);
+}
+
 void TestParseProgram_(CuTest *tc){
 	char* input = strdup(" \
 		\
@@ -947,11 +1458,21 @@ CuSuite* ParserTestGetSuite(){
 	SUITE_ADD_TEST(suite, TestParseProgram_EntityWithGeneric);
 	SUITE_ADD_TEST(suite, TestParseProgram_ArchWithComponent);
 	SUITE_ADD_TEST(suite, TestParseProgram_ArchWithMapping);
+	SUITE_ADD_TEST(suite, TestParseProgram_InstanceResolvesComponent);
+	SUITE_ADD_TEST(suite, TestParseProgram_WideComponentMapping);
+	SUITE_ADD_TEST(suite, TestParseProgram_WildCardSharesPortNames);
+	SUITE_ADD_TEST(suite, TestParseProgram_SharedExpressions);
+	SUITE_ADD_TEST(suite, TestParseProgram_ConcurrentParsers);
+	SUITE_ADD_TEST(suite, TestParseProgram_ParallelUnits);
 	SUITE_ADD_TEST(suite, TestParseProgram_SignalWithAttribute);
 	SUITE_ADD_TEST(suite, TestParseProgram_ProcessWithSensitivityList);
 	SUITE_ADD_TEST(suite, TestParseProgram_MultiPortDeclaration);
 	SUITE_ADD_TEST(suite, TestParseProgram_DeclarationsAfterStatements);
 	SUITE_ADD_TEST(suite, TestParseProgram_CallExpressionsWithManyArguments);
+	SUITE_ADD_TEST(suite, TestParseProgram_DeepExpressions);
+	SUITE_ADD_TEST(suite, TestParseProgram_DeepNesting);
+	SUITE_ADD_TEST(suite, TestParseProgram_StreamedErrorToken);
+	SUITE_ADD_TEST(suite, TestParseProgram_FilteredWalk);
 
 	return suite;
 }
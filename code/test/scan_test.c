@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "cutest.h"
+#include "scan.h"
+#include "lexer.h"
+
+//fill a buffer long enough to go through the vector loops, with one probe byte at a given spot
+static void fillAllBytes(char* buf, int len, unsigned char fill, unsigned char probe, int at){
+	memset(buf, fill, len);
+	buf[at] = (char)probe;
+}
+
+void TestScan_ClassTable(CuTest* tc){
+	const char* delims = " ;={}()<>+-*/,`~!&?\":'\n@";
+
+	for(int c = 0; c < 256; c++){
+		bool expected = (c == '\0') || (strchr(delims, c) != NULL);
+		CuAssertIntEquals(tc, expected, CharHasClass(c, CC_DELIM));
+	}
+
+	CuAssertTrue(tc, CharHasClass('\t', CC_SPACE));
+	CuAssertTrue(tc, CharHasClass('\r', CC_SPACE));
+	CuAssertTrue(tc, CharHasClass('\n', CC_NEWLINE));
+	CuAssertTrue(tc, CharHasClass('_', CC_LETTER));
+	CuAssertTrue(tc, !CharHasClass('.', CC_DELIM));
+	CuAssertTrue(tc, !CharHasClass('|', CC_DELIM));
+	CuAssertTrue(tc, !CharHasClass((char)0xC3, CC_DELIM | CC_LETTER));
+}
+
+void TestScan_SelectRunScanner(CuTest* tc){
+	const struct RunScanner* best = SelectRunScanner();
+
+	CuAssertPtrNotNull(tc, best);
+	CuAssertPtrNotNull(tc, GetRunScanner(SCAN_SCALAR));
+	CuAssertPtrEquals(tc, NULL, (void*)GetRunScanner((enum ScanLevel)42));
+}
+
+void TestScan_SkipIdentifierEveryByte(CuTest* tc){
+	const struct RunScanner* scalar = GetRunScanner(SCAN_SCALAR);
+	char buf[100];
+
+	for(int level = SCAN_SSE2; level <= SCAN_AVX2; level++){
+		const struct RunScanner* scanner = GetRunScanner(level);
+		if(scanner == NULL) continue;
+
+		for(int c = 0; c < 256; c++){
+			for(int at = 0; at < 70; at += 7){
+				fillAllBytes(buf, sizeof(buf), 'a', c, at);
+				CuAssertIntEquals_Msg(tc, scanner->name, scalar->skipIdentifier(buf, sizeof(buf)), scanner->skipIdentifier(buf, sizeof(buf)));
+			}
+		}
+	}
+}
+
+void TestScan_SkipSpaceCountsNewlines(CuTest* tc){
+	const char* input = "  \t\n\r\n    \n                        \t\t\t\t\n\n\n                   \n    x";
+	const struct RunScanner* scalar = GetRunScanner(SCAN_SCALAR);
+
+	int expectedLines = 0;
+	size_t expected = scalar->skipSpace(input, strlen(input)+1, &expectedLines);
+	CuAssertIntEquals(tc, strlen(input)-1, expected);
+	CuAssertIntEquals(tc, 7, expectedLines);
+
+	for(int level = SCAN_SSE2; level <= SCAN_AVX2; level++){
+		const struct RunScanner* scanner = GetRunScanner(level);
+		if(scanner == NULL) continue;
+
+		//try every start so runs end at every position within a block
+		for(size_t start = 0; start < strlen(input); start++){
+			int scalarLines = 0, lines = 0;
+			size_t want = scalar->skipSpace(input+start, strlen(input)+1-start, &scalarLines);
+			size_t got = scanner->skipSpace(input+start, strlen(input)+1-start, &lines);
+
+			CuAssertIntEquals_Msg(tc, scanner->name, want, got);
+			CuAssertIntEquals_Msg(tc, scanner->name, scalarLines, lines);
+		}
+	}
+}
+
+void TestScan_SkipUntilStopsAtTerminator(CuTest* tc){
+	const char* input = "a comment that spans\nmore than one\nvector block before it\nfinally ends * here";
+	size_t len = strlen(input)+1;
+
+	for(int level = SCAN_SCALAR; level <= SCAN_AVX2; level++){
+		const struct RunScanner* scanner = GetRunScanner(level);
+		if(scanner == NULL) continue;
+
+		int lines = 0;
+		CuAssertIntEquals_Msg(tc, scanner->name, strchr(input, '*') - input, scanner->skipUntil(input, len, '*', &lines));
+		CuAssertIntEquals_Msg(tc, scanner->name, 3, lines);
+
+		lines = 0;
+		CuAssertIntEquals_Msg(tc, scanner->name, len-1, scanner->skipUntil(input, len, '#', &lines));
+		CuAssertIntEquals_Msg(tc, scanner->name, 3, lines);
+
+		//never look past n, even when nothing stops the run
+		lines = 0;
+		CuAssertIntEquals_Msg(tc, scanner->name, 40, scanner->skipUntil(input, 40, '#', &lines));
+		CuAssertIntEquals_Msg(tc, scanner->name, 2, lines);
+	}
+}
+
+void TestScan_LexerSameTokensEveryLevel(CuTest* tc){
+	char* input =
+"// a comment\n\
+/* a longer comment that\n\
+	spans a few lines */\n\
+ent a_very_long_identifier_name_that_goes_past_a_vector_block {\n\
+	first_port_of_the_entity -> stl;\n\
+	second.port |<- stlv(7 downto 0);\n\
+}\n\
+\n\
+arch behaviorial(a_very_long_identifier_name_that_goes_past_a_vector_block){\n\
+	sig s : stl := '0';	// trailing comment\n\
+	s <= a and b;\n\
+}\n";
+
+	for(int level = SCAN_SSE2; level <= SCAN_AVX2; level++){
+		const struct RunScanner* scanner = GetRunScanner(level);
+		if(scanner == NULL) continue;
+
+		struct Token expected[128];
+		int count = 0;
+
+		VentLexer* lex = InitVentLexerWithScanner(input, strlen(input), GetRunScanner(SCAN_SCALAR));
+		do {
+			expected[count] = NextVentToken(lex);
+		} while(expected[count++].type != TOKEN_EOP && count < 128);
+		FreeVentLexer(lex);
+
+		lex = InitVentLexerWithScanner(input, strlen(input), scanner);
+		for(int i = 0; i < count; i++){
+			struct Token t = NextVentToken(lex);
+			CuAssertIntEquals_Msg(tc, scanner->name, expected[i].type, t.type);
+			CuAssertPtrEquals_Msg(tc, scanner->name, (void*)expected[i].literal, (void*)t.literal);
+			CuAssertIntEquals_Msg(tc, scanner->name, expected[i].length, t.length);
+			CuAssertIntEquals_Msg(tc, scanner->name, expected[i].lineNumber, t.lineNumber);
+		}
+		FreeVentLexer(lex);
+	}
+}
+
+CuSuite* ScanTestGetSuite(){
+	CuSuite* suite = CuSuiteNew();
+
+	SUITE_ADD_TEST(suite, TestScan_ClassTable);
+	SUITE_ADD_TEST(suite, TestScan_SelectRunScanner);
+	SUITE_ADD_TEST(suite, TestScan_SkipIdentifierEveryByte);
+	SUITE_ADD_TEST(suite, TestScan_SkipSpaceCountsNewlines);
+	SUITE_ADD_TEST(suite, TestScan_SkipUntilStopsAtTerminator);
+	SUITE_ADD_TEST(suite, TestScan_LexerSameTokensEveryLevel);
+
+	return suite;
+}
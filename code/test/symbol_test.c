@@ -0,0 +1,250 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "cutest.h"
+#include "symbol.h"
+
+#define SYMBOL_THREADS 8
+#define SYMBOL_NAMES 500
+
+static uint32_t intern(const char* text, const char** spelling){
+	return InternSymbol(text, strlen(text), spelling);
+}
+
+void TestSymbol_CaseFolding(CuTest* tc){
+	uint32_t lower = intern("counter_value", NULL);
+	uint32_t upper = intern("COUNTER_VALUE", NULL);
+	uint32_t mixed = intern("Counter_Value", NULL);
+	uint32_t other = intern("counter_valu", NULL);
+
+	CuAssertTrue(tc, lower != NO_SYMBOL);
+	CuAssertIntEquals(tc, lower, upper);
+	CuAssertIntEquals(tc, lower, mixed);
+	CuAssertTrue(tc, lower != other);
+
+	CuAssertStrEquals(tc, "counter_value", SymbolName(upper));
+	CuAssertPtrEquals(tc, NULL, (void*)SymbolName(NO_SYMBOL));
+	CuAssertPtrEquals(tc, NULL, (void*)SymbolName(SymbolCount() + 1));
+}
+
+void TestSymbol_SpellingStoredOnce(CuTest* tc){
+	const char* first = NULL;
+	const char* second = NULL;
+	const char* shouting = NULL;
+
+	//the input does not need to be NUL-terminated
+	const char* source = "sig ClkEnable : stl;";
+	uint32_t a = InternSymbol(source + 4, 9, &first);
+	uint32_t b = intern("ClkEnable", &second);
+	uint32_t c = intern("CLKENABLE", &shouting);
+
+	CuAssertIntEquals(tc, a, b);
+	CuAssertIntEquals(tc, a, c);
+
+	//same spelling, same storage
+	CuAssertPtrEquals(tc, (void*)first, (void*)second);
+	CuAssertStrEquals(tc, "ClkEnable", first);
+
+	//spellings are kept as written for the emitter
+	CuAssertStrEquals(tc, "CLKENABLE", shouting);
+	CuAssertTrue(tc, first != shouting);
+
+	//a lowercase spelling is the symbol name itself
+	const char* lower = NULL;
+	intern("clkenable", &lower);
+	CuAssertPtrEquals(tc, (void*)SymbolName(a), (void*)lower);
+}
+
+void TestSymbol_EmptyName(CuTest* tc){
+	const char* spelling = "not touched";
+
+	CuAssertIntEquals(tc, NO_SYMBOL, InternSymbol("abc", 0, &spelling));
+	CuAssertPtrEquals(tc, NULL, (void*)spelling);
+}
+
+void TestSymbol_ManyNames(CuTest* tc){
+	char name[32];
+	uint32_t ids[SYMBOL_NAMES];
+	uint32_t before = SymbolCount();
+
+	//enough names to grow the table a few times
+	for(int i = 0; i < SYMBOL_NAMES; i++){
+		snprintf(name, sizeof(name), "many_sig_%d", i);
+		ids[i] = intern(name, NULL);
+	}
+	CuAssertIntEquals(tc, before + SYMBOL_NAMES, SymbolCount());
+
+	for(int i = 0; i < SYMBOL_NAMES; i++){
+		snprintf(name, sizeof(name), "MANY_SIG_%d", i);
+		CuAssertIntEquals(tc, ids[i], intern(name, NULL));
+	}
+	CuAssertIntEquals(tc, before + SYMBOL_NAMES, SymbolCount());
+
+	//names longer than the fold buffer still intern
+	char longName[600];
+	memset(longName, 'X', sizeof(longName) - 1);
+	longName[sizeof(longName) - 1] = '\0';
+
+	uint32_t big = intern(longName, NULL);
+	CuAssertIntEquals(tc, strlen(longName), strlen(SymbolName(big)));
+	CuAssertIntEquals(tc, 'x', SymbolName(big)[0]);
+}
+
+void TestSymbol_Cache(CuTest* tc){
+	struct SymbolCache* cache = InitSymbolCache();
+	CuAssertPtrNotNull(tc, cache);
+
+	const char* direct = NULL;
+	const char* first = NULL;
+	const char* again = NULL;
+	uint32_t symbol = intern("Cached_Name", &direct);
+
+	//a cached spelling is the one in the table, the first time and every time after
+	CuAssertIntEquals(tc, symbol, InternCachedSymbol(cache, "Cached_Name", 11, &first));
+	CuAssertIntEquals(tc, symbol, InternCachedSymbol(cache, "Cached_Name", 11, &again));
+	CuAssertPtrEquals(tc, (void*)direct, (void*)first);
+	CuAssertPtrEquals(tc, (void*)direct, (void*)again);
+
+	//spellings new to the table go through the cache too
+	uint32_t count = SymbolCount();
+	uint32_t fresh = InternCachedSymbol(cache, "CACHE_ONLY", 10, NULL);
+	CuAssertIntEquals(tc, count + 1, SymbolCount());
+	CuAssertIntEquals(tc, fresh, InternCachedSymbol(cache, "cache_only", 10, NULL));
+	CuAssertIntEquals(tc, fresh, intern("Cache_Only", NULL));
+	CuAssertStrEquals(tc, "cache_only", SymbolName(fresh));
+
+	CuAssertIntEquals(tc, NO_SYMBOL, InternCachedSymbol(cache, "abc", 0, NULL));
+	FreeSymbolCache(cache);
+
+	//no cache just interns into the table
+	CuAssertIntEquals(tc, symbol, InternCachedSymbol(NULL, "CACHED_NAME", 11, NULL));
+}
+
+void TestSymbol_Map(CuTest* tc){
+	struct SymbolMap* map = InitSymbolMap();
+	uint64_t val = 0;
+
+	uint32_t clk = intern("map_clk", NULL);
+	CuAssertTrue(tc, GetInSymbolMap(map, clk, &val) == false);
+	CuAssertTrue(tc, SetInSymbolMap(map, clk, 7));
+	CuAssertTrue(tc, GetInSymbolMap(map, intern("MAP_CLK", NULL), &val));
+	CuAssertIntEquals(tc, 7, (int)val);
+
+	//a later value for the same symbol replaces the first
+	CuAssertTrue(tc, SetInSymbolMap(map, clk, 9) == false);
+	CuAssertTrue(tc, GetInSymbolMap(map, clk, &val));
+	CuAssertIntEquals(tc, 9, (int)val);
+
+	CuAssertTrue(tc, SetInSymbolMap(map, NO_SYMBOL, 1) == false);
+	CuAssertTrue(tc, GetInSymbolMap(map, NO_SYMBOL, NULL) == false);
+	CuAssertTrue(tc, GetInSymbolMap(NULL, clk, NULL) == false);
+
+	//enough symbols to grow the map a few times
+	char name[32];
+	for(int i = 0; i < SYMBOL_NAMES; i++){
+		snprintf(name, sizeof(name), "map_sig_%d", i);
+		SetInSymbolMap(map, intern(name, NULL), i);
+	}
+	for(int i = 0; i < SYMBOL_NAMES; i++){
+		snprintf(name, sizeof(name), "map_sig_%d", i);
+		CuAssertTrue(tc, GetInSymbolMap(map, intern(name, NULL), &val));
+		CuAssertIntEquals(tc, i, (int)val);
+	}
+	CuAssertTrue(tc, GetInSymbolMap(map, clk, &val));
+	CuAssertIntEquals(tc, 9, (int)val);
+	CuAssertIntEquals(tc, SYMBOL_NAMES + 1, SymbolMapCount(map));
+
+	//every entry comes out once
+	uint32_t cursor = 0;
+	uint32_t symbol = NO_SYMBOL;
+	uint64_t sum = 0;
+	int visited = 0;
+	while(NextInSymbolMap(map, &cursor, &symbol, &val)){
+		uint64_t expected = 0;
+		CuAssertTrue(tc, GetInSymbolMap(map, symbol, &expected));
+		CuAssertTrue(tc, expected == val);
+		sum += val;
+		visited++;
+	}
+	CuAssertIntEquals(tc, SYMBOL_NAMES + 1, visited);
+	CuAssertTrue(tc, sum == 9 + (uint64_t)SYMBOL_NAMES * (SYMBOL_NAMES - 1) / 2);
+	CuAssertTrue(tc, NextInSymbolMap(map, &cursor, &symbol, &val) == false);
+
+	cursor = 0;
+	CuAssertTrue(tc, NextInSymbolMap(NULL, &cursor, NULL, NULL) == false);
+	CuAssertIntEquals(tc, 0, SymbolMapCount(NULL));
+
+	FreeSymbolMap(map);
+	FreeSymbolMap(NULL);
+}
+
+struct symbolJob {
+	int offset;
+	uint32_t ids[SYMBOL_NAMES];
+	bool namesMatch;
+};
+
+static void* internNames(void* arg){
+	struct symbolJob* job = (struct symbolJob*)arg;
+	struct SymbolCache* cache = job->offset % 3 ? InitSymbolCache() : NULL;
+	char name[32];
+
+	//every thread interns the same names in a different order and case, twice, so the cache answers too
+	job->namesMatch = true;
+	for(int round = 0; round < 2; round++){
+		for(int i = 0; i < SYMBOL_NAMES; i++){
+			int n = (i + job->offset) % SYMBOL_NAMES;
+			snprintf(name, sizeof(name), job->offset % 2 ? "THREAD_SIG_%d" : "thread_sig_%d", n);
+			job->ids[n] = InternCachedSymbol(cache, name, strlen(name), NULL);
+
+			//names are read while other threads keep adding symbols
+			snprintf(name, sizeof(name), "thread_sig_%d", n);
+			const char* folded = SymbolName(job->ids[n]);
+			if(folded == NULL || strcmp(folded, name) != 0) job->namesMatch = false;
+		}
+	}
+
+	FreeSymbolCache(cache);
+	return NULL;
+}
+
+void TestSymbol_Threads(CuTest* tc){
+	pthread_t threads[SYMBOL_THREADS];
+	struct symbolJob jobs[SYMBOL_THREADS];
+
+	for(int i = 0; i < SYMBOL_THREADS; i++){
+		jobs[i].offset = i * (SYMBOL_NAMES / SYMBOL_THREADS);
+		pthread_create(&threads[i], NULL, internNames, &jobs[i]);
+	}
+
+	for(int i = 0; i < SYMBOL_THREADS; i++){
+		pthread_join(threads[i], NULL);
+	}
+
+	for(int t = 0; t < SYMBOL_THREADS; t++){
+		CuAssertTrue(tc, jobs[t].namesMatch);
+	}
+
+	for(int t = 1; t < SYMBOL_THREADS; t++){
+		for(int i = 0; i < SYMBOL_NAMES; i++){
+			CuAssertIntEquals(tc, jobs[0].ids[i], jobs[t].ids[i]);
+		}
+	}
+}
+
+CuSuite* SymbolTestGetSuite(){
+	CuSuite* suite = CuSuiteNew();
+
+	SUITE_ADD_TEST(suite, TestSymbol_CaseFolding);
+	SUITE_ADD_TEST(suite, TestSymbol_SpellingStoredOnce);
+	SUITE_ADD_TEST(suite, TestSymbol_EmptyName);
+	SUITE_ADD_TEST(suite, TestSymbol_ManyNames);
+	SUITE_ADD_TEST(suite, TestSymbol_Cache);
+	SUITE_ADD_TEST(suite, TestSymbol_Map);
+	SUITE_ADD_TEST(suite, TestSymbol_Threads);
+
+	return suite;
+}
@@ -4,17 +4,25 @@
 #include "cutest.h"
 
 // convenience macros
+#define TEST_ARENA
 #define TEST_DBA
 #define TEST_DHT
 #define TEST_LEXER
+#define TEST_SCAN
+#define TEST_SYMBOL
 #define TEST_PARSER
 #define TEST_TRANSPILE
+#define TEST_ASTPOOL
 
+CuSuite* ArenaTestGetSuite();
 CuSuite* DbaTestGetSuite();
 CuSuite* DhtTestGetSuite();
 CuSuite* LexerTestGetSuite();
+CuSuite* ScanTestGetSuite();
+CuSuite* SymbolTestGetSuite();
 CuSuite* ParserTestGetSuite();
 CuSuite* TranspileTestGetSuite();
+CuSuite* AstPoolTestGetSuite();
 
 void RunAllTests(void){
 	printf("*** Running VENT unit tests ***\r\n");
@@ -22,6 +30,10 @@ void RunAllTests(void){
 	CuSuite* masterSuite = CuSuiteNew();
 
 	// add new suites here!
+#ifdef TEST_ARENA
+	CuSuite* arenaTestSuite = ArenaTestGetSuite();
+	CuSuiteAddSuite(masterSuite, arenaTestSuite);
+#endif
 #ifdef TEST_DBA
 	CuSuite* dbaTestSuite = DbaTestGetSuite();
 	CuSuiteAddSuite(masterSuite, dbaTestSuite);
@@ -34,6 +46,14 @@ void RunAllTests(void){
 	CuSuite* lexerTestSuite = LexerTestGetSuite();
 	CuSuiteAddSuite(masterSuite, lexerTestSuite);
 #endif
+#ifdef TEST_SCAN
+	CuSuite* scanTestSuite = ScanTestGetSuite();
+	CuSuiteAddSuite(masterSuite, scanTestSuite);
+#endif
+#ifdef TEST_SYMBOL
+	CuSuite* symbolTestSuite = SymbolTestGetSuite();
+	CuSuiteAddSuite(masterSuite, symbolTestSuite);
+#endif
 #ifdef TEST_PARSER
 	CuSuite* parserTestSuite = ParserTestGetSuite();
 	CuSuiteAddSuite(masterSuite, parserTestSuite);
@@ -42,6 +62,10 @@ void RunAllTests(void){
 	CuSuite* transpileTestSuite = TranspileTestGetSuite();
 	CuSuiteAddSuite(masterSuite, transpileTestSuite);
 #endif
+#ifdef TEST_ASTPOOL
+	CuSuite* astPoolTestSuite = AstPoolTestGetSuite();
+	CuSuiteAddSuite(masterSuite, astPoolTestSuite);
+#endif
 
 	// run those babies!
 	CuSuiteRun(masterSuite);
@@ -52,6 +76,9 @@ void RunAllTests(void){
 	CuStringDelete(output);
 
 	// cleanup all test cases and suites
+#ifdef TEST_ASTPOOL
+	CuSuiteDelete(astPoolTestSuite);
+#endif
 #ifdef TEST_TRANSPILE
 	CuSuiteDelete(transpileTestSuite);
 #endif
@@ -61,9 +88,18 @@ void RunAllTests(void){
 #ifdef TEST_LEXER
 	CuSuiteDelete(lexerTestSuite);
 #endif
+#ifdef TEST_SCAN
+	CuSuiteDelete(scanTestSuite);
+#endif
+#ifdef TEST_SYMBOL
+	CuSuiteDelete(symbolTestSuite);
+#endif
 #ifdef TEST_DBA
 	CuSuiteDelete(dbaTestSuite);
 #endif
+#ifdef TEST_ARENA
+	CuSuiteDelete(arenaTestSuite);
+#endif
 #ifdef TEST_DHT
 	CuSuiteDelete(dhtTestSuite);
 #endif
@@ -0,0 +1,14 @@
+--
+-- This file was produced using TVT (The VENT Transpiler)
+--
+
+
+entity e is
+end e;
+
+architecture a of e is
+	type t is ( b);
+begin
+
+end architecture a;
+